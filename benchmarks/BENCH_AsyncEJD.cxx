@@ -0,0 +1,80 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "AsyncEJD.hpp"
+#include "ExtremeMeasures.hpp"
+// benchmark
+#include "benchmark/benchmark.h"
+// std lib
+#include <chrono>
+#include <future>
+#include <memory>
+#include <vector>
+
+// Latency of a small request submitted behind four large batch requests on one worker,
+// submitted as batch (arg 0) or interactive (arg 1); the batch requests are cancelled after.
+static void BM_Small_Behind_Batch(benchmark::State &state) {
+    ejd::AsyncExecutor executor(1);
+    ejd::RequestOptions small;
+    small.priority = state.range(0) ? ejd::RequestPriority::interactive : ejd::RequestPriority::batch;
+    for (auto _ : state) {
+        ejd::RequestOptions batch;
+        auto token = std::make_shared<ejd::CancellationToken>();
+        batch.token = token;
+        std::vector<std::future<ejd::ExtremeMeasures>> large;
+        for (int r = 0; r < 4; ++r) {
+            large.push_back(executor.submit_Poisson_measures(std::vector<double>(10, 40.0), batch));
+        }
+        const auto start = std::chrono::steady_clock::now();
+        auto ems = executor.submit_Poisson_measures({2, 3, 5, 7, 11}, small).get();
+        const auto end = std::chrono::steady_clock::now();
+        benchmark::DoNotOptimize(ems.data());
+        token->cancel();
+        for (auto & f : large) {
+            f.wait();
+        }
+        state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+    }
+}
+
+// time from cancel() to the future failing, for a large batch request that has started
+static void BM_Cancel(benchmark::State &state) {
+    ejd::AsyncExecutor executor(1);
+    for (auto _ : state) {
+        ejd::RequestOptions batch;
+        auto token = std::make_shared<ejd::CancellationToken>();
+        batch.token = token;
+        auto large = executor.submit_Poisson_measures(std::vector<double>(12, 40.0), batch);
+        const auto start = std::chrono::steady_clock::now();
+        token->cancel();
+        large.wait();
+        const auto end = std::chrono::steady_clock::now();
+        state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+    }
+}
+
+// register function
+BENCHMARK(BM_Small_Behind_Batch)->Arg(0)->Arg(1)->UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Cancel)->UseManualTime()->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,83 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "CompressedSupport.hpp"
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasures.hpp"
+// benchmark
+#include "benchmark/benchmark.h"
+
+// an extreme measure of dimension d with intensities 1..d, alternating structure
+static ejd::ExtremeMeasure make_measure(int d) {
+    std::vector<double> intensities(d);
+    std::vector<int> ms(d);
+    for (int i = 0; i < d; ++i) {
+        intensities[i] = i + 1;
+        ms[i] = (i % 2 == 0) ? 1 : -1;
+    }
+    return ejd::ejd(ejd::construct_Poisson_EmpDistrArray(intensities), ms);
+}
+
+static void BM_CompressSupport(benchmark::State &state) {
+    const auto em = make_measure(state.range(0));
+    ejd::CompressedSupport cs;
+    for (auto _ : state) {
+        cs = ejd::compress_support(em.support, em.monotone_structure);
+        benchmark::DoNotOptimize(cs.steps.data());
+    }
+    state.counters["points"] = em.size();
+    state.counters["compression_ratio"] =
+        static_cast<double>(ejd::uncompressed_support_bytes(em.support)) / cs.memory_bytes();
+}
+
+static void BM_DecodeSupport(benchmark::State &state) {
+    const auto em = make_measure(state.range(0));
+    const auto cs = ejd::compress_support(em.support, em.monotone_structure);
+    for (auto _ : state) {
+        long checksum = 0;
+        for (const auto & point : cs) {
+            checksum += point[0];
+        }
+        benchmark::DoNotOptimize(checksum);
+    }
+    state.SetItemsProcessed(state.iterations() * cs.size());
+}
+
+static void BM_RandomAccessSupport(benchmark::State &state) {
+    const auto em = make_measure(state.range(0));
+    const auto cs = ejd::compress_support(em.support, em.monotone_structure);
+    std::vector<int> point(cs.dimension());
+    std::size_t i = 0;
+    for (auto _ : state) {
+        cs.decode(i, point.data());
+        benchmark::DoNotOptimize(point.data());
+        i = (i + 7919) % cs.size();
+    }
+}
+
+// register function
+BENCHMARK(BM_CompressSupport)->DenseRange(2,20,2);
+BENCHMARK(BM_DecodeSupport)->DenseRange(2,20,2);
+BENCHMARK(BM_RandomAccessSupport)->DenseRange(2,20,6);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,106 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+#include "ConditionalIndex.hpp"
+#include "ExtremeMeasures.hpp"
+// benchmark
+#include "benchmark/benchmark.h"
+// std lib
+#include <random>
+
+static std::vector<double> intensities(int d) {
+    std::vector<double> lambdas;
+    for (int j = 0; j < d; ++j) {
+        lambdas.push_back(500.0 + 250.0 * j);
+    }
+    return lambdas;
+}
+
+static std::vector<int> queries(std::size_t n) {
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> m(400, 600);
+    std::vector<int> ms(n);
+    for (auto & x : ms) {
+        x = m(gen);
+    }
+    return ms;
+}
+
+// E[X_1 | X_0 = m] by scanning the support, as callers had to before the index
+static void BM_Conditional_Scan(benchmark::State &state) {
+    const auto em = ejd::construct_Poisson_ExtremeMeasures(intensities(state.range(0)))[1];
+    const auto ms = queries(1024);
+    std::size_t q = 0;
+    for (auto _ : state) {
+        double moment = 0, mass = 0;
+        for (std::size_t p = 0; p < em.support.size(); ++p) {
+            if (em.support[p].point[0] == ms[q]) {
+                mass += em.weights[p];
+                moment += em.weights[p] * em.support[p].point[1];
+            }
+        }
+        benchmark::DoNotOptimize(moment / mass);
+        q = (q + 1) % ms.size();
+    }
+    state.counters["support"] = em.support.size();
+}
+
+static void BM_Conditional_Index(benchmark::State &state) {
+    const auto em = ejd::construct_Poisson_ExtremeMeasures(intensities(state.range(0)))[1];
+    const auto ci = ejd::index_conditionals(em);
+    const auto ms = queries(1024);
+    std::size_t q = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ci.conditional_expectation(1, 0, ms[q]));
+        benchmark::DoNotOptimize(ci.conditional_cdf(1, 700, 0, ms[q]));
+        q = (q + 1) % ms.size();
+    }
+    state.counters["bytes"] = ci.memory_bytes();
+}
+
+static void BM_Conditional_Batch(benchmark::State &state) {
+    const auto em = ejd::construct_Poisson_ExtremeMeasures(intensities(state.range(0)))[1];
+    const auto ci = ejd::index_conditionals(em);
+    const auto ms = queries(state.range(1));
+    for (auto _ : state) {
+        auto expectations = ci.conditional_expectation(1, 0, ms);
+        benchmark::DoNotOptimize(expectations.data());
+    }
+    state.SetItemsProcessed(state.iterations() * ms.size());
+}
+
+static void BM_Conditional_Build(benchmark::State &state) {
+    const auto em = ejd::construct_Poisson_ExtremeMeasures(intensities(state.range(0)))[1];
+    for (auto _ : state) {
+        auto ci = ejd::index_conditionals(em);
+        benchmark::DoNotOptimize(ci.coords.data());
+    }
+    state.SetItemsProcessed(state.iterations() * em.support.size());
+}
+
+// register function
+BENCHMARK(BM_Conditional_Scan)->Arg(2)->Arg(4);
+BENCHMARK(BM_Conditional_Index)->Arg(2)->Arg(4);
+BENCHMARK(BM_Conditional_Batch)->Args({4, 1 << 10})->Args({4, 1 << 16});
+BENCHMARK(BM_Conditional_Build)->Arg(4)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,64 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Correlation.hpp"
+#include "Dual.hpp"
+// benchmark
+#include "benchmark/benchmark.h"
+
+// one calibration step at intensities (l, 2l): the bounds and their gradients
+
+static void BM_Gradient_CentralDifferences(benchmark::State &state) {
+    const double l1 = state.range(0);
+    const double l2 = 2 * l1;
+    const double h = 1e-6;
+    for (auto _ : state) {
+        auto bounds = ejd::poiss_correlation_bounds_2d(l1, l2);
+        auto up1 = ejd::poiss_correlation_bounds_2d(l1 + h, l2);
+        auto down1 = ejd::poiss_correlation_bounds_2d(l1 - h, l2);
+        auto up2 = ejd::poiss_correlation_bounds_2d(l1, l2 + h);
+        auto down2 = ejd::poiss_correlation_bounds_2d(l1, l2 - h);
+        double gradient[4] = {
+            (up1.first - down1.first) / (2 * h), (up2.first - down2.first) / (2 * h),
+            (up1.second - down1.second) / (2 * h), (up2.second - down2.second) / (2 * h)
+        };
+        benchmark::DoNotOptimize(bounds);
+        benchmark::DoNotOptimize(gradient);
+    }
+}
+
+static void BM_Gradient_Dual(benchmark::State &state) {
+    const double l1 = state.range(0);
+    const double l2 = 2 * l1;
+    for (auto _ : state) {
+        auto bounds = ejd::basic_poiss_correlation_bounds_2d(
+            ejd::Dual<2>::variable(l1, 0), ejd::Dual<2>::variable(l2, 1));
+        benchmark::DoNotOptimize(bounds);
+    }
+}
+
+// register function
+BENCHMARK(BM_Gradient_CentralDifferences)->RangeMultiplier(8)->Range(2, 512)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Gradient_Dual)->RangeMultiplier(8)->Range(2, 512)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
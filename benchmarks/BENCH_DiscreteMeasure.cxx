@@ -0,0 +1,103 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+#include "ExtremeMeasures.hpp"
+// benchmark
+#include "benchmark/benchmark.h"
+// std lib
+#include <random>
+
+// measure on n random points of dimension d, about 1 in 8 of them repeated
+static ejd::DiscreteMeasure make_measure(std::size_t n, int d, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> coord(0, static_cast<int>(std::cbrt(7.0 * n)));
+    ejd::DiscreteMeasure dm;
+    dm.support.reserve(n);
+    dm.weights.assign(n, 1.0 / n);
+    std::vector<int> p(d);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (auto & x : p) {
+            x = coord(gen);
+        }
+        dm.support.emplace_back(ejd::LatticePoint(p));
+    }
+    return dm;
+}
+
+static void BM_DiscreteMeasure_Sort(benchmark::State &state) {
+    const auto dm = make_measure(state.range(0), state.range(1), 1);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto copy = dm;
+        state.ResumeTiming();
+        copy.sort();
+        benchmark::DoNotOptimize(copy.support.data());
+    }
+    state.SetItemsProcessed(state.iterations() * dm.support.size());
+}
+
+static void BM_DiscreteMeasure_Coalesce(benchmark::State &state) {
+    const auto dm = make_measure(state.range(0), state.range(1), 1);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto copy = dm;
+        state.ResumeTiming();
+        copy.coalesce();
+        benchmark::DoNotOptimize(copy.support.data());
+    }
+    state.SetItemsProcessed(state.iterations() * dm.support.size());
+}
+
+// addition of two sorted measures: linear merge
+static void BM_DiscreteMeasure_MergeSorted(benchmark::State &state) {
+    auto x = make_measure(state.range(0), state.range(1), 1);
+    auto y = make_measure(state.range(0), state.range(1), 2);
+    x.coalesce();
+    y.coalesce();
+    for (auto _ : state) {
+        auto sum = ejd::merge_sorted(x, y);
+        benchmark::DoNotOptimize(sum.support.data());
+    }
+    state.SetItemsProcessed(state.iterations() * (x.support.size() + y.support.size()));
+}
+
+// addition of two unsorted measures: hash index, then sort
+static void BM_DiscreteMeasure_HashAdd(benchmark::State &state) {
+    const auto x = make_measure(state.range(0), state.range(1), 1);
+    const auto y = make_measure(state.range(0), state.range(1), 2);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto sum = x;
+        state.ResumeTiming();
+        sum += y;
+        benchmark::DoNotOptimize(sum.support.data());
+    }
+    state.SetItemsProcessed(state.iterations() * (x.support.size() + y.support.size()));
+}
+
+// register function
+BENCHMARK(BM_DiscreteMeasure_Sort)->Args({1 << 20, 3})->Args({10000000, 3})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DiscreteMeasure_Coalesce)->Args({1 << 20, 3})->Args({10000000, 3})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DiscreteMeasure_MergeSorted)->Args({1 << 20, 3})->Args({10000000, 3})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DiscreteMeasure_HashAdd)->Args({1 << 20, 3})->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
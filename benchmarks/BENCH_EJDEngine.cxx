@@ -0,0 +1,141 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "EJDEngine.hpp"
+#include "EmpiricalDistribution.hpp"
+// benchmark
+#include "benchmark/benchmark.h"
+// std lib
+#include <algorithm>
+#include <cmath>
+
+// d marginals with intensities 1..d, and the alternating structure
+static ejd::EmpDistrArray make_marginals(int d) {
+    std::vector<double> intensities(d);
+    for (int i = 0; i < d; ++i) {
+        intensities[i] = 10 * (i + 1);
+    }
+    return ejd::construct_Poisson_EmpDistrArray(intensities);
+}
+
+static std::vector<int> make_structure(int d) {
+    std::vector<int> ms(d);
+    for (int i = 0; i < d; ++i) {
+        ms[i] = (i % 2 == 0) ? 1 : -1;
+    }
+    return ms;
+}
+
+// Timing per instantiation, plus its accuracy: the largest error of the marginals the measure
+// implies against the input marginals, and the error of its total mass.
+template <typename Scalar, typename Policy>
+static void BM_EJD(benchmark::State &state) {
+    const auto marginals = make_marginals(state.range(0));
+    const auto ms = make_structure(state.range(0));
+    ejd::BasicExtremeMeasure<Scalar> em;
+    for (auto _ : state) {
+        em = ejd::basic_ejd<Scalar, Policy>(marginals, ms);
+        benchmark::DoNotOptimize(em.weights.data());
+    }
+
+    long double marginal_error = 0;
+    for (int j = 0; j < marginals.dimensions(); ++j) {
+        const auto & p = marginals.marginals[j].weights;
+        std::vector<long double> implied(p.size(), 0);
+        for (int i = 0; i < em.size(); ++i) {
+            implied[em.support[i].point[j]] += em.weights[i];
+        }
+        for (std::size_t k = 0; k < p.size(); ++k) {
+            marginal_error = std::max(marginal_error, std::abs(implied[k] - p[k]));
+        }
+    }
+    long double mass = 0;
+    for (Scalar w : em.weights) {
+        mass += w;
+    }
+    state.counters["points"] = em.size();
+    state.counters["marginal_error"] = static_cast<double>(marginal_error);
+    state.counters["mass_error"] = static_cast<double>(std::abs(mass - 1));
+}
+
+// exact integer merge; same accuracy report on the converted measure
+template <typename UInt>
+static void BM_FixedPointEJD(benchmark::State &state) {
+    const auto marginals = make_marginals(state.range(0));
+    const auto ms = make_structure(state.range(0));
+    ejd::FixedPointExtremeMeasure<UInt> em;
+    for (auto _ : state) {
+        em = ejd::fixed_point_ejd<UInt>(marginals, ms);
+        benchmark::DoNotOptimize(em.weights.data());
+    }
+    const auto converted = em.to_ExtremeMeasure();
+
+    long double marginal_error = 0;
+    for (int j = 0; j < marginals.dimensions(); ++j) {
+        const auto & p = marginals.marginals[j].weights;
+        std::vector<long double> implied(p.size(), 0);
+        for (int i = 0; i < converted.size(); ++i) {
+            implied[converted.support[i].point[j]] += converted.weights[i];
+        }
+        for (std::size_t k = 0; k < p.size(); ++k) {
+            marginal_error = std::max(marginal_error, std::abs(implied[k] - p[k]));
+        }
+    }
+    state.counters["points"] = em.size();
+    state.counters["marginal_error"] = static_cast<double>(marginal_error);
+    state.counters["mass_error"] = 0;
+}
+
+// one large measure on range(1) threads: 8 marginals with intensities up to 4 million
+static void BM_EJD_Threads(benchmark::State &state) {
+    std::vector<double> intensities;
+    for (int i = 0; i < 8; ++i) {
+        intensities.push_back(state.range(0) * (i + 1));
+    }
+    const auto marginals = ejd::construct_Poisson_EmpDistrArray(intensities);
+    const auto ms = make_structure(8);
+    ejd::EJDOptions options;
+    options.threads = state.range(1);
+    for (auto _ : state) {
+        auto em = ejd::basic_ejd<double>(marginals, ms, options);
+        benchmark::DoNotOptimize(em.weights.data());
+        state.counters["points"] = em.size();
+    }
+}
+
+// register function
+BENCHMARK_TEMPLATE(BM_EJD, float, ejd::NaiveSummation)->DenseRange(2,8,3);
+BENCHMARK_TEMPLATE(BM_EJD, float, ejd::NeumaierSummation)->DenseRange(2,8,3);
+BENCHMARK_TEMPLATE(BM_EJD, double, ejd::NaiveSummation)->DenseRange(2,8,3);
+BENCHMARK_TEMPLATE(BM_EJD, double, ejd::NeumaierSummation)->DenseRange(2,8,3);
+BENCHMARK_TEMPLATE(BM_EJD, long double, ejd::NaiveSummation)->DenseRange(2,8,3);
+BENCHMARK_TEMPLATE(BM_EJD, long double, ejd::NeumaierSummation)->DenseRange(2,8,3);
+BENCHMARK_TEMPLATE(BM_EJD, double, ejd::NeumaierSummation)->Arg(32);
+BENCHMARK_TEMPLATE(BM_FixedPointEJD, std::uint64_t)->DenseRange(2,8,3)->Arg(32);
+#ifdef EJD_HAS_UINT128
+BENCHMARK_TEMPLATE(BM_FixedPointEJD, ejd::uint128_t)->DenseRange(2,8,3)->Arg(32);
+#endif
+
+BENCHMARK(BM_EJD_Threads)->ArgsProduct({{500000}, {1, 2, 4, 8, 0}})->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
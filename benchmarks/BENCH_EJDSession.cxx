@@ -0,0 +1,99 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+#include "EJDSession.hpp"
+#include "ExtremeMeasures.hpp"
+// benchmark
+#include "benchmark/benchmark.h"
+// std lib
+#include <vector>
+
+// intensities 20, 40, ... of d marginals; each iteration nudges one of them
+static std::vector<double> make_intensities(int d) {
+    std::vector<double> intensities(d);
+    for (int j = 0; j < d; ++j) {
+        intensities[j] = 20.0 * (j + 1);
+    }
+    return intensities;
+}
+
+static void BM_Calibration_Rebuild(benchmark::State &state) {
+    auto intensities = make_intensities(state.range(0));
+    std::size_t round = 0;
+    for (auto _ : state) {
+        const int j = round % intensities.size();
+        intensities[j] += (round++ % 2 == 0) ? 0.01 : -0.01;
+        auto ems = ejd::construct_Poisson_ExtremeMeasures(intensities);
+        benchmark::DoNotOptimize(ems.data());
+    }
+}
+
+static void BM_Calibration_Session(benchmark::State &state) {
+    auto intensities = make_intensities(state.range(0));
+    auto session = ejd::construct_Poisson_EJDSession(intensities);
+    std::size_t round = 0;
+    for (auto _ : state) {
+        const int j = round % intensities.size();
+        intensities[j] += (round++ % 2 == 0) ? 0.01 : -0.01;
+        session.update_distribution(j, boost::math::poisson(intensities[j]));
+        benchmark::DoNotOptimize(session.view(0).weights);
+    }
+}
+
+// three long marginals and a short one that changes, which the session splices in
+static ejd::EmpDistrArray make_sparse(double lambda) {
+    std::vector<ejd::EmpiricalDistribution> marginals;
+    for (double intensity : {500.0, 800.0, 650.0, lambda}) {
+        marginals.push_back(ejd::construct_Poisson_EmpDistrArray({intensity}).marginals[0]);
+    }
+    return ejd::EmpDistrArray(marginals);
+}
+
+static void BM_Sparse_Rebuild(benchmark::State &state) {
+    ejd::MonotonicityStructure ms(4);
+    std::size_t round = 0;
+    for (auto _ : state) {
+        const auto marginals = make_sparse(2.0 + 0.01 * (round++ % 2));
+        for (int s = 0; s < ms.num_extremepts(); ++s) {
+            auto em = ejd::ejd(marginals, ms[s], ejd::EJDOptions());
+            benchmark::DoNotOptimize(em.weights.data());
+        }
+    }
+}
+
+static void BM_Sparse_Session(benchmark::State &state) {
+    ejd::EJDSession session(make_sparse(2.0));
+    std::size_t round = 0;
+    for (auto _ : state) {
+        const double lambda = 2.0 + 0.01 * (round++ % 2);
+        session.update_marginal(3, ejd::construct_Poisson_EmpDistrArray({lambda}).marginals[0]);
+        benchmark::DoNotOptimize(session.view(0).weights);
+    }
+}
+
+// register function
+BENCHMARK(BM_Calibration_Rebuild)->DenseRange(3, 7, 2)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Calibration_Session)->DenseRange(3, 7, 2)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Sparse_Rebuild)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Sparse_Session)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
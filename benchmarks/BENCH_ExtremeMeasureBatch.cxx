@@ -0,0 +1,72 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+#include "ExtremeMeasureBatch.hpp"
+#include "ExtremeMeasures.hpp"
+// benchmark
+#include "benchmark/benchmark.h"
+// std lib
+#include <random>
+
+// n portfolios of dimension d, intensities in [0.5, 20)
+static std::vector<double> make_intensities(std::size_t n, int d) {
+    std::mt19937 gen(9);
+    std::uniform_real_distribution<double> lambda(0.5, 20.0);
+    std::vector<double> intensities(n * d);
+    for (auto & x : intensities) {
+        x = lambda(gen);
+    }
+    return intensities;
+}
+
+// one construct_Poisson_ExtremeMeasures call per portfolio
+static void BM_Portfolios_Loop(benchmark::State &state) {
+    const std::size_t n = state.range(0);
+    const int d = state.range(1);
+    const auto intensities = make_intensities(n, d);
+    for (auto _ : state) {
+        for (std::size_t p = 0; p < n; ++p) {
+            auto ems = ejd::construct_Poisson_ExtremeMeasures(
+                {intensities.begin() + p * d, intensities.begin() + (p + 1) * d});
+            benchmark::DoNotOptimize(ems.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void BM_Portfolios_Batch(benchmark::State &state) {
+    const std::size_t n = state.range(0);
+    const int d = state.range(1);
+    const auto intensities = make_intensities(n, d);
+    ejd::ThreadPool pool(state.range(2));
+    for (auto _ : state) {
+        auto batch = ejd::construct_Poisson_ExtremeMeasureBatch(intensities.data(), n, d, pool);
+        benchmark::DoNotOptimize(batch.weights.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// register function
+BENCHMARK(BM_Portfolios_Loop)->Args({10000, 3})->Args({10000, 6})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Portfolios_Batch)->ArgsProduct({{10000}, {3, 6}, {1, 0}})->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,71 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ExtremeMeasureOrbits.hpp"
+#include "ExtremeMeasures.hpp"
+// benchmark
+#include "benchmark/benchmark.h"
+// std lib
+#include <vector>
+
+// d marginals in groups of four with the same intensity
+static std::vector<double> make_intensities(int d) {
+    std::vector<double> intensities(d);
+    for (int j = 0; j < d; ++j) {
+        intensities[j] = 3 + j / 4;
+    }
+    return intensities;
+}
+
+static void BM_Every_Structure(benchmark::State &state) {
+    const auto intensities = make_intensities(state.range(0));
+    for (auto _ : state) {
+        auto ems = ejd::construct_Poisson_ExtremeMeasures(intensities);
+        benchmark::DoNotOptimize(ems.data());
+    }
+}
+
+// the representatives only
+static void BM_Orbits(benchmark::State &state) {
+    const auto intensities = make_intensities(state.range(0));
+    for (auto _ : state) {
+        auto orbits = ejd::construct_Poisson_ExtremeMeasureOrbits(intensities);
+        benchmark::DoNotOptimize(orbits.num_representatives());
+    }
+}
+
+// the representatives and every measure reconstructed
+static void BM_Orbits_All(benchmark::State &state) {
+    const auto intensities = make_intensities(state.range(0));
+    for (auto _ : state) {
+        auto ems = ejd::construct_Poisson_ExtremeMeasureOrbits(intensities).measures();
+        benchmark::DoNotOptimize(ems.data());
+    }
+}
+
+// register function
+BENCHMARK(BM_Every_Structure)->Arg(8)->Arg(12)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Orbits)->Arg(8)->Arg(12)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Orbits_All)->Arg(8)->Arg(12)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,156 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ExtremeMeasures.hpp"
+#include "Kernels.hpp"
+// benchmark
+#include "benchmark/benchmark.h"
+// std lib
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+namespace k = ejd::kernels;
+
+struct Data {
+    std::vector<double> w, s;
+    std::vector<int> x, y;
+    explicit Data(std::size_t n) {
+        std::mt19937 gen(1);
+        std::uniform_real_distribution<double> unif(0., 1.);
+        for (std::size_t i = 0; i < n; ++i) {
+            w.push_back(unif(gen) / n);
+            s.push_back(i);
+            x.push_back(i / 2);
+            y.push_back((n - i) / 2);
+        }
+    }
+};
+
+static bool select(benchmark::State &state, k::KernelISA isa) {
+    try {
+        k::set_kernel_isa(isa);
+        return true;
+    } catch (const std::invalid_argument& e) {
+        state.SkipWithError(e.what());
+        return false;
+    }
+}
+
+// the loops the kernels replaced
+
+static void BM_Reference_Moment(benchmark::State &state) {
+    Data d(state.range(0));
+    for (auto _ : state) {
+        double moment = 0;
+        for (std::size_t i = 0; i < d.w.size(); ++i) {
+            moment += d.w[i] * std::pow(d.s[i], 2);
+        }
+        benchmark::DoNotOptimize(moment);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_Reference_Entropy(benchmark::State &state) {
+    Data d(state.range(0));
+    for (auto _ : state) {
+        double ent = 0;
+        for (const auto & w : d.w) {
+            ent += w * std::log(w);
+        }
+        benchmark::DoNotOptimize(ent);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_Reference_Bivariate(benchmark::State &state) {
+    Data d(state.range(0));
+    std::vector<ejd::LatticePoint> support;
+    for (std::size_t i = 0; i < d.w.size(); ++i) {
+        support.emplace_back(ejd::LatticePoint({d.x[i], d.y[i]}));
+    }
+    for (auto _ : state) {
+        double bivarexp = 0;
+        for (std::size_t i = 0; i < support.size(); ++i) {
+            bivarexp += support[i].product() * d.w[i];
+        }
+        benchmark::DoNotOptimize(bivarexp);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// kernels, per instruction set
+
+static void BM_Moment(benchmark::State &state, k::KernelISA isa) {
+    Data d(state.range(0));
+    if (!select(state, isa)) return;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(k::nth_moment(d.w.data(), d.s.data(), d.w.size(), 2));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_Entropy(benchmark::State &state, k::KernelISA isa) {
+    Data d(state.range(0));
+    if (!select(state, isa)) return;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(k::entropy(d.w.data(), d.w.size()));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_MomentSums(benchmark::State &state, k::KernelISA isa) {
+    Data d(state.range(0));
+    if (!select(state, isa)) return;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(k::moment_sums(d.w.data(), d.s.data(), d.w.size()));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_Bivariate(benchmark::State &state, k::KernelISA isa) {
+    Data d(state.range(0));
+    if (!select(state, isa)) return;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(k::bivariate_expectation(d.x.data(), d.y.data(), d.w.data(), d.w.size()));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// register function
+BENCHMARK(BM_Reference_Moment)->Arg(4096);
+BENCHMARK(BM_Reference_Entropy)->Arg(4096);
+BENCHMARK(BM_Reference_Bivariate)->Arg(4096);
+
+#define EJD_BENCHMARK_KERNELS(isa) \
+    BENCHMARK_CAPTURE(BM_Moment, isa, k::KernelISA::isa)->Arg(4096); \
+    BENCHMARK_CAPTURE(BM_Entropy, isa, k::KernelISA::isa)->Arg(4096); \
+    BENCHMARK_CAPTURE(BM_MomentSums, isa, k::KernelISA::isa)->Arg(4096); \
+    BENCHMARK_CAPTURE(BM_Bivariate, isa, k::KernelISA::isa)->Arg(4096);
+
+EJD_BENCHMARK_KERNELS(generic)
+EJD_BENCHMARK_KERNELS(avx2)
+EJD_BENCHMARK_KERNELS(avx512)
+
+BENCHMARK_MAIN();
@@ -0,0 +1,78 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+#include "LockstepEJD.hpp"
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasures.hpp"
+// benchmark
+#include "benchmark/benchmark.h"
+// std lib
+#include <random>
+
+// n Poisson problems of dimension d with short supports, intensities in [0.5, 4)
+static std::vector<ejd::EmpDistrArray> make_problems(std::size_t n, int d) {
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<double> lambda(0.5, 4.0);
+    std::vector<ejd::EmpDistrArray> problems;
+    problems.reserve(n);
+    for (std::size_t p = 0; p < n; ++p) {
+        std::vector<double> intensities(d);
+        for (auto & x : intensities) {
+            x = lambda(gen);
+        }
+        problems.push_back(ejd::construct_Poisson_EmpDistrArray(intensities));
+    }
+    return problems;
+}
+
+// one ejd() call per problem
+static void BM_Small_Loop(benchmark::State &state) {
+    const std::size_t n = 4096;
+    const int d = state.range(0);
+    const auto problems = make_problems(n, d);
+    const std::vector<int> ms(d, 1);
+    for (auto _ : state) {
+        for (const auto & problem : problems) {
+            auto em = ejd::ejd(problem, ms);
+            benchmark::DoNotOptimize(em.weights.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void BM_Small_Lockstep(benchmark::State &state) {
+    const std::size_t n = 4096;
+    const int d = state.range(0);
+    const auto problems = make_problems(n, d);
+    const std::vector<int> ms(d, 1);
+    for (auto _ : state) {
+        auto batch = ejd::lockstep_ejd(problems, ms, ejd::EJDOptions(), state.range(1));
+        benchmark::DoNotOptimize(batch.weights.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// register function
+BENCHMARK(BM_Small_Loop)->DenseRange(2, 4)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Small_Lockstep)->ArgsProduct({{2, 3, 4}, {4, 8, 16}})->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,79 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "EmpiricalDistribution.hpp"
+// benchmark
+#include "benchmark/benchmark.h"
+
+namespace bm = boost::math;
+
+// claim-count marginals with mean lambda: Poisson, negative binomial and binomial
+static std::vector<ejd::MarginalDistribution> claim_counts(double lambda) {
+    const double r = 5;
+    return {
+        bm::poisson(lambda),
+        bm::negative_binomial(r, r / (r + lambda)),
+        bm::binomial(4 * lambda, 0.25)
+    };
+}
+
+// per-atom Boost evaluation, as construct_EmpDistrArray did for Poisson marginals
+static void BM_BoostPerAtom(benchmark::State &state) {
+    const double lambda = state.range(0);
+    const double r = 5;
+    const bm::poisson poisson(lambda);
+    const bm::negative_binomial negative_binomial(r, r / (r + lambda));
+    const bm::binomial binomial(4 * lambda, 0.25);
+    for (auto _ : state) {
+        const int support_end = std::max({
+            ejd::upper_bounds(poisson),
+            ejd::upper_bounds(negative_binomial),
+            ejd::upper_bounds(binomial)
+        });
+        // Boost rejects atoms past the number of trials
+        auto binomial_marginal = ejd::construct_discrete_EmpDistr(binomial,
+            std::min<int>(support_end, binomial.trials() + 1));
+        binomial_marginal.weights.resize(support_end, 0.);
+        binomial_marginal.support = ejd::construct_discrete_EmpDistr(poisson, support_end, false).support;
+        ejd::EmpDistrArray array(std::vector<ejd::EmpiricalDistribution> {
+            ejd::construct_discrete_EmpDistr(poisson, support_end),
+            ejd::construct_discrete_EmpDistr(negative_binomial, support_end),
+            binomial_marginal
+        });
+        benchmark::DoNotOptimize(array.marginals.data());
+    }
+}
+
+static void BM_Recurrence(benchmark::State &state) {
+    const auto distrs = claim_counts(state.range(0));
+    for (auto _ : state) {
+        auto array = ejd::construct_EmpDistrArray(distrs);
+        benchmark::DoNotOptimize(array.marginals.data());
+    }
+}
+
+// register function
+BENCHMARK(BM_BoostPerAtom)->RangeMultiplier(4)->Range(4,256);
+BENCHMARK(BM_Recurrence)->RangeMultiplier(4)->Range(4,256);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,99 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "PointIndex.hpp"
+// benchmark
+#include "benchmark/benchmark.h"
+// std lib
+#include <random>
+#include <unordered_map>
+
+// n distinct points of dimension d, the coordinates small enough to be packed for d <= 8
+static std::vector<ejd::LatticePoint> make_points(std::size_t n, int d) {
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> coord(0, 1000);
+    std::vector<ejd::LatticePoint> points;
+    points.reserve(n);
+    std::vector<int> p(d);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (int j = 1; j < d; ++j) {
+            p[j] = coord(gen);
+        }
+        p[0] = i % 30000;
+        p[d - 1] = i / 30000;
+        points.emplace_back(ejd::LatticePoint(p));
+    }
+    return points;
+}
+
+static void BM_FlatPointMap_Build(benchmark::State &state) {
+    const auto points = make_points(state.range(0), state.range(1));
+    for (auto _ : state) {
+        auto map = ejd::index_support(points);
+        benchmark::DoNotOptimize(map.size());
+    }
+    state.SetItemsProcessed(state.iterations() * points.size());
+}
+
+static void BM_FlatPointMap_Find(benchmark::State &state) {
+    const auto points = make_points(state.range(0), state.range(1));
+    const auto map = ejd::index_support(points);
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(map.find(points[i]));
+        i = (i + 7919) % points.size();
+    }
+    state.counters["bytes_per_point"] = static_cast<double>(map.memory_bytes()) / points.size();
+}
+
+static void BM_UnorderedMap_Find(benchmark::State &state) {
+    const auto points = make_points(state.range(0), state.range(1));
+    std::unordered_map<ejd::LatticePoint, std::size_t> map;
+    map.reserve(points.size());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        map.emplace(points[i], i);
+    }
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(map.find(points[i]));
+        i = (i + 7919) % points.size();
+    }
+}
+
+// the linear search DiscreteMeasure::operator+= used to do
+static void BM_LinearFind(benchmark::State &state) {
+    const auto points = make_points(state.range(0), state.range(1));
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::find(points.begin(), points.end(), points[i]));
+        i = (i + 7919) % points.size();
+    }
+}
+
+// register function
+BENCHMARK(BM_FlatPointMap_Build)->Args({1 << 20, 3})->Args({1 << 20, 12})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_FlatPointMap_Find)->Args({1 << 20, 3})->Args({1 << 20, 12})->Args({10000000, 3});
+BENCHMARK(BM_UnorderedMap_Find)->Args({1 << 20, 3})->Args({1 << 20, 12});
+BENCHMARK(BM_LinearFind)->Args({1 << 14, 3});
+
+BENCHMARK_MAIN();
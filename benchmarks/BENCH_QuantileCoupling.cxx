@@ -0,0 +1,113 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+#include "EmpiricalDistribution.hpp"
+#include "QuantileCoupling.hpp"
+// benchmark
+#include "benchmark/benchmark.h"
+// std lib
+#include <algorithm>
+#include <random>
+
+static std::vector<double> intensities(int d) {
+    std::vector<double> lambdas;
+    for (int j = 0; j < d; ++j) {
+        lambdas.push_back(100.0 * (j + 1));
+    }
+    return lambdas;
+}
+
+static std::vector<double> uniforms(std::size_t n) {
+    std::mt19937_64 gen(7);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<double> us(n);
+    for (auto & u : us) {
+        u = uniform(gen);
+    }
+    return us;
+}
+
+static void BM_QuantileCoupling_Point(benchmark::State &state) {
+    const int d = state.range(0);
+    const auto qc = ejd::construct_QuantileCoupling(ejd::construct_Poisson_EmpDistrArray(intensities(d)),
+        std::vector<int>(d, 1));
+    const auto us = uniforms(1 << 12);
+    std::vector<int> point(d);
+    std::size_t i = 0;
+    for (auto _ : state) {
+        qc.point(us[i], point.data());
+        benchmark::DoNotOptimize(point.data());
+        i = (i + 1) % us.size();
+    }
+    state.counters["bytes"] = qc.memory_bytes();
+}
+
+// the same lookup by binary search in every cdf
+static void BM_QuantileCoupling_BinarySearch(benchmark::State &state) {
+    const int d = state.range(0);
+    const auto qc = ejd::construct_QuantileCoupling(ejd::construct_Poisson_EmpDistrArray(intensities(d)),
+        std::vector<int>(d, 1));
+    const auto us = uniforms(1 << 12);
+    std::vector<int> point(d);
+    std::size_t i = 0;
+    for (auto _ : state) {
+        for (int j = 0; j < d; ++j) {
+            const auto & cdf = qc.marginals[j].cdf;
+            point[j] = qc.marginals[j].values[std::lower_bound(cdf.begin(), cdf.end(), us[i]) - cdf.begin()];
+        }
+        benchmark::DoNotOptimize(point.data());
+        i = (i + 1) % us.size();
+    }
+}
+
+static void BM_QuantileCoupling_SortedBatch(benchmark::State &state) {
+    const int d = state.range(0);
+    const auto qc = ejd::construct_QuantileCoupling(ejd::construct_Poisson_EmpDistrArray(intensities(d)),
+        std::vector<int>(d, 1));
+    auto us = uniforms(state.range(1));
+    std::sort(us.begin(), us.end());
+    for (auto _ : state) {
+        auto points = qc.points_sorted(us);
+        benchmark::DoNotOptimize(points.data());
+    }
+    state.SetItemsProcessed(state.iterations() * us.size());
+}
+
+static void BM_QuantileCoupling_Sample(benchmark::State &state) {
+    const int d = state.range(0);
+    const auto qc = ejd::construct_QuantileCoupling(ejd::construct_Poisson_EmpDistrArray(intensities(d)),
+        std::vector<int>(d, 1));
+    std::mt19937_64 gen(3);
+    for (auto _ : state) {
+        auto points = qc.sample(gen, state.range(1));
+        benchmark::DoNotOptimize(points.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+// register function
+BENCHMARK(BM_QuantileCoupling_Point)->Arg(2)->Arg(8);
+BENCHMARK(BM_QuantileCoupling_BinarySearch)->Arg(2)->Arg(8);
+BENCHMARK(BM_QuantileCoupling_SortedBatch)->Args({8, 1 << 16});
+BENCHMARK(BM_QuantileCoupling_Sample)->Args({8, 1 << 16});
+
+BENCHMARK_MAIN();
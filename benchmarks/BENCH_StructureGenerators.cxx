@@ -0,0 +1,72 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasures.hpp"
+#include "StructureGenerators.hpp"
+// benchmark
+#include "benchmark/benchmark.h"
+// std lib
+#include <vector>
+
+// d Poisson marginals with intensities cycling through 1..8
+static ejd::EmpDistrArray make_marginals(int d) {
+    std::vector<double> intensities(d);
+    for (int j = 0; j < d; ++j) {
+        intensities[j] = 1 + j % 8;
+    }
+    return ejd::construct_Poisson_EmpDistrArray(intensities);
+}
+
+// 256 random structures through ejd, one sign vector at a time
+static void BM_Random_EJD(benchmark::State &state) {
+    const int d = state.range(0);
+    const auto marginals = make_marginals(d);
+    for (auto _ : state) {
+        ejd::RandomStructures structures(d, 256);
+        ejd::StructureMask mask;
+        while (structures.next(&mask)) {
+            auto em = ejd::ejd(marginals, mask.signs(), ejd::EJDOptions());
+            benchmark::DoNotOptimize(em.weights.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 256);
+}
+
+static void BM_Random_Stream(benchmark::State &state) {
+    const int d = state.range(0);
+    const auto marginals = make_marginals(d);
+    for (auto _ : state) {
+        ejd::RandomStructures structures(d, 256);
+        ejd::stream_ejd(marginals, structures, [] (std::size_t, const ejd::StructureMask&, const ejd::ExtremeMeasureView& em) {
+            benchmark::DoNotOptimize(em.weights);
+        });
+    }
+    state.SetItemsProcessed(state.iterations() * 256);
+}
+
+// register function
+BENCHMARK(BM_Random_EJD)->Arg(10)->Arg(30)->Arg(100)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Random_Stream)->Arg(10)->Arg(30)->Arg(100)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
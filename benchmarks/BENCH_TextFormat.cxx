@@ -0,0 +1,81 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ExtremeMeasures.hpp"
+#include "TextFormat.hpp"
+// benchmark
+#include "benchmark/benchmark.h"
+// std lib
+#include <cstdio>
+#include <fstream>
+
+// a synthetic monotone chain in 3 dimensions with n points
+static ejd::ExtremeMeasure make_chain(int n) {
+    ejd::ExtremeMeasure em;
+    em.monotone_structure = {1,-1,1};
+    for (int i = 0; i < n; ++i) {
+        em.support.emplace_back(ejd::LatticePoint({i, n - i, i / 2}));
+        em.weights.push_back(1.0 / n + i * 1e-12);
+    }
+    return em;
+}
+
+// the previous way of dumping a support: one LatticePoint at a time through iostreams
+static void BM_OstreamDump(benchmark::State &state) {
+    const auto em = make_chain(state.range(0));
+    std::ofstream out("/dev/null");
+    for (auto _ : state) {
+        for (int i = 0; i < em.size(); ++i) {
+            out << em.weights[i] << ' ' << em.support[i] << '\n';
+        }
+        out.flush();
+    }
+    state.SetItemsProcessed(state.iterations() * em.size());
+}
+
+static void BM_WriteCsv(benchmark::State &state) {
+    const auto em = make_chain(state.range(0));
+    std::FILE * out = std::fopen("/dev/null", "w");
+    for (auto _ : state) {
+        ejd::write_csv(out, em);
+    }
+    std::fclose(out);
+    state.SetItemsProcessed(state.iterations() * em.size());
+}
+
+static void BM_WriteJson(benchmark::State &state) {
+    const auto em = make_chain(state.range(0));
+    std::FILE * out = std::fopen("/dev/null", "w");
+    for (auto _ : state) {
+        ejd::write_json(out, em);
+    }
+    std::fclose(out);
+    state.SetItemsProcessed(state.iterations() * em.size());
+}
+
+// register function
+BENCHMARK(BM_OstreamDump)->RangeMultiplier(100)->Range(100, 1000000);
+BENCHMARK(BM_WriteCsv)->RangeMultiplier(100)->Range(100, 1000000);
+BENCHMARK(BM_WriteJson)->RangeMultiplier(100)->Range(100, 1000000);
+
+BENCHMARK_MAIN();
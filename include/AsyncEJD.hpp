@@ -0,0 +1,126 @@
+#pragma once
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasures.hpp"
+// stl
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Async EJD
+//
+//////////////////////////////////////////////////////////////////////////////
+
+enum class RequestPriority
+{
+    batch,          // run when no interactive request is waiting
+    interactive     // small requests that should not queue behind batch work
+};
+
+struct RequestOptions
+{
+    RequestPriority priority = RequestPriority::batch;
+    // optional; cancelling it, or its deadline passing, fails the request with EJDCancelled
+    std::shared_ptr<const CancellationToken> token;
+    // for every ejd call of the request; its cancellation is replaced by token
+    EJDOptions options;
+};
+
+// Runs requests on a fixed set of worker threads and hands back their results as futures.
+// A request is cut into steps (a structure, a pair of intensities, a block of draws), and the
+// workers take one step at a time from the interactive requests first, then from the batch
+// ones, in turns between the requests of the same priority; so an interactive request waits
+// at most for the steps already running, and several workers can share one request. The
+// token is polled before every step and inside the merges, so a cancelled request stops
+// within a merge chunk of every running step, and the steps it has left are skipped.
+class AsyncExecutor
+{
+public:
+    // 0 for one worker per hardware thread
+    explicit AsyncExecutor(unsigned threads = 0);
+    // runs the requests already submitted, then joins the workers
+    ~AsyncExecutor();
+
+    AsyncExecutor(const AsyncExecutor&) = delete;
+    AsyncExecutor& operator=(const AsyncExecutor&) = delete;
+
+    unsigned size() const noexcept;
+    // steps waiting to be started, over all requests
+    std::size_t pending() const;
+
+    // ejd(marginals, structures[s], options) for every s, with the means and variances
+    std::future<ExtremeMeasures> submit_measures(EmpDistrArray marginals,
+        std::vector<std::vector<int>> structures, const RequestOptions& request = RequestOptions());
+
+    // construct_Poisson_ExtremeMeasures(intensities, options)
+    std::future<ExtremeMeasures> submit_Poisson_measures(std::vector<double> intensities,
+        const RequestOptions& request = RequestOptions());
+
+    // poiss_correlation_bounds_2d of every pair of intensities
+    std::future<std::vector<std::pair<double,double>>> submit_correlation_bounds(
+        std::vector<std::pair<double,double>> intensity_pairs, const RequestOptions& request = RequestOptions());
+
+    // n draws from the extreme measure of monotone_structure, n x dim row-major, taken from
+    // QuantileCoupling in blocks of sample_block draws; block b is drawn with a generator seeded
+    // from (seed, b), so the draws do not depend on the workers
+    static constexpr std::size_t sample_block = 1 << 14;
+    std::future<std::vector<int>> submit_samples(EmpDistrArray marginals, std::vector<int> monotone_structure,
+        std::size_t n, std::uint64_t seed, const RequestOptions& request = RequestOptions());
+
+private:
+    struct Request;
+
+    std::vector<std::thread> workers;
+    // requests with steps left to start, by priority
+    std::deque<std::shared_ptr<Request>> queues[2];
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    // the future of a request of steps calls of step(i), which fill in *result
+    template <typename Result, typename Step>
+    std::future<Result> run(const RequestOptions& options, std::size_t steps, std::shared_ptr<Result> result,
+        Step step);
+    void work();
+};
+
+// the executor shared by the whole process, with one worker per hardware thread; started on
+// first use
+AsyncExecutor& shared_executor();
+
+// namespace ejd
+}
@@ -0,0 +1,128 @@
+#pragma once
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasures.hpp"
+// stl
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Binary Format
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// File layout (native endianness, every section aligned to binary_section_alignment):
+//
+//   BinaryHeader
+//   marginal_offsets  u64[dim+1]         prefix sums of the marginal support lengths
+//   marginal_weights  f64[marginal_points]
+//   marginal_support  f64[marginal_points]
+//   measure_offsets   u64[num_measures+1] prefix sums of the measure support lengths
+//   structures        i32[num_measures*dim]
+//   means             f64[num_measures*dim]
+//   variances         f64[num_measures*dim]
+//   weights           f64[total_points]
+//   coords            i32[total_points*dim] column-major within each measure
+
+constexpr char binary_magic[8] = {'E','J','D','B','I','N','\0','\0'};
+constexpr std::uint32_t binary_format_version = 1;
+constexpr std::uint32_t binary_endian_tag = 0x01020304;
+constexpr std::size_t binary_section_alignment = 64;
+
+struct BinaryHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t endian_tag;
+    std::uint32_t dim;
+    std::uint32_t reserved;
+    std::uint64_t num_measures;
+    std::uint64_t total_points;
+    std::uint64_t marginal_points;
+    std::uint64_t file_size;
+    // byte offsets of the sections from the start of the file
+    std::uint64_t marginal_offsets;
+    std::uint64_t marginal_weights;
+    std::uint64_t marginal_support;
+    std::uint64_t measure_offsets;
+    std::uint64_t structures;
+    std::uint64_t means;
+    std::uint64_t variances;
+    std::uint64_t weights;
+    std::uint64_t coords;
+};
+
+// writes the marginals and the measures in one sequential pass; throws std::runtime_error on I/O errors
+void write_binary(const std::string& path, const EmpDistrArray& marginals, const ExtremeMeasures& ems);
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Mapped Extreme Measures
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Read-only, zero-copy access to a file written by write_binary. The file is mapped on
+// construction and its header, section layout and measure offsets are validated, which takes
+// O(num_measures); the supports and weights are not read until they are used.
+class MappedExtremeMeasures
+{
+public:
+    explicit MappedExtremeMeasures(const std::string& path);
+    ~MappedExtremeMeasures();
+
+    MappedExtremeMeasures(const MappedExtremeMeasures&) = delete;
+    MappedExtremeMeasures& operator=(const MappedExtremeMeasures&) = delete;
+    MappedExtremeMeasures(MappedExtremeMeasures&& other) noexcept;
+    MappedExtremeMeasures& operator=(MappedExtremeMeasures&& other) noexcept;
+
+    int dimension() const noexcept;
+    std::size_t size() const noexcept;
+    std::size_t total_points() const noexcept;
+    const BinaryHeader& header() const noexcept;
+
+    // requires i < size()
+    ExtremeMeasureView operator[](std::size_t i) const;
+    // copies the marginals out of the mapping
+    EmpDistrArray marginals() const;
+    ExtremeMeasures to_ExtremeMeasures() const;
+
+private:
+    const std::byte * data = nullptr;
+    std::size_t length = 0;
+
+    template <typename T>
+    const T * section(std::uint64_t offset) const {
+        return reinterpret_cast<const T*>(data + offset);
+    }
+    void release() noexcept;
+};
+
+// namespace ejd
+}
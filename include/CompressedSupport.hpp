@@ -0,0 +1,136 @@
+#pragma once
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ExtremeMeasures.hpp"
+// stl
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Compressed Support
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// The support of an extreme measure is a monotone chain: going from one point to the next,
+// each coordinate either stays put or takes one step along its (flipped) support, i.e. moves
+// by monotone_structure[j]. A chain is therefore stored as a full point every
+// checkpoint_interval points plus one bitmask per point of the coordinates that stepped.
+// Steps that are not of that form (e.g. a marginal with a zero-weight atom) force an
+// extra checkpoint, so any support round-trips exactly.
+struct CompressedSupport
+{
+    class const_iterator;
+
+    int dim = 0;
+    std::size_t length = 0;
+    int checkpoint_interval = 64;
+    std::vector<int> monotone_structure;
+    // bytes_per_step() bytes per point; bit j set iff coordinate j stepped into this point
+    std::vector<std::uint8_t> steps;
+    // point index of each checkpoint (strictly increasing, starts at 0) and its dim coordinates
+    std::vector<std::size_t> checkpoint_index;
+    std::vector<int> checkpoints;
+    // methods
+    int dimension() const noexcept;
+    std::size_t size() const noexcept;
+    std::size_t bytes_per_step() const noexcept;
+    std::size_t memory_bytes() const noexcept;
+    // random access: decodes from the nearest checkpoint at or before i
+    void decode(std::size_t i, int * out) const;
+    LatticePoint operator[](std::size_t i) const;
+    std::vector<LatticePoint> decompress() const;
+    // sequential decoding
+    const_iterator begin() const;
+    const_iterator end() const;
+};
+
+class CompressedSupport::const_iterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::vector<int>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::vector<int>*;
+    using reference = const std::vector<int>&;
+
+    const_iterator() = default;
+    const_iterator(const CompressedSupport * cs, std::size_t index);
+
+    reference operator*() const { return point; }
+    pointer operator->() const { return &point; }
+    const_iterator& operator++();
+    const_iterator operator++(int);
+    bool operator==(const const_iterator& o) const { return index == o.index; }
+    bool operator!=(const const_iterator& o) const { return index != o.index; }
+
+private:
+    const CompressedSupport * cs = nullptr;
+    std::size_t index = 0;
+    std::size_t next_checkpoint = 0;    // position in cs->checkpoint_index
+    std::vector<int> point;
+
+    void load_checkpoint();
+};
+
+CompressedSupport compress_support(
+    const std::vector<LatticePoint>& support,
+    const std::vector<int>& monotone_structure,
+    int checkpoint_interval=64);
+
+// size of the same support held as std::vector<LatticePoint>
+std::size_t uncompressed_support_bytes(const std::vector<LatticePoint>& support);
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Compressed Extreme Measure
+//
+//////////////////////////////////////////////////////////////////////////////
+
+struct CompressedExtremeMeasure
+{
+    CompressedSupport support;
+    std::vector<double> weights;
+    std::vector<int> monotone_structure;
+    std::vector<double> means;
+    std::vector<double> variances;
+    // methods
+    int dimension() const noexcept;
+    int size() const noexcept;
+    std::size_t memory_bytes() const noexcept;
+    ExtremeMeasure decompress() const;
+};
+
+using CompressedExtremeMeasures = std::vector<CompressedExtremeMeasure>;
+
+CompressedExtremeMeasure compress(const ExtremeMeasure& em, int checkpoint_interval=64);
+
+CompressedExtremeMeasures compress(const ExtremeMeasures& ems, int checkpoint_interval=64);
+
+// namespace ejd
+}
@@ -0,0 +1,93 @@
+#pragma once
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ExtremeMeasures.hpp"
+// stl
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Conditional Index
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Conditional queries on an extreme measure in O(log S). Along the monotone chain every
+// coordinate moves one way only, so the points with X_i = m form one contiguous run of the
+// chain, and inside that run every other coordinate is again monotone. The index keeps, per
+// coordinate, the runs of equal values with their mass and conditional means, plus the
+// weights accumulated from the start of each run, so that the mass of any sub-range of a run
+// is a difference of two entries that are both relative to the run, not to the whole measure.
+//
+// Conditioning on a value that has no mass (off the support, or a zero-weight run) gives NaN.
+struct ConditionalIndex
+{
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    // runs of equal values of one coordinate along the chain
+    struct Coordinate
+    {
+        bool descending = false;            // monotone_structure[i] == -1
+        std::vector<int> values;            // value of each run, in chain order
+        std::vector<std::size_t> begin;     // first point of each run, then the chain length
+        std::vector<double> mass;           // weight of each run
+        std::vector<double> means;          // runs x dim, row-major: E[X_j | run]
+        std::vector<double> cumulative;     // per point: weight of its run before it
+    };
+
+    int dim = 0;
+    std::size_t length = 0;
+    std::vector<int> coords;                // dim x length, column-wise
+    std::vector<Coordinate> coordinates;
+    // methods
+    int dimension() const noexcept;
+    std::size_t size() const noexcept;
+    std::size_t memory_bytes() const noexcept;
+    // run of the points with X_i = m, npos if there is none
+    std::size_t find_run(int i, int m) const;
+    // the same for many values at once: one sort of the queries and one sweep over the runs
+    std::vector<std::size_t> find_runs(int i, const std::vector<int>& ms) const;
+    // P(X_i = m)
+    double probability(int i, int m) const;
+    // P(X_j = k | X_i = m)
+    double conditional_pmf(int j, int k, int i, int m) const;
+    // P(X_j <= k | X_i = m)
+    double conditional_cdf(int j, int k, int i, int m) const;
+    // E[X_j | X_i = m]
+    double conditional_expectation(int j, int i, int m) const;
+    // batch versions, answered in the order of ms
+    std::vector<double> conditional_pmf(int j, int k, int i, const std::vector<int>& ms) const;
+    std::vector<double> conditional_cdf(int j, int k, int i, const std::vector<int>& ms) const;
+    std::vector<double> conditional_expectation(int j, int i, const std::vector<int>& ms) const;
+};
+
+// throws std::invalid_argument if the support is not a monotone chain for its structure
+ConditionalIndex index_conditionals(const ExtremeMeasure& em);
+ConditionalIndex index_conditionals(const ExtremeMeasureView& em);
+
+// namespace ejd
+}
@@ -22,6 +22,8 @@
     DEALINGS IN THE SOFTWARE.
 */
 
+#include "Dual.hpp"
+// stl
 #include <utility>
 #include <vector>
 
@@ -30,17 +32,22 @@ namespace ejd {
 // fwd declarations
 struct LatticePoint;
 struct ExtremeMeasure;
+struct ExtremeMeasureView;
 
 namespace detail  {
 
-double bivariate_expectation(std::vector<LatticePoint> support, std::vector<double> weights);
+double bivariate_expectation(const std::vector<LatticePoint>& support, const std::vector<double>& weights);
 
-double correlation(std::vector<LatticePoint> support, std::vector<double> weights, double mean, double variance);
+double correlation(const std::vector<LatticePoint>& support, const std::vector<double>& weights,
+    const std::vector<double>& means, const std::vector<double>& variances);
 
 }   // namespace detail
 
 double correlation(const ExtremeMeasure& em);
 
+// reads the two support columns in place
+double correlation(const ExtremeMeasureView& em);
+
 //////////////////////////////////////////////////////////////////////////////
 //
 // Extreme Measure 
@@ -58,5 +65,20 @@ std::vector<double> correlations(const ExtremeMeasure & em);
 // returns the [min, max] admissible correlation bounds for a Poisson process with the specified intensities
 std::pair<double,double> poiss_correlation_bounds_2d(const double intensity1, const double intensity2);
 
+// The same bounds for intensities of any Scalar, in the same order. Seeded as
+// Dual<2>::variable(intensity1, 0) and Dual<2>::variable(intensity2, 1), the bounds come out
+// with their gradients by both intensities in one pass. The supports of the marginals and the
+// breakpoints of the measures are those of the values and held fixed: they only change at
+// discrete events, in between which these are the exact derivatives of the bounds. At the
+// events themselves, e.g. equal intensities where the cdf values tie, they are the derivatives
+// on the side the merge breaks the ties to.
+// Compiled for double, Dual<1> and Dual<2>.
+template <typename Scalar>
+std::pair<Scalar,Scalar> basic_poiss_correlation_bounds_2d(const Scalar& intensity1, const Scalar& intensity2);
+
+extern template std::pair<double,double> basic_poiss_correlation_bounds_2d<double>(const double&, const double&);
+extern template std::pair<Dual<1>,Dual<1>> basic_poiss_correlation_bounds_2d<Dual<1>>(const Dual<1>&, const Dual<1>&);
+extern template std::pair<Dual<2>,Dual<2>> basic_poiss_correlation_bounds_2d<Dual<2>>(const Dual<2>&, const Dual<2>&);
+
 // namespace ejd
 }
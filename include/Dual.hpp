@@ -0,0 +1,158 @@
+#pragma once
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+// stl
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Dual Numbers
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// A value with its derivatives by N parameters, for forward-mode differentiation through the
+// templated pipelines: every operation carries the derivatives along by the chain rule.
+// Comparisons only look at the values, so code that branches on them (the merge of the cdfs)
+// takes the same branches as on doubles and the derivatives are those of that branch.
+template <int N>
+struct Dual
+{
+    double value = 0;
+    std::array<double, N> grad {};
+
+    Dual() = default;
+    Dual(double value) : value(value) {}
+    Dual(double value, const std::array<double, N>& grad) : value(value), grad(grad) {}
+
+    // the i-th parameter, with derivative 1 by itself
+    static Dual variable(double value, int i) {
+        Dual x(value);
+        x.grad[i] = 1;
+        return x;
+    }
+
+    explicit operator double() const { return value; }
+
+    Dual& operator+=(const Dual& y) {
+        value += y.value;
+        for (int i = 0; i < N; ++i) {
+            grad[i] += y.grad[i];
+        }
+        return *this;
+    }
+    Dual& operator-=(const Dual& y) {
+        value -= y.value;
+        for (int i = 0; i < N; ++i) {
+            grad[i] -= y.grad[i];
+        }
+        return *this;
+    }
+    Dual& operator*=(const Dual& y) {
+        for (int i = 0; i < N; ++i) {
+            grad[i] = grad[i] * y.value + value * y.grad[i];
+        }
+        value *= y.value;
+        return *this;
+    }
+    Dual& operator/=(const Dual& y) {
+        const double q = value / y.value;
+        for (int i = 0; i < N; ++i) {
+            grad[i] = (grad[i] - q * y.grad[i]) / y.value;
+        }
+        value = q;
+        return *this;
+    }
+};
+
+template <int N> Dual<N> operator-(Dual<N> x) {
+    x.value = -x.value;
+    for (auto & g : x.grad) {
+        g = -g;
+    }
+    return x;
+}
+
+template <int N> Dual<N> operator+(Dual<N> x, const Dual<N>& y) { return x += y; }
+template <int N> Dual<N> operator-(Dual<N> x, const Dual<N>& y) { return x -= y; }
+template <int N> Dual<N> operator*(Dual<N> x, const Dual<N>& y) { return x *= y; }
+template <int N> Dual<N> operator/(Dual<N> x, const Dual<N>& y) { return x /= y; }
+template <int N> Dual<N> operator+(Dual<N> x, double y) { return x += Dual<N>(y); }
+template <int N> Dual<N> operator-(Dual<N> x, double y) { return x -= Dual<N>(y); }
+template <int N> Dual<N> operator*(Dual<N> x, double y) { return x *= Dual<N>(y); }
+template <int N> Dual<N> operator/(Dual<N> x, double y) { return x /= Dual<N>(y); }
+template <int N> Dual<N> operator+(double x, const Dual<N>& y) { return Dual<N>(x) += y; }
+template <int N> Dual<N> operator-(double x, const Dual<N>& y) { return Dual<N>(x) -= y; }
+template <int N> Dual<N> operator*(double x, const Dual<N>& y) { return Dual<N>(x) *= y; }
+template <int N> Dual<N> operator/(double x, const Dual<N>& y) { return Dual<N>(x) /= y; }
+
+template <int N> bool operator==(const Dual<N>& x, const Dual<N>& y) { return x.value == y.value; }
+template <int N> bool operator!=(const Dual<N>& x, const Dual<N>& y) { return x.value != y.value; }
+template <int N> bool operator<(const Dual<N>& x, const Dual<N>& y) { return x.value < y.value; }
+template <int N> bool operator>(const Dual<N>& x, const Dual<N>& y) { return x.value > y.value; }
+template <int N> bool operator<=(const Dual<N>& x, const Dual<N>& y) { return x.value <= y.value; }
+template <int N> bool operator>=(const Dual<N>& x, const Dual<N>& y) { return x.value >= y.value; }
+
+// f(x) with derivative df at x.value
+template <int N>
+Dual<N> chain(const Dual<N>& x, double f, double df)
+{
+    Dual<N> y(f);
+    for (int i = 0; i < N; ++i) {
+        y.grad[i] = df * x.grad[i];
+    }
+    return y;
+}
+
+template <int N> Dual<N> abs(const Dual<N>& x) { return x.value < 0 ? -x : x; }
+
+template <int N> Dual<N> exp(const Dual<N>& x) {
+    const double e = std::exp(x.value);
+    return chain(x, e, e);
+}
+
+template <int N> Dual<N> log(const Dual<N>& x) { return chain(x, std::log(x.value), 1 / x.value); }
+
+template <int N> Dual<N> sqrt(const Dual<N>& x) {
+    const double r = std::sqrt(x.value);
+    return chain(x, r, 0.5 / r);
+}
+
+// the value of a double or a dual number, for the code paths that only depend on it
+inline double value_of(double x) { return x; }
+template <int N> double value_of(const Dual<N>& x) { return x.value; }
+
+// namespace ejd
+}
+
+namespace std {
+
+// the precision is that of the values
+template <int N>
+class numeric_limits<ejd::Dual<N>> : public numeric_limits<double> {};
+
+}
@@ -0,0 +1,242 @@
+#pragma once
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Dual.hpp"
+#include "ExtremeMeasures.hpp"
+// stl
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Summation Policies
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// How the marginal cdfs are accumulated. value() is the rounded running sum and error() the
+// part of the exact sum it lost, which the engine carries along to the weight differences.
+
+struct NaiveSummation
+{
+    template <typename Scalar>
+    struct Accumulator
+    {
+        Scalar sum = 0;
+        void add(Scalar x) { sum += x; }
+        Scalar value() const { return sum; }
+        Scalar error() const { return 0; }
+    };
+};
+
+struct NeumaierSummation
+{
+    template <typename Scalar>
+    struct Accumulator
+    {
+        Scalar sum = 0;
+        Scalar compensation = 0;
+        void add(Scalar x) {
+            using std::abs;
+            const Scalar t = sum + x;
+            if (abs(sum) >= abs(x)) {
+                compensation += (sum - t) + x;
+            } else {
+                compensation += (x - t) + sum;
+            }
+            sum = t;
+        }
+        Scalar value() const { return sum + compensation; }
+        Scalar error() const { return (sum - value()) + compensation; }
+    };
+};
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// EJD Engine
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// joint cdf at precision Scalar, with the rounding error of every breakpoint
+template <typename Scalar>
+struct BasicJointCDF
+{
+    std::vector<Scalar> breakpoints;    // strictly increasing, the last one is exactly 1
+    std::vector<Scalar> errors;         // exact breakpoint - breakpoints[i]
+    std::vector<int> indices;           // breakpoints.size() x dim, row-major
+};
+
+template <typename Scalar>
+struct BasicExtremeMeasure
+{
+    std::vector<LatticePoint> support;
+    std::vector<Scalar> weights;
+    std::vector<int> monotone_structure;
+    // methods
+    int size() const noexcept { return support.size(); }
+    ExtremeMeasure to_ExtremeMeasure() const;
+};
+
+// marginal_cdfs[j] is sorted, errors[j] (empty for none) its rounding errors; see
+// merge_marginal_cdfs for the folding rules and the threads
+template <typename Scalar>
+BasicJointCDF<Scalar> basic_merge_marginal_cdfs(const std::vector<std::vector<Scalar>>& marginal_cdfs,
+    const std::vector<std::vector<Scalar>>& errors, double tol, EJDStats * stats = nullptr, unsigned threads = 1);
+
+// The breakpoints of the values [begin[j], end[j]) of every marginal cdf alone, for ranges that
+// start at the first values or right after a gap wider than tol, where the full merge starts a
+// breakpoint anyway; the indices count from 0 as in the full merge. No breakpoint at one is
+// added. *tail tells whether the range reached the values within tol of one.
+template <typename Scalar>
+BasicJointCDF<Scalar> basic_merge_marginal_cdf_range(const std::vector<std::vector<Scalar>>& marginal_cdfs,
+    const std::vector<std::vector<Scalar>>& errors, double tol, const std::vector<std::size_t>& begin,
+    const std::vector<std::size_t>& end, bool * tail = nullptr);
+
+// The ejd pipeline with the cdfs, breakpoints and weights held as Scalar and the cdfs summed
+// with SummationPolicy. The marginals are converted from double before they are summed.
+// The coalescing tolerance is raised to a few ulps of Scalar when options asks for less.
+// Compiled into the library for float, double and long double with either policy;
+// ejd() is basic_ejd<double, NeumaierSummation>.
+template <typename Scalar, typename SummationPolicy = NeumaierSummation>
+BasicExtremeMeasure<Scalar> basic_ejd(const EmpDistrArray& empdistrarrs, const std::vector<int>& monotone_structs,
+    const EJDOptions& options = EJDOptions(), EJDStats * stats = nullptr);
+
+// The joint cdf of basic_ejd for marginal weights given as Scalar, which may also be a Dual
+// carrying the derivatives of the weights by some parameters: the merge only compares values,
+// so the breakpoints and atoms are those of the weights' values, held fixed, and every
+// breakpoint carries the derivatives of the marginal cdf value it was taken from. Compiled for
+// the scalars of basic_ejd and for Dual<1> and Dual<2>.
+template <typename Scalar, typename SummationPolicy = NeumaierSummation>
+BasicJointCDF<Scalar> basic_joint_cdf(const std::vector<std::vector<Scalar>>& marginal_weights,
+    const std::vector<int>& monotone_structs, const EJDOptions& options = EJDOptions(), EJDStats * stats = nullptr);
+
+// The weights of the measure of a joint cdf: the differences of consecutive breakpoints, with
+// their rounding errors added back. The breakpoints are strictly increasing so all are positive.
+template <typename Scalar>
+void breakpoint_weights(const std::vector<Scalar>& breakpoints, const std::vector<Scalar>& errors,
+    std::vector<Scalar> * weights)
+{
+    weights->resize(breakpoints.size());
+    Scalar previous = 0;
+    Scalar previous_error = 0;
+    for (std::size_t i = 0; i < breakpoints.size(); ++i) {
+        (*weights)[i] = (breakpoints[i] - previous) + (errors[i] - previous_error);
+        previous = breakpoints[i];
+        previous_error = errors[i];
+    }
+}
+
+// The cdf of a marginal as basic_ejd<double> sums it, along its support or flipped: cdf[i] adds
+// up the weights of the first i + 1 atoms in that order, errors[i] is its rounding error and
+// support[i] the atom. Callers that switch orientations keep one of each.
+void oriented_cdf(const EmpiricalDistribution& marginal, bool flip, std::vector<double> * cdf,
+    std::vector<double> * errors, std::vector<int> * support);
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Fixed-Point EJD
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifdef __SIZEOF_INT128__
+#define EJD_HAS_UINT128 1
+using uint128_t = unsigned __int128;
+#endif
+
+// Weights are integers that sum to exactly one = 2^fraction_bits. Each marginal cdf is
+// accumulated in double, rounded to the nearest multiple of 2^-fraction_bits and forced to end
+// at one; from there on the merge and the weights are exact integer arithmetic, so the
+// support only depends on the marginal weights and not on the platform or compiler. With
+// 128 bits the rounding is exact for every cdf value above 2^-74.
+template <typename UInt>
+struct FixedPointExtremeMeasure
+{
+    static constexpr int fraction_bits = 8 * sizeof(UInt) - 1;
+    static constexpr UInt one = UInt(1) << fraction_bits;
+
+    std::vector<LatticePoint> support;
+    std::vector<UInt> weights;
+    std::vector<int> monotone_structure;
+    // methods
+    int size() const noexcept { return support.size(); }
+    ExtremeMeasure to_ExtremeMeasure() const;
+};
+
+// c in [0,1] as the nearest multiple of 2^-fraction_bits, in units of it
+template <typename UInt>
+UInt to_fixed_point(double c);
+
+template <typename UInt>
+FixedPointExtremeMeasure<UInt> fixed_point_ejd(const EmpDistrArray& empdistrarrs,
+    const std::vector<int>& monotone_structs, EJDStats * stats = nullptr, unsigned threads = 1);
+
+extern template struct FixedPointExtremeMeasure<std::uint64_t>;
+extern template std::uint64_t to_fixed_point<std::uint64_t>(double);
+extern template FixedPointExtremeMeasure<std::uint64_t> fixed_point_ejd<std::uint64_t>(
+    const EmpDistrArray&, const std::vector<int>&, EJDStats *, unsigned);
+#ifdef EJD_HAS_UINT128
+extern template struct FixedPointExtremeMeasure<uint128_t>;
+extern template uint128_t to_fixed_point<uint128_t>(double);
+extern template FixedPointExtremeMeasure<uint128_t> fixed_point_ejd<uint128_t>(
+    const EmpDistrArray&, const std::vector<int>&, EJDStats *, unsigned);
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Explicit Instantiations
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#define EJD_EXTERN_JOINT_CDF(Scalar) \
+    extern template BasicJointCDF<Scalar> basic_merge_marginal_cdfs<Scalar>( \
+        const std::vector<std::vector<Scalar>>&, const std::vector<std::vector<Scalar>>&, double, EJDStats *, unsigned); \
+    extern template BasicJointCDF<Scalar> basic_merge_marginal_cdf_range<Scalar>( \
+        const std::vector<std::vector<Scalar>>&, const std::vector<std::vector<Scalar>>&, double, \
+        const std::vector<std::size_t>&, const std::vector<std::size_t>&, bool *); \
+    extern template BasicJointCDF<Scalar> basic_joint_cdf<Scalar, NaiveSummation>( \
+        const std::vector<std::vector<Scalar>>&, const std::vector<int>&, const EJDOptions&, EJDStats *); \
+    extern template BasicJointCDF<Scalar> basic_joint_cdf<Scalar, NeumaierSummation>( \
+        const std::vector<std::vector<Scalar>>&, const std::vector<int>&, const EJDOptions&, EJDStats *);
+
+#define EJD_EXTERN_ENGINE(Scalar) \
+    EJD_EXTERN_JOINT_CDF(Scalar) \
+    extern template struct BasicExtremeMeasure<Scalar>; \
+    extern template BasicExtremeMeasure<Scalar> basic_ejd<Scalar, NaiveSummation>( \
+        const EmpDistrArray&, const std::vector<int>&, const EJDOptions&, EJDStats *); \
+    extern template BasicExtremeMeasure<Scalar> basic_ejd<Scalar, NeumaierSummation>( \
+        const EmpDistrArray&, const std::vector<int>&, const EJDOptions&, EJDStats *);
+
+EJD_EXTERN_ENGINE(float)
+EJD_EXTERN_ENGINE(double)
+EJD_EXTERN_ENGINE(long double)
+EJD_EXTERN_JOINT_CDF(Dual<1>)
+EJD_EXTERN_JOINT_CDF(Dual<2>)
+
+#undef EJD_EXTERN_ENGINE
+#undef EJD_EXTERN_JOINT_CDF
+
+// namespace ejd
+}
@@ -0,0 +1,133 @@
+#pragma once
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasures.hpp"
+// stl
+#include <cstddef>
+#include <vector>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// EJD Session
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// what the last update of an EJDSession did, summed over the structures
+struct EJDSessionStats
+{
+    bool rebuilt = false;               // every marginal changed, so everything was recomputed
+    std::size_t spliced = 0;            // structures updated by a splice, the others merged again
+    std::size_t merged_values = 0;      // cdf values merged again
+    std::size_t replaced = 0;           // breakpoints dropped and recomputed
+};
+
+// The marginals of one problem and, for each monotone structure, the merged breakpoints of
+// its extreme measure, kept up to date as single marginals change. measure(s) is always the
+// same as ejd(marginals(), monotone_structure(s), options), with the means and variances of
+// the marginals, but an update only merges again the cdf values near the old and the new values
+// of the changed marginal: the joint cdf is cut at gaps wider than the coalescing tolerance
+// around them, which every merge starts a breakpoint after anyway, and only those ranges are
+// merged and spliced in; the rest keeps its breakpoints and all coordinate columns but the
+// changed one. Finding those ranges costs a few binary searches per value of the changed
+// marginal, so when it has a sizeable share of the values (e.g. marginals on one common
+// support) the structure is merged again in full from the cached cdfs of the others instead.
+// Only the floating arithmetic is supported.
+class EJDSession
+{
+public:
+    EJDSession() = default;
+    // every structure of MonotonicityStructure(dim)
+    explicit EJDSession(EmpDistrArray marginals, const EJDOptions& options = EJDOptions());
+    EJDSession(EmpDistrArray marginals, std::vector<std::vector<int>> monotone_structures,
+        const EJDOptions& options = EJDOptions());
+
+    int dimension() const noexcept;
+    int num_structures() const noexcept;
+    const EmpDistrArray& marginals() const noexcept;
+    const std::vector<int>& monotone_structure(int s) const noexcept;
+    // valid until the next update
+    ExtremeMeasureView view(int s) const noexcept;
+    ExtremeMeasure measure(int s) const;
+    ExtremeMeasures measures() const;
+    const EJDSessionStats& last_update() const noexcept;
+
+    // replaces marginal j; throws std::invalid_argument if it is empty or j is out of range
+    void update_marginal(int j, EmpiricalDistribution marginal);
+
+    // Sessions made by construct_EJDSession from distributions: replaces the distribution of
+    // marginal j. The marginals share one support, so when the change moves its end every
+    // marginal changes and everything is rebuilt. Throws std::logic_error for other sessions.
+    void update_distribution(int j, const MarginalDistribution& distribution);
+
+private:
+    struct Structure
+    {
+        std::vector<int> monotone_structure;
+        // cdfs of the marginals flipped by the structure, and their rounding errors
+        std::vector<std::vector<double>> cdfs;
+        std::vector<std::vector<double>> cdf_errors;
+        std::vector<double> breakpoints;
+        std::vector<double> errors;
+        std::vector<double> weights;
+        std::vector<int> atoms;         // dim x size column-wise, index into the flipped support
+        std::vector<int> coords;        // dim x size column-wise
+    };
+
+    EmpDistrArray marginals_;
+    EJDOptions options;
+    double tol = 0;
+    std::vector<double> means;
+    std::vector<double> variances;
+    // support of every marginal, as is [0] and flipped [1]
+    std::vector<std::vector<int>> supports[2];
+    std::vector<Structure> structures;
+    EJDSessionStats stats;
+    // set by construct_EJDSession
+    std::vector<MarginalDistribution> distributions;
+    std::vector<int> upper_bounds;
+    double errtol = 0;
+
+    void set_marginal(int j);
+    void rebuild(Structure& st);
+    void fill_measure(Structure& st);
+    void splice(Structure& st, int j, const std::vector<double>& old_cdf);
+
+    friend EJDSession construct_EJDSession(const std::vector<MarginalDistribution>& distrs,
+        const EJDOptions& options, double errtol);
+};
+
+// the marginals of construct_EmpDistrArray(distrs, errtol) with every structure; the session
+// can then update one distribution at a time
+EJDSession construct_EJDSession(const std::vector<MarginalDistribution>& distrs,
+    const EJDOptions& options = EJDOptions(), double errtol = 1e-5);
+
+// the measures of construct_Poisson_ExtremeMeasures(intensities)
+EJDSession construct_Poisson_EJDSession(const std::vector<double>& intensities,
+    const EJDOptions& options = EJDOptions());
+
+// namespace ejd
+}
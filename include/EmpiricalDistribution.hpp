@@ -22,12 +22,20 @@
     DEALINGS IN THE SOFTWARE.
 */
 
+#include "Dual.hpp"
+#include "Kernels.hpp"
 #include "Utils/Zip.hpp"
 // 3rd party
 #include "boost/math/distributions.hpp"		// includes all distributions
 // stl
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <variant>
 #include <vector>
 
 namespace bm = boost::math;
@@ -55,12 +63,16 @@ bool valid_emp_distr(const std::vector<double>& p, double errtol=1e-7);
 template<typename T>
 double discrete_nth_moment(const std::vector<T>& weights, const std::vector<T>& support, const int& N)
 {
-	double moment = 0;
+	if constexpr (std::is_same_v<T, double>) {
+		return kernels::nth_moment(weights.data(), support.data(), std::min(weights.size(), support.size()), N);
+	} else {
+		double moment = 0;
 
-	for ( auto [w,s] : zip(weights,support) ) {
-		moment += w * std::pow(s,N);
+		for ( auto [w,s] : zip(weights,support) ) {
+			moment += w * std::pow(s,N);
+		}
+		return moment;
 	}
-	return moment;
 }
 
 template <typename T>	// restrict T to numeric types in the future w/ concepts
@@ -94,6 +106,13 @@ int upper_bounds(const Distribution& d, double errtol=1e-5) {
 //
 //////////////////////////////////////////////////////////////////////////////
 
+struct MarginalSummary {
+	double total_mass = 0;
+	double mean = 0;
+	double variance = 0;
+	double entropy = 0;
+};
+
 struct EmpiricalDistribution {
 	std::vector<double> weights;
 	std::vector<double> support;
@@ -104,6 +123,8 @@ struct EmpiricalDistribution {
 	double variance() const;
 	double total_prob() const;
 	double entropy() const;
+	// all of the above in a single pass over the marginal
+	MarginalSummary summary() const;
 };
 
 // TODO : force variable precision
@@ -142,6 +163,17 @@ struct EmpDistrArray
 	EmpDistrArray(const std::vector<EmpiricalDistribution> marginals)
 		: marginals(std::move(marginals))
 	{}
+	// the cache is immutable and checked against the marginals, so a copy can share it
+	EmpDistrArray(const EmpDistrArray& other)
+		: marginals(other.marginals), summary_cache(std::atomic_load(&other.summary_cache))
+	{}
+	EmpDistrArray(EmpDistrArray&& other) noexcept = default;
+	EmpDistrArray& operator=(const EmpDistrArray& other) {
+		marginals = other.marginals;
+		std::atomic_store(&summary_cache, std::atomic_load(&other.summary_cache));
+		return *this;
+	}
+	EmpDistrArray& operator=(EmpDistrArray&& other) noexcept = default;
 
 	// data
 	std::vector<EmpiricalDistribution> marginals;
@@ -150,14 +182,121 @@ struct EmpDistrArray
 	// member functions
 	std::vector<double> means() const;
 	std::vector<double> variances() const;
+	// both from one read of summaries()
+	void means_and_variances(std::vector<double> * means, std::vector<double> * variances) const;
 	int dimensions() const;
+	// Mean, variance, total mass and entropy of every marginal, computed in one pass and cached
+	// with a copy of the marginals they are of. A later call compares the marginals with that
+	// copy, which is much cheaper than the pass, and recomputes after any edit, so the
+	// marginals may be changed in place; the reference is valid until they are. Safe to call
+	// concurrently.
+	const std::vector<MarginalSummary>& summaries() const;
+	// drops the cache, e.g. to free it
+	void invalidate_summaries();
+
+private:
+	struct SummaryCache;
+	mutable std::shared_ptr<const SummaryCache> summary_cache;
 };
 
 // TODO : enable each underlying marginal distribution to have its own max_upperbound, ie, marginals with un-normalized supports
 EmpDistrArray construct_EmpDistrArray(const std::vector<bm::poisson>& poisson_distrs);
 
+// generic path: every atom and every tail probability is evaluated through Boost
+template <typename Distribution>
+EmpDistrArray construct_EmpDistrArray(const std::vector<Distribution>& distrs)
+{
+	int max_upper_bound = 0;
+	for (const auto & d : distrs) {
+		max_upper_bound = std::max(max_upper_bound, upper_bounds(d));
+	}
+
+	std::vector<EmpiricalDistribution> emp_distr_data;
+	emp_distr_data.reserve(distrs.size());
+	for (const auto & d : distrs) {
+		emp_distr_data.emplace_back(construct_discrete_EmpDistr(d, max_upper_bound));
+	}
+	return EmpDistrArray(emp_distr_data);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Recurrence Marginals
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// any other distribution on {0,1,...}, evaluated atom by atom through Boost
+struct GenericMarginal
+{
+	std::function<double(int)> pdf;
+	std::function<double(int)> tail;	// P(X > k)
+
+	template <typename Distribution>
+	explicit GenericMarginal(const Distribution& distr)
+		: pdf([distr] (int k) { return bm::pdf(distr,k); }),
+		  tail([distr] (int k) { return bm::cdf(bm::complement(distr,k)); })
+	{}
+};
+
+// Marginals of a heterogeneous array. The Poisson, binomial, negative binomial and geometric
+// families are evaluated with their pmf ratio p(k+1)/p(k), starting from a single Boost call at
+// the mode so that neither side underflows, and the tail is found from the running cdf in the
+// same pass.
+using MarginalDistribution = std::variant<
+	bm::poisson,
+	bm::binomial,
+	bm::negative_binomial,
+	bm::geometric,
+	GenericMarginal
+>;
+
+// same bound as upper_bounds: the first k with P(X > k) <= errtol
+int recurrence_upper_bounds(const MarginalDistribution& distr, double errtol=1e-5);
+
+// the atoms P(X = k) for k in [0, support_end)
+std::vector<double> recurrence_pmf(const MarginalDistribution& distr, int support_end);
+
+// like construct_EmpDistrArray: all marginals share the support [0, max upper bound) and have
+// their tail mass folded into their last atom
+EmpDistrArray construct_EmpDistrArray(const std::vector<MarginalDistribution>& distrs, double errtol=1e-5);
+
 // convenience function since Poisson distribution used widely
 EmpDistrArray construct_Poisson_EmpDistrArray(const std::vector<double>& intensities);
 
+// The weights construct_Poisson_EmpDistrArray gives a Poisson marginal on the support
+// [0, support_end), for any Scalar with exp and log, e.g. a Dual carrying derivatives by the
+// intensity: the same recurrences from the atom at the mode, with the tail mass folded into
+// the last atom, so the values are those of the double path.
+template <typename Scalar>
+std::vector<Scalar> basic_poisson_pmf(const Scalar& intensity, int support_end)
+{
+	using std::exp;
+	using std::log;
+	const double lambda = value_of(intensity);
+	const int mode = static_cast<int>(std::floor(lambda));
+	if (support_end <= 0) {
+		return {};
+	}
+
+	// p(mode) from Boost, times a factor that is one at the intensity and has its derivative
+	std::vector<Scalar> atoms(std::max(support_end, mode + 1));
+	atoms[mode] = bm::pdf(bm::poisson(lambda), mode) * exp(mode * log(intensity / lambda) - (intensity - lambda));
+	for (int k = mode; k > 0; --k) {
+		atoms[k-1] = atoms[k] * (Scalar(k) / intensity);
+	}
+	for (int k = mode + 1; k < support_end; ++k) {
+		atoms[k] = atoms[k-1] * (intensity / Scalar(k));
+	}
+	atoms.resize(support_end);
+
+	// as edit_sum_1
+	Scalar sum = 0;
+	for (int k = 0; k + 1 < support_end; ++k) {
+		sum += atoms[k];
+	}
+	atoms.back() = 1 - sum;
+	return atoms;
+}
+
 // namespace ejd
 }
@@ -0,0 +1,77 @@
+#pragma once
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ExtremeMeasures.hpp"
+#include "Utils/ThreadPool.hpp"
+// stl
+#include <cstddef>
+#include <vector>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Extreme Measure Batch
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// The extreme measures of many small problems of one dimension, every structure of every
+// portfolio, held in flat arrays. Measure m = portfolio * num_structures + structure has the
+// points [offsets[m], offsets[m+1]); its coordinates are stored column by column in
+// coords[dim * offsets[m], dim * offsets[m+1]), so view(m) is a plain ExtremeMeasureView.
+struct ExtremeMeasureBatch
+{
+    int dim = 0;
+    std::size_t num_portfolios = 0;
+    int num_structures = 0;
+    std::vector<int> monotone_structures;   // num_structures x dim, row-major
+    std::vector<double> means;              // num_portfolios x dim, of the truncated marginals
+    std::vector<double> variances;          // num_portfolios x dim
+    std::vector<std::size_t> offsets;       // size() + 1
+    std::vector<double> weights;
+    std::vector<int> coords;
+    // methods
+    int dimension() const noexcept;
+    std::size_t size() const noexcept;
+    std::size_t index(std::size_t portfolio, int structure) const noexcept;
+    std::size_t support_size(std::size_t m) const noexcept;
+    ExtremeMeasureView view(std::size_t m) const noexcept;
+    ExtremeMeasure measure(std::size_t m) const;
+};
+
+// The extreme measures of num_portfolios Poisson portfolios, intensities being their
+// num_portfolios x dim intensity matrix, row-major; the same measures as calling
+// construct_Poisson_ExtremeMeasures on each row. The structure table is built once, the
+// marginals of a portfolio once for all its structures, and the (portfolio, structure)
+// merges are spread over the pool. Only the floating arithmetic is supported, anything else
+// throws std::invalid_argument.
+ExtremeMeasureBatch construct_Poisson_ExtremeMeasureBatch(const double * intensities, std::size_t num_portfolios,
+    int dim, ThreadPool& pool, const EJDOptions& options = EJDOptions());
+
+// the same on a pool of its own, 0 threads for one per hardware thread
+ExtremeMeasureBatch construct_Poisson_ExtremeMeasureBatch(const std::vector<double>& intensities, int dim,
+    unsigned threads = 0, const EJDOptions& options = EJDOptions());
+
+// namespace ejd
+}
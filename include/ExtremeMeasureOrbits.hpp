@@ -0,0 +1,112 @@
+#pragma once
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasures.hpp"
+// stl
+#include <cstddef>
+#include <vector>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Extreme Measure Orbits
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// the work an ExtremeMeasureOrbits did and the work it saved over one ejd per structure
+struct OrbitStats
+{
+    std::size_t structures = 0;         // columns of MonotonicityStructure(dim)
+    std::size_t representatives = 0;   // of those, computed by ejd
+    std::size_t merged_values = 0;      // marginal cdf values merged for the representatives
+    std::size_t saved_values = 0;       // those the other structures would have merged
+};
+
+// The extreme measures of every structure of MonotonicityStructure(dim) for marginals some of
+// which are identical (equal weights and support). Swapping two identical marginals maps the
+// measure of a structure to the measure of the swapped structure with the two coordinates of
+// every point swapped, and flipping every sign gives the same measure with the support
+// reversed, so a structure only matters through the number of antitone marginals in each group
+// of identical ones. Only one representative per such orbit is computed by ejd, the
+// representative putting the comonotone marginals of each group first; measure(s) permutes the
+// coordinates of its representative on request. Reconstructed measures equal ejd(marginals(),
+// monotone_structure(s), options) up to the rounding of the weights when the orbit flips every
+// sign, and exactly otherwise. The merge folds a run of close breakpoints from its low end, so
+// the flip only holds when no more than equal values are folded: with the floating arithmetic
+// and a coalesce_tol at the engine's floor of 4 epsilon (e.g. 0). For any other options the
+// flipped structures get representatives of their own and nothing is flipped.
+class ExtremeMeasureOrbits
+{
+public:
+    ExtremeMeasureOrbits() = default;
+    // throws std::invalid_argument for no marginals or more than 31
+    explicit ExtremeMeasureOrbits(EmpDistrArray marginals, const EJDOptions& options = EJDOptions());
+
+    int dimension() const noexcept;
+    int num_structures() const noexcept;
+    int num_representatives() const noexcept;
+    const EmpDistrArray& marginals() const noexcept;
+    // groups of identical marginals, ordered by their first marginal; group(j) is the one of j
+    int num_groups() const noexcept;
+    int group(int j) const noexcept;
+
+    // column s of MonotonicityStructure(dim)
+    std::vector<int> monotone_structure(int s) const;
+    // index of the representative of structure s, and whether the orbit flips every sign
+    int representative(int s) const;
+    bool flipped(int s) const;
+    // coordinate j of the representative's points is coordinate permutation(s)[j] of s's
+    std::vector<int> permutation(int s) const;
+
+    const ExtremeMeasure& representative_measure(int r) const noexcept;
+    ExtremeMeasure measure(int s) const;
+    ExtremeMeasures measures() const;
+    const OrbitStats& stats() const noexcept;
+
+private:
+    EmpDistrArray marginals_;
+    std::vector<int> groups;
+    // members of every group, in increasing order
+    std::vector<std::vector<int>> members;
+    // the count of antitone marginals in every group as a mixed-radix number, and the
+    // representative of each canonical count (-1 for the others)
+    std::vector<std::size_t> strides;
+    std::vector<int> representatives;
+    std::vector<ExtremeMeasure> measures_;
+    OrbitStats stats_;
+    // whether orbits include flipping every sign
+    bool mirror = true;
+
+    // antitone marginals of every group in structure s, and whether they were flipped
+    std::vector<int> canonical_counts(int s, bool * flip) const;
+};
+
+// the measures of construct_Poisson_ExtremeMeasures(intensities), computing one per orbit
+ExtremeMeasureOrbits construct_Poisson_ExtremeMeasureOrbits(const std::vector<double>& intensities,
+    const EJDOptions& options = EJDOptions());
+
+// namespace ejd
+}
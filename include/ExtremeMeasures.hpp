@@ -27,8 +27,13 @@
 #include <blaze/math/DynamicMatrix.h>
 // stl
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <numeric>
+#include <stdexcept>
 #include <vector>
 
 namespace ejd {
@@ -38,6 +43,7 @@ namespace b = blaze;
 // fwd declarations
 struct EmpiricalDistribution;
 struct EmpDistrArray;
+struct EJDOptions;
 
 //////////////////////////////////////////////////////////////////////////////
 //
@@ -74,6 +80,8 @@ struct LatticePoint
     std::vector<int> point;
     // comparison operators 
     bool operator==(const LatticePoint & y) const;
+    bool operator!=(const LatticePoint & y) const;
+    // total order: by dimension, then lexicographic in the coordinates
     bool operator<(const LatticePoint & y) const;
     // constructors
     LatticePoint(const std::vector<int> point) 
@@ -86,6 +94,13 @@ struct LatticePoint
 
 std::ostream& operator<<(std::ostream& os, const LatticePoint& point);
 
+// componentwise dominance, a partial order: x != y and x_j >= y_j for every j
+bool dominates(const LatticePoint& x, const LatticePoint& y);
+
+// dominance along a monotone structure, i.e. on the coordinates flipped by it: each point of
+// an extreme measure's support dominates the ones before it
+bool dominates(const LatticePoint& x, const LatticePoint& y, const std::vector<int>& monotone_structure);
+
 //////////////////////////////////////////////////////////////////////////////
 //
 // Discrete Measure
@@ -98,15 +113,23 @@ struct DiscreteMeasure
     std::vector<double> weights;
     // operators
     DiscreteMeasure operator+(const DiscreteMeasure& other_dm);
+    // adds up the weights of equal points, the repeated ones within either measure included; the
+    // sum is sorted and coalesced. Measures of different dimensions throw std::invalid_argument
     DiscreteMeasure& operator+=(const DiscreteMeasure& other_dm);
     // methods
     int dimension() const noexcept;
     int size() const noexcept;
+    // sorts the support by LatticePoint::operator<, keeping every weight with its point
+    void sort();
+    bool is_sorted() const noexcept;
+    // sorts and merges repeated points into one, adding up their weights
+    void coalesce();
     // ExtremeMeasure marginalize(const std::vector<int> to_marginalize_out) const;
-protected:
-    void sort() noexcept;
 };
 
+// sum of two sorted measures in one linear pass; the result is sorted and coalesced
+DiscreteMeasure merge_sorted(const DiscreteMeasure& x, const DiscreteMeasure& y);
+
 //////////////////////////////////////////////////////////////////////////////
 //
 // Extreme Measure
@@ -159,8 +182,6 @@ struct ExtremeMeasure : public DiscreteMeasure
     std::vector<double> means;
     std::vector<double> variances;
     ExtremeMeasure marginalize(const std::vector<int>& to_marginalize_out) const;
-private:
-    void sort() noexcept;
 };
 
 // typedefs
@@ -170,6 +191,36 @@ std::ostream& operator<<(std::ostream& os, const ExtremeMeasure& em);
 
 ExtremeMeasures construct_Poisson_ExtremeMeasures(const std::vector<double>& intensities);
 
+// the same with options for every ejd call; options.cancellation is also polled between the
+// structures
+ExtremeMeasures construct_Poisson_ExtremeMeasures(const std::vector<double>& intensities,
+    const EJDOptions& options);
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Extreme Measure View
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// non-owning, read-only view of an extreme measure whose support is stored column-wise,
+// i.e. coordinate j of point i is coords[j * size + i]
+struct ExtremeMeasureView
+{
+    int dim = 0;
+    std::size_t size = 0;
+    const int * monotone_structure = nullptr;
+    const double * means = nullptr;
+    const double * variances = nullptr;
+    const double * weights = nullptr;
+    const int * coords = nullptr;
+    // methods
+    int dimension() const noexcept { return dim; }
+    const int * column(int j) const noexcept { return coords + j * size; }
+    int coord(std::size_t i, int j) const noexcept { return coords[j * size + i]; }
+    LatticePoint point(std::size_t i) const;
+    ExtremeMeasure to_ExtremeMeasure() const;
+};
+
 //////////////////////////////////////////////////////////////////////////////
 //
 // Extreme Joint Distribution
@@ -185,6 +236,25 @@ void apply_cumsum(std::vector<T> * v_ptr)
     }
 }
 
+// running sum with Neumaier compensation, so that the cdf of a long marginal still ends at 1
+template <typename T>
+void apply_compensated_cumsum(std::vector<T> * v_ptr)
+{
+    std::vector<T> & v = * v_ptr;
+    T sum = 0;
+    T compensation = 0;
+    for (auto & x : v) {
+        const T t = sum + x;
+        if (std::abs(sum) >= std::abs(x)) {
+            compensation += (sum - t) + x;
+        } else {
+            compensation += (x - t) + sum;
+        }
+        sum = t;
+        x = sum + compensation;
+    }
+}
+
 template <typename T>
 void apply_cumsum(std::vector<std::vector<T>> * v_ptr)
 {
@@ -234,9 +304,91 @@ std::vector<std::vector<double>> flip_supports(
     const std::vector<EmpiricalDistribution>& marginal_pdfs,
     const std::vector<int>& monotone_structs);
 
-void ensure_right_tail(std::vector<double> * prob_distr_);
+// expects a sorted cdf: drops the values within tol of 1 and ends it at exactly 1
+void ensure_right_tail(std::vector<double> * prob_distr_, double tol=1e-9);
+
+enum class EJDArithmetic
+{
+    floating,       // double cdfs, merged with coalesce_tol
+    fixed64,        // exact integer merge of the cdfs rounded to multiples of 2^-63
+    fixed128        // exact integer merge of the cdfs rounded to multiples of 2^-127
+};
+
+// thrown by the calls whose CancellationToken was cancelled or ran past its deadline
+struct EJDCancelled : std::runtime_error
+{
+    using std::runtime_error::runtime_error;
+};
+
+// Stops the calls it is handed to, from any thread: they poll it between structures and
+// between merge chunks of a few thousand cdf values, and throw EJDCancelled once cancel()
+// was called or the deadline has passed.
+class CancellationToken
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    CancellationToken() = default;
+    explicit CancellationToken(clock::time_point deadline) noexcept : deadline_(deadline) {}
+
+    void cancel() noexcept { cancelled.store(true, std::memory_order_relaxed); }
+    bool cancel_requested() const noexcept { return cancelled.load(std::memory_order_relaxed); }
+    clock::time_point deadline() const noexcept { return deadline_; }
+    bool stop_requested() const noexcept {
+        return cancel_requested() || (deadline_ != clock::time_point::max() && clock::now() >= deadline_);
+    }
+    void throw_if_stopped() const {
+        if (cancel_requested()) {
+            throw EJDCancelled("ejd: cancelled");
+        }
+        if (stop_requested()) {
+            throw EJDCancelled("ejd: deadline exceeded");
+        }
+    }
+
+private:
+    std::atomic<bool> cancelled {false};
+    clock::time_point deadline_ = clock::time_point::max();
+};
+
+struct EJDOptions
+{
+    // joint cdf breakpoints closer than this are folded into a single support point
+    double coalesce_tol = 1e-12;
+    // the fixed-point modes fold only equal breakpoints and ignore coalesce_tol
+    EJDArithmetic arithmetic = EJDArithmetic::floating;
+    // threads used for one measure (cdfs, merge and support), 0 for one per hardware thread;
+    // the result does not depend on it
+    unsigned threads = 1;
+    // polled by the floating arithmetic while it merges, and by the fixed-point modes before
+    // they start; must outlive the call
+    const CancellationToken * cancellation = nullptr;
+};
+
+struct EJDStats
+{
+    std::size_t breakpoints = 0;    // marginal cdf values fed into the merge
+    std::size_t folded = 0;         // of those, folded into a neighbouring breakpoint
+};
+
+// breakpoints of the joint cdf and, for each of them, the atom of every marginal it falls in
+struct JointCDF
+{
+    std::vector<double> breakpoints;    // strictly increasing, the last one is exactly 1
+    std::vector<int> indices;           // breakpoints.size() x dim, row-major
+};
+
+// merges the sorted marginal cdfs into the joint cdf; runs of values within tol of each other
+// become one breakpoint, as do the values within tol of 0 (dropped) and of 1 (the last one).
+// With several threads the merged sequence is cut at gaps wider than tol, which start a
+// breakpoint anyway, and the pieces are merged concurrently into the same joint cdf.
+JointCDF merge_marginal_cdfs(const std::vector<std::vector<double>>& marginal_cdfs, double tol,
+    EJDStats * stats = nullptr, unsigned threads = 1);
 
 ExtremeMeasure ejd(EmpDistrArray empdistrarrs, std::vector<int> monotone_structs);
 
+ExtremeMeasure ejd(const EmpDistrArray& empdistrarrs, const std::vector<int>& monotone_structs,
+    const EJDOptions& options, EJDStats * stats = nullptr);
+
 // namespace ejd
 }
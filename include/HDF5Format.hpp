@@ -0,0 +1,107 @@
+#pragma once
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+// only available when the library is built with EJD_HDF5 (defines EJD_WITH_HDF5)
+
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasures.hpp"
+// stl
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// HDF5 Format
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// File layout, readable from MATLAB (h5read) and Python (h5py):
+//
+//   /marginals/<j>/weights                  f64[L_j]
+//   /marginals/<j>/support                  f64[L_j]
+//   /measures/<i>/support                   i32[dim][S_i]   one row per coordinate
+//   /measures/<i>/weights                   f64[S_i]
+//   /measures/<i>/monotone_structure        i32[dim]
+//   /measures/<i>/means, variances          f64[dim]        (omitted when empty)
+//
+// Large datasets are chunked along the support so that ranges can be read back partially.
+
+struct HDF5Options
+{
+    std::size_t chunk_size = 1 << 16;   // elements per chunk along the support
+    int compression_level = 0;          // deflate level 0-9, 0 disables compression
+    bool shuffle = true;                // byte shuffle before deflate
+};
+
+constexpr std::size_t hdf5_all = std::numeric_limits<std::size_t>::max();
+
+void write_hdf5(const std::string& path, const EmpDistrArray& marginals, const ExtremeMeasures& ems,
+    const HDF5Options& options = HDF5Options());
+
+EmpDistrArray read_EmpDistrArray_hdf5(const std::string& path);
+
+std::size_t num_ExtremeMeasures_hdf5(const std::string& path);
+
+// every measure, in increasing order of the index it was written under
+ExtremeMeasures read_ExtremeMeasures_hdf5(const std::string& path);
+
+// reads only the selected measures, e.g. a subset of the monotone structures
+ExtremeMeasures read_ExtremeMeasures_hdf5(const std::string& path, const std::vector<std::size_t>& which);
+
+// reads the support points [begin, begin+count) of measure i
+ExtremeMeasure read_ExtremeMeasure_hdf5(const std::string& path, std::size_t i,
+    std::size_t begin = 0, std::size_t count = hdf5_all);
+
+// Streams measures into a file while they are still being computed. append and write may
+// be called concurrently: the columnar packing of a measure runs on the calling thread and
+// only the HDF5 calls are serialized, under a lock shared by every writer and reader of the
+// process.
+class HDF5Writer
+{
+public:
+    explicit HDF5Writer(const std::string& path, const HDF5Options& options = HDF5Options());
+    ~HDF5Writer();
+
+    HDF5Writer(const HDF5Writer&) = delete;
+    HDF5Writer& operator=(const HDF5Writer&) = delete;
+
+    void write(const EmpDistrArray& marginals);
+    // stores em under the next free index and returns that index
+    std::size_t append(const ExtremeMeasure& em);
+    // stores em under /measures/<index>, e.g. the index of its monotone structure
+    void write(std::size_t index, const ExtremeMeasure& em);
+    void flush();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+// namespace ejd
+}
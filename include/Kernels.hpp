@@ -0,0 +1,84 @@
+#pragma once
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+// stl
+#include <cstddef>
+
+namespace ejd {
+
+namespace kernels {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Kernel Selection
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Reductions over the marginals and supports, compiled once per instruction set and picked at
+// first use from the features of the running cpu. Every kernel uses a fixed number of lane
+// accumulators, a fixed combination order and its own polynomial log, so its results are
+// bit-reproducible for a given choice, but differ in the last bits between choices.
+// generic is two lanes for the default target (SSE2 on x86-64), and the only choice elsewhere.
+enum class KernelISA { generic, avx2, avx512 };
+
+const char * to_string(KernelISA isa);
+
+// the widest instruction set this binary and cpu both support
+KernelISA best_kernel_isa();
+
+KernelISA active_kernel_isa();
+
+// e.g. to reproduce results of another machine; throws std::invalid_argument if unsupported
+void set_kernel_isa(KernelISA isa);
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Kernels
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// sum_i w_i s_i^N; a negative N is summed without the vector lanes
+double nth_moment(const double * w, const double * s, std::size_t n, int N);
+
+// -sum_i w_i log(w_i), zero weights contribute nothing
+double entropy(const double * w, std::size_t n);
+
+// the sums behind mean, variance and entropy, in a single pass
+struct MomentSums
+{
+    double mass = 0;            // sum_i w_i
+    double first = 0;           // sum_i w_i s_i
+    double second = 0;          // sum_i w_i s_i^2
+    double entropy = 0;         // -sum_i w_i log(w_i)
+};
+
+MomentSums moment_sums(const double * w, const double * s, std::size_t n);
+
+// sum_i w_i x_i y_i over two support columns
+double bivariate_expectation(const int * x, const int * y, const double * w, std::size_t n);
+
+}   // namespace kernels
+
+// namespace ejd
+}
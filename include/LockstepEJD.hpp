@@ -0,0 +1,53 @@
+#pragma once
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasureBatch.hpp"
+#include "ExtremeMeasures.hpp"
+// stl
+#include <vector>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Lockstep EJD
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// The extreme measures of many small problems of one dimension under one monotone structure,
+// lanes of them at a time (4, 8 or 16) in the lanes of a vector register. Each lane holds the
+// cdfs of its problem padded to the longest marginal of the group; one merge step takes the
+// smallest head of every lane and advances the cursors under lane masks, so the lanes finish
+// in the same number of steps. Meant for problems with short supports, too small to fill a
+// register on their own; options.threads spreads the groups over threads.
+//
+// Measure p of the result is ejd(problems[p], monotone_structure, options), with
+// num_structures = 1. Only the floating arithmetic is supported. Throws std::invalid_argument
+// for any other arithmetic or lane count, a problem of another dimension or an empty marginal.
+ExtremeMeasureBatch lockstep_ejd(const std::vector<EmpDistrArray>& problems, const std::vector<int>& monotone_structure,
+    const EJDOptions& options = EJDOptions(), int lanes = 8);
+
+// namespace ejd
+}
@@ -0,0 +1,156 @@
+#pragma once
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ExtremeMeasures.hpp"
+#include "Utils/Parallel.hpp"
+// stl
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Mixture Measure
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// The convex combination sum_c weights[c] * components[c], kept as its components. Every
+// functional here is linear in the measure (or, like the correlation, built from linear ones),
+// so it is evaluated per component, on up to `threads` threads, and summed with the mixture
+// weights in component order; the result does not depend on the number of threads. The
+// components are shared and never copied, and a merged support is only built by materialize().
+struct MixtureMeasure
+{
+    std::vector<std::shared_ptr<const ExtremeMeasure>> components;
+    std::vector<double> weights;            // non-negative, summing to 1
+    // methods
+    int dimension() const noexcept;
+    std::size_t size() const noexcept;
+    double total_weight() const noexcept;
+    // E[f(X)] for f taking a LatticePoint and returning a double
+    template <typename F>
+    double expectation(F&& f, unsigned threads = 1) const;
+    // E[X_j^n] for every coordinate j
+    std::vector<double> moments(int n, unsigned threads = 1) const;
+    std::vector<double> means(unsigned threads = 1) const;
+    std::vector<double> variances(unsigned threads = 1) const;
+    // E[X_i X_j], and the covariance and correlation of X_i and X_j
+    double cross_moment(int i, int j, unsigned threads = 1) const;
+    double covariance(int i, int j, unsigned threads = 1) const;
+    double correlation(int i, int j, unsigned threads = 1) const;
+    // P(X_j >= k)
+    double tail_probability(int j, int k, unsigned threads = 1) const;
+    // P(X >= x), coordinatewise
+    double joint_tail_probability(const LatticePoint& x, unsigned threads = 1) const;
+    // n draws, n x dim row-major: a component by its weight, then a point by its weight in it
+    template <typename URNG>
+    std::vector<int> sample(URNG& gen, std::size_t n) const;
+    // the merged measure: sorted, every point once, with its weight summed over the components
+    DiscreteMeasure materialize(unsigned threads = 1) const;
+};
+
+// throws std::invalid_argument unless there is one non-negative weight per component, some
+// weight is positive and all components are non-empty and of the same dimension; the weights
+// are divided by their sum
+MixtureMeasure construct_MixtureMeasure(std::vector<std::shared_ptr<const ExtremeMeasure>> components,
+    std::vector<double> weights);
+
+// shares copies of the measures
+MixtureMeasure construct_MixtureMeasure(const ExtremeMeasures& components, std::vector<double> weights);
+
+namespace detail {
+
+// sum_c weights[c] * f(*components[c]), with the f(*components[c]) evaluated in parallel
+template <typename F>
+double mixture_sum(const MixtureMeasure& mm, F&& f, unsigned threads)
+{
+    std::vector<double> values(mm.size());
+    parallel_for(0, mm.size(), threads, [&] (std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c) {
+            values[c] = f(*mm.components[c]);
+        }
+    }, 1);
+    double sum = 0;
+    for (std::size_t c = 0; c < values.size(); ++c) {
+        sum += mm.weights[c] * values[c];
+    }
+    return sum;
+}
+
+}   // namespace detail
+
+template <typename F>
+double MixtureMeasure::expectation(F&& f, unsigned threads) const
+{
+    return detail::mixture_sum(*this, [&f] (const ExtremeMeasure& em) {
+        double sum = 0;
+        for (std::size_t i = 0; i < em.support.size(); ++i) {
+            sum += em.weights[i] * f(em.support[i]);
+        }
+        return sum;
+    }, threads);
+}
+
+template <typename URNG>
+std::vector<int> MixtureMeasure::sample(URNG& gen, std::size_t n) const
+{
+    const int dim = dimension();
+    std::vector<double> mixture_cdf(weights);
+    std::partial_sum(mixture_cdf.begin(), mixture_cdf.end(), mixture_cdf.begin());
+
+    // cdfs of the components that can be drawn, and the last of them, which is drawn when u
+    // rounds up to the total
+    std::vector<std::vector<double>> cdfs(size());
+    std::size_t last = 0;
+    for (std::size_t c = 0; c < size(); ++c) {
+        if (weights[c] > 0) {
+            cdfs[c] = components[c]->weights;
+            std::partial_sum(cdfs[c].begin(), cdfs[c].end(), cdfs[c].begin());
+            last = c;
+        }
+    }
+
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<int> points(n * dim);
+    for (std::size_t s = 0; s < n; ++s) {
+        const double u = uniform(gen) * mixture_cdf.back();
+        const std::size_t c = std::min<std::size_t>(
+            std::upper_bound(mixture_cdf.begin(), mixture_cdf.end(), u) - mixture_cdf.begin(), last);
+        const auto & cdf = cdfs[c];
+        const double v = uniform(gen) * cdf.back();
+        const std::size_t i = std::min<std::size_t>(
+            std::upper_bound(cdf.begin(), cdf.end(), v) - cdf.begin(), cdf.size() - 1);
+        std::copy(components[c]->support[i].point.begin(), components[c]->support[i].point.end(),
+            points.begin() + s * dim);
+    }
+    return points;
+}
+
+// namespace ejd
+}
@@ -0,0 +1,116 @@
+#pragma once
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ExtremeMeasures.hpp"
+// stl
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Lattice Point Hash
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Points of up to 8 coordinates in [-2^15, 2^15) are packed 16 bits per coordinate into one
+// or two 64-bit words and mixed; anything else is hashed coordinate by coordinate. Both give
+// the same hash for equal points, as a point is always hashed the same way.
+struct LatticePointHash
+{
+    std::size_t operator()(const int * coords, int dim) const noexcept;
+    std::size_t operator()(const LatticePoint& p) const noexcept {
+        return (*this)(p.point.data(), p.dimension());
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Flat Point Map
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Assigns the distinct points of one dimension the dense indices 0, 1, ... in insertion order.
+// The points are stored back to back in one array and looked up through an open-addressing
+// table of 64-bit slots, each holding an index and the upper half of its point's hash, so a
+// probe only touches a point's coordinates when the hash fragment matches. Linear probing,
+// at most half full.
+class FlatPointMap
+{
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    explicit FlatPointMap(int dim = 0, std::size_t expected_size = 0);
+
+    int dimension() const noexcept { return dim; }
+    std::size_t size() const noexcept { return count; }
+    bool empty() const noexcept { return count == 0; }
+
+    // index of the point, or npos
+    std::size_t find(const int * coords) const;
+    std::size_t find(const LatticePoint& p) const { return find(p.point.data()); }
+
+    // index of the point, inserting it under the next index if it is new; second is true if it was
+    std::pair<std::size_t, bool> insert(const int * coords);
+    std::pair<std::size_t, bool> insert(const LatticePoint& p) { return insert(p.point.data()); }
+
+    // coordinates of the point with this index
+    const int * point(std::size_t index) const { return coords.data() + index * dim; }
+
+    void reserve(std::size_t n);
+    void clear();
+    std::size_t memory_bytes() const;
+
+private:
+    std::size_t probe(const int * coords, std::uint64_t hash) const;
+    void rehash(std::size_t capacity);
+
+    int dim = 0;
+    std::size_t count = 0;
+    std::vector<int> coords;
+    std::vector<std::uint64_t> slots;   // 0 empty, else (hash >> 32) << 32 | (index + 1)
+    std::size_t mask = 0;
+};
+
+// index of every point of a support; duplicated points keep their first index
+FlatPointMap index_support(const std::vector<LatticePoint>& support);
+
+// namespace ejd
+}
+
+namespace std {
+
+template <>
+struct hash<ejd::LatticePoint>
+{
+    std::size_t operator()(const ejd::LatticePoint& p) const noexcept {
+        return ejd::LatticePointHash()(p);
+    }
+};
+
+}   // namespace std
@@ -0,0 +1,94 @@
+#pragma once
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasures.hpp"
+// stl
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Quantile Coupling
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// The extreme measure of a structure is the law of (F_1^{-1}(U), ..., F_d^{-1}(U)) for a
+// single uniform U, with F_j the cdf of marginal j taken along its flipped support. This
+// holds only the d marginal cdfs, so u is mapped to its support point without building the
+// measure: point(u) has, in coordinate j, the first atom whose cdf reaches u. For every u
+// away from the breakpoints that ejd() folds together, this is the point of the measure
+// whose cdf interval contains u.
+//
+// A lookup starts from a guide table with one entry per atom, which indexes the cdf by
+// u in equal steps, so the expected number of cdf comparisons is at most two per marginal.
+struct QuantileCoupling
+{
+    struct Marginal
+    {
+        std::vector<double> cdf;            // along the flipped support, the last value is 1
+        std::vector<int> values;            // flipped support
+        std::vector<std::uint32_t> guide;   // guide[g]: first atom whose cdf reaches g / guide.size()
+    };
+
+    int dim = 0;
+    std::vector<int> monotone_structure;
+    std::vector<Marginal> marginals;
+    // methods
+    int dimension() const noexcept;
+    std::size_t memory_bytes() const noexcept;
+    // atom of the flipped marginal j that u falls in; u is clamped to [0, 1], NaN to 0
+    std::size_t atom(int j, double u) const noexcept;
+    // writes the dim coordinates of the point for u
+    void point(double u, int * out) const noexcept;
+    LatticePoint point(double u) const;
+    // points for non-decreasing us in one merge pass over the cdfs, us.size() x dim row-major;
+    // throws std::invalid_argument if us is not sorted or has NaN
+    std::vector<int> points_sorted(const std::vector<double>& us) const;
+    // n draws from the extreme measure, n x dim row-major
+    template <typename URNG>
+    std::vector<int> sample(URNG& gen, std::size_t n) const;
+};
+
+// throws std::invalid_argument unless the structure has one entry of +1 or -1 per marginal
+QuantileCoupling construct_QuantileCoupling(const EmpDistrArray& empdistrarrs,
+    const std::vector<int>& monotone_structure);
+
+template <typename URNG>
+std::vector<int> QuantileCoupling::sample(URNG& gen, std::size_t n) const
+{
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<int> points(n * dim);
+    for (std::size_t i = 0; i < n; ++i) {
+        point(uniform(gen), points.data() + i * dim);
+    }
+    return points;
+}
+
+// namespace ejd
+}
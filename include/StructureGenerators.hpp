@@ -0,0 +1,170 @@
+#pragma once
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasures.hpp"
+#include "Utils/ThreadPool.hpp"
+// stl
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Structure Masks
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// A monotone structure packed one bit per marginal, set for the flipped (-1) ones. Marginal 0
+// is never flipped: a structure and its mirror image give the same coupling, and
+// MonotonicityStructure(d) lists one of each. For d <= 64 its structure s packs to s << 1.
+struct StructureMask
+{
+    int dim = 0;
+    std::vector<std::uint64_t> words;   // (dim + 63) / 64
+    // constructors
+    StructureMask() = default;
+    explicit StructureMask(int dim)
+        : dim(dim), words((dim + 63) / 64, 0)
+    {}
+    // operators
+    bool operator==(const StructureMask& y) const;
+    bool operator!=(const StructureMask& y) const;
+    // methods
+    bool flipped(int j) const noexcept { return (words[j >> 6] >> (j & 63)) & 1; }
+    void set_flipped(int j, bool flip) noexcept;
+    // +1/-1 for every marginal, as ejd takes them
+    std::vector<int> signs() const;
+};
+
+// the signs of a monotone structure packed; one that flips marginal 0 becomes its mirror image
+StructureMask pack_structure(const std::vector<int>& monotone_structure);
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Structure Generators
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// For dimensions where the 2^(d-1) structures of MonotonicityStructure cannot be listed: the
+// generators produce structures one at a time, each in O(dim) words of work or, for sign
+// patterns, O(dim + number of pairs with a wanted sign), so the cost only grows with the
+// number of structures asked for.
+class StructureGenerator
+{
+public:
+    virtual ~StructureGenerator() = default;
+    virtual int dimension() const noexcept = 0;
+    // writes the next structure to *mask, false once there are none left
+    virtual bool next(StructureMask * mask) = 0;
+};
+
+// count structures drawn uniformly, with replacement, from all 2^(d-1)
+class RandomStructures : public StructureGenerator
+{
+public:
+    RandomStructures(int dim, std::size_t count, std::uint64_t seed = 0);
+    int dimension() const noexcept override;
+    bool next(StructureMask * mask) override;
+
+private:
+    int dim;
+    std::size_t remaining;
+    std::mt19937_64 gen;
+};
+
+// count structures that mostly follow a pattern of correlation signs. target is dim x dim,
+// row-major, target[i * dim + j] the wanted sign (+1, -1, or 0 for none) of the correlation of
+// marginals i and j, which a structure makes signs[i] * signs[j]; only i < j is read. The
+// signs are decided in order of the marginals: each one takes the side most of its wanted
+// signs with the marginals before it ask for with probability fidelity, and the other side
+// otherwise, or a fair coin if they are split. A fidelity of 1 always gives the greedy fit of
+// the pattern, 0.5 uniform structures.
+class SignPatternStructures : public StructureGenerator
+{
+public:
+    SignPatternStructures(int dim, const std::vector<int>& target, std::size_t count, double fidelity = 0.9,
+        std::uint64_t seed = 0);
+    int dimension() const noexcept override;
+    bool next(StructureMask * mask) override;
+
+private:
+    struct Wanted
+    {
+        int other;      // an earlier marginal
+        int sign;
+    };
+
+    int dim;
+    std::size_t remaining;
+    double fidelity;
+    // the wanted signs of every marginal with the earlier ones
+    std::vector<std::vector<Wanted>> wanted;
+    std::vector<int> signs;
+    std::mt19937_64 gen;
+};
+
+// the given structures, in order
+class ExplicitStructures : public StructureGenerator
+{
+public:
+    ExplicitStructures(int dim, std::vector<StructureMask> masks);
+    int dimension() const noexcept override;
+    bool next(StructureMask * mask) override;
+
+private:
+    int dim;
+    std::vector<StructureMask> masks;
+    std::size_t position = 0;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Streaming EJD
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// receives the k-th structure of a generator and a view of its measure, valid during the call
+using StructureSink = std::function<void(std::size_t k, const StructureMask& mask, const ExtremeMeasureView& em)>;
+
+// Calls sink for every structure the generator produces, in order, with em.to_ExtremeMeasure()
+// equal to ejd(marginals, mask.signs(), options) plus the means and variances of the marginals. The
+// cdfs of the marginals are summed once in both directions; a structure then swaps in the
+// direction of each of its marginals, so all it costs on top of its merge is O(dim). With a
+// pool, as many structures as it has threads (plus the caller) are merged at a time, which
+// bounds the memory whatever the number of structures; sink always runs on the calling thread.
+// Only the floating arithmetic is supported, anything else throws std::invalid_argument, as
+// does a generator of another dimension. Returns the number of structures.
+std::size_t stream_ejd(const EmpDistrArray& marginals, StructureGenerator& structures, const StructureSink& sink,
+    const EJDOptions& options = EJDOptions());
+
+std::size_t stream_ejd(const EmpDistrArray& marginals, StructureGenerator& structures, const StructureSink& sink,
+    ThreadPool& pool, const EJDOptions& options = EJDOptions());
+
+// namespace ejd
+}
@@ -0,0 +1,58 @@
+#pragma once
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ExtremeMeasures.hpp"
+// stl
+#include <cstdio>
+#include <string>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Text Format
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Plain-text writers meant to be parsed back, unlike operator<<: no colour codes, and
+// doubles are printed in their shortest round-trip form. Output is formatted into a large
+// in-memory buffer and handed to the FILE in big blocks. I/O errors throw std::runtime_error.
+//
+// CSV:  header "weight,x0,...,x{d-1}", then one row per support point.
+// JSON: {"dimension":d, "monotone_structure":[...], "means":[...], "variances":[...],
+//        "weights":[...], "support":[[x0 column], ..., [x{d-1} column]]}
+//        with missing or non-finite means/variances written as null.
+
+void write_csv(std::FILE * out, const ExtremeMeasure& em);
+void write_csv(std::FILE * out, const ExtremeMeasureView& em);
+void write_csv(const std::string& path, const ExtremeMeasure& em);
+
+void write_json(std::FILE * out, const ExtremeMeasure& em);
+void write_json(std::FILE * out, const ExtremeMeasureView& em);
+// a JSON array of measures
+void write_json(std::FILE * out, const ExtremeMeasures& ems);
+void write_json(const std::string& path, const ExtremeMeasures& ems);
+
+// namespace ejd
+}
@@ -0,0 +1,94 @@
+#pragma once
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+// stl
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace ejd {
+
+// number of threads for a request of n, where 0 asks for one per hardware thread
+inline unsigned resolve_threads(unsigned n) {
+    return n > 0 ? n : std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+// calls f(t) for t in [0, n), each on its own thread with f(0) on the calling one, and
+// rethrows the exception of the lowest t that threw, once all of them are done
+template <typename F>
+void parallel_invoke(unsigned n, F&& f)
+{
+    if (n <= 1) {
+        if (n == 1) {
+            f(0u);
+        }
+        return;
+    }
+    std::vector<std::exception_ptr> errors(n);
+    std::vector<std::thread> threads;
+    threads.reserve(n - 1);
+    for (unsigned t = 1; t < n; ++t) {
+        threads.emplace_back([&f, &errors, t] () {
+            try {
+                f(t);
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    try {
+        f(0u);
+    } catch (...) {
+        errors[0] = std::current_exception();
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+    for (auto & error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+// splits [begin, end) into one contiguous block per thread, none shorter than min_block
+// unless the range is, and calls f(block_begin, block_end) for each
+template <typename F>
+void parallel_for(std::size_t begin, std::size_t end, unsigned threads, F&& f, std::size_t min_block = 1 << 12)
+{
+    if (end <= begin) {
+        return;
+    }
+    const std::size_t n = end - begin;
+    const std::size_t blocks = std::max<std::size_t>(1,
+        std::min<std::size_t>(resolve_threads(threads), n / std::max<std::size_t>(min_block, 1)));
+    parallel_invoke(blocks, [&] (unsigned t) {
+        f(begin + n * t / blocks, begin + n * (t + 1) / blocks);
+    });
+}
+
+// namespace ejd
+}
@@ -23,6 +23,7 @@
 */
 
 #include <cstdlib>
+#include <limits>
 
 namespace ejd {
 
@@ -0,0 +1,154 @@
+#pragma once
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Utils/Parallel.hpp"
+// stl
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ejd {
+
+// A fixed set of worker threads running submitted tasks in submission order. Tasks must not
+// wait on other tasks of the same pool, which could leave no worker free to run them;
+// for_each_index avoids that by having the calling thread work along.
+class ThreadPool
+{
+public:
+    // 0 for one worker per hardware thread
+    explicit ThreadPool(unsigned threads = 0) {
+        const unsigned n = resolve_threads(threads);
+        workers.reserve(n);
+        for (unsigned t = 0; t < n; ++t) {
+            workers.emplace_back([this] () { work(); });
+        }
+    }
+
+    // runs the tasks already submitted, then joins the workers
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto & worker : workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const noexcept { return workers.size(); }
+
+    // the future holds f's result or exception
+    template <typename F>
+    auto submit(F&& f) -> std::future<std::invoke_result_t<F>> {
+        using Result = std::invoke_result_t<F>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(f));
+        auto future = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.emplace_back([task] () { (*task)(); });
+        }
+        wake.notify_one();
+        return future;
+    }
+
+    // calls f(i) for every i in [0, n), handed out one at a time to the workers and the
+    // calling thread; rethrows the first exception once every started call is done
+    template <typename F>
+    void for_each_index(std::size_t n, F&& f) {
+        std::atomic<std::size_t> next {0};
+        std::atomic<bool> failed {false};
+        auto drain = [&] () {
+            for (std::size_t i = next++; i < n && !failed; i = next++) {
+                try {
+                    f(i);
+                } catch (...) {
+                    failed = true;
+                    throw;
+                }
+            }
+        };
+        std::vector<std::future<void>> helpers;
+        const std::size_t n_helpers = std::min<std::size_t>(size(), n > 0 ? n - 1 : 0);
+        helpers.reserve(n_helpers);
+        for (std::size_t h = 0; h < n_helpers; ++h) {
+            helpers.push_back(submit(drain));
+        }
+        std::exception_ptr error;
+        try {
+            drain();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        for (auto & helper : helpers) {
+            try {
+                helper.get();
+            } catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    void work() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] () { return stopping || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+// namespace ejd
+}
@@ -1,3 +1,4 @@
+#pragma once
 /*
     This file is part of EJD.
 
@@ -21,11 +22,135 @@
     DEALINGS IN THE SOFTWARE.
 */
 
-// #include <Eigen/Core>
+// C interface of the library, for C and Fortran callers.
+//
+// Objects are opaque handles made by a *_create / compute function and released with the
+// matching *_destroy, which accepts NULL. Results are written into buffers owned by the
+// caller, whose capacities (in elements) are passed along; *_size functions tell how large
+// they must be. No function lets an exception escape or hands out memory to be freed by the
+// caller: failures are reported as an ejd_status, with a message from ejd_last_error().
+//
+// An ejd_context carries the options and a thread pool; any number of threads may use one
+// context concurrently. Other handles are immutable once made and may be shared as well.
+// Every array is contiguous; matrices are row-major unless stated otherwise.
+
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
-extern "C" 
+extern "C" {
+#endif
+
+typedef enum ejd_status
 {
-	// Eigen::Vector4d my_test_gen();
-	char test();
+	EJD_OK = 0,
+	EJD_INVALID_ARGUMENT = 1,		// a null pointer, a bad size or a value out of range
+	EJD_BUFFER_TOO_SMALL = 2,		// nothing was written; query the size and retry
+	EJD_OUT_OF_MEMORY = 3,
+	EJD_INTERNAL_ERROR = 4
+} ejd_status;
+
+typedef struct ejd_context ejd_context;
+typedef struct ejd_marginals ejd_marginals;
+typedef struct ejd_measure ejd_measure;
+
+// static description of a status
+const char * ejd_status_string(ejd_status status);
+
+// message of the last call on this thread that did not return EJD_OK, "" if none; valid
+// until the next failing call on the same thread
+const char * ejd_last_error(void);
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Context
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// threads: size of the pool, 0 for one per hardware thread; coalesce_tol: the breakpoint
+// tolerance of the measures, 0 for the library default
+ejd_status ejd_context_create(unsigned threads, double coalesce_tol, ejd_context ** context);
+void ejd_context_destroy(ejd_context * context);
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Marginals
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// dim Poisson marginals with the given (positive) intensities, truncated to their numerical support
+ejd_status ejd_marginals_poisson(const double * intensities, size_t dim, ejd_marginals ** marginals);
+
+// dim empirical marginals, marginal j with lengths[j] atoms; weights and support hold the
+// atoms of all marginals one after the other, each support sorted in increasing order and made
+// of integers in the range of int
+ejd_status ejd_marginals_create(size_t dim, const size_t * lengths, const double * weights,
+	const double * support, ejd_marginals ** marginals);
+
+void ejd_marginals_destroy(ejd_marginals * marginals);
+
+ejd_status ejd_marginals_dimension(const ejd_marginals * marginals, size_t * dim);
+
+// dim means and variances of the marginals, either may be NULL
+ejd_status ejd_marginals_moments(const ejd_marginals * marginals, double * means, double * variances);
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Monotone Structures
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// the 2^(dim-1) monotone structures of dimension dim, each a vector of dim entries +1 / -1
+ejd_status ejd_num_structures(size_t dim, size_t * count);
+ejd_status ejd_structure(size_t dim, size_t index, int * monotone_structure);
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Extreme Measures
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// the extreme measure of the marginals under a monotone structure of dim entries +1 / -1
+ejd_status ejd_measure_compute(ejd_context * context, const ejd_marginals * marginals,
+	const int * monotone_structure, ejd_measure ** measure);
+
+void ejd_measure_destroy(ejd_measure * measure);
+
+// number of support points and dimension
+ejd_status ejd_measure_size(const ejd_measure * measure, size_t * size, size_t * dim);
+
+// size weights, and the size x dim support stored column-wise (coordinate j of point i at
+// coords[j * size + i]); either buffer may be NULL
+ejd_status ejd_measure_copy(const ejd_measure * measure, double * weights, size_t weights_capacity,
+	int * coords, size_t coords_capacity);
+
+// Pearson correlation of a two-dimensional measure
+ejd_status ejd_measure_correlation(const ejd_measure * measure, double * correlation);
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Correlation Bounds
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// the smallest and largest correlation of num_pairs bivariate Poisson laws; intensities holds
+// the num_pairs x 2 intensities, lower and upper num_pairs values each. The pairs are spread
+// over the context's pool.
+ejd_status ejd_correlation_bounds(ejd_context * context, const double * intensities, size_t num_pairs,
+	double * lower, double * upper);
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Samples
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// n draws from the extreme measure of the marginals under the monotone structure, written as
+// n x dim coordinates into points (capacity at least n * dim). The draws only depend on seed
+// and n, not on the number of threads.
+ejd_status ejd_sample(ejd_context * context, const ejd_marginals * marginals, const int * monotone_structure,
+	uint64_t seed, size_t n, int * points, size_t capacity);
+
+#ifdef __cplusplus
 }
 #endif
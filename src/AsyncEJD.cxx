@@ -0,0 +1,284 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "AsyncEJD.hpp"
+#include "Correlation.hpp"
+#include "QuantileCoupling.hpp"
+#include "Utils/Parallel.hpp"
+// std libs
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <random>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Async Executor
+//
+//////////////////////////////////////////////////////////////////////////////
+
+struct AsyncExecutor::Request
+{
+	RequestPriority priority = RequestPriority::batch;
+	std::shared_ptr<const CancellationToken> token;
+	std::size_t steps = 0;
+	std::size_t next = 0;       // first step not started yet, guarded by the executor's mutex
+	std::function<void(std::size_t)> step;
+	std::function<void()> finish;
+	std::function<void(std::exception_ptr)> fail;
+	std::atomic<std::size_t> done {0};
+	std::atomic<bool> failed {false};
+	std::exception_ptr error;   // set by the step that failed first
+
+	// a failed or stopped request has nothing left to run
+	bool stopped() const noexcept {
+		return failed || (token && token->stop_requested());
+	}
+
+	// runs step i, or only accounts for the count steps from i when they are skipped; the
+	// last one to finish completes the future
+	void run(std::size_t i, std::size_t count) {
+		if (!failed) {
+			try {
+				if (token) {
+					token->throw_if_stopped();
+				}
+				if (count == 1) {
+					step(i);
+				}
+			} catch (...) {
+				if (!failed.exchange(true)) {
+					error = std::current_exception();
+				}
+			}
+		}
+		if (done.fetch_add(count) + count == steps) {
+			if (failed) {
+				fail(error);
+			} else {
+				finish();
+			}
+		}
+	}
+};
+
+AsyncExecutor::AsyncExecutor(unsigned threads)
+{
+	const unsigned n = resolve_threads(threads);
+	workers.reserve(n);
+	for (unsigned t = 0; t < n; ++t) {
+		workers.emplace_back([this] () { work(); });
+	}
+}
+
+AsyncExecutor::~AsyncExecutor()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (auto & worker : workers) {
+		worker.join();
+	}
+}
+
+unsigned AsyncExecutor::size() const noexcept
+{
+	return workers.size();
+}
+
+std::size_t AsyncExecutor::pending() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::size_t n = 0;
+	for (const auto & queue : queues) {
+		for (const auto & request : queue) {
+			n += request->steps - request->next;
+		}
+	}
+	return n;
+}
+
+template <typename Result, typename Step>
+std::future<Result> AsyncExecutor::run(const RequestOptions& options, std::size_t steps,
+	std::shared_ptr<Result> result, Step step)
+{
+	auto promise = std::make_shared<std::promise<Result>>();
+	auto future = promise->get_future();
+	auto request = std::make_shared<Request>();
+	request->priority = options.priority;
+	request->token = options.token;
+	request->steps = steps;
+	request->step = std::move(step);
+	request->finish = [promise, result] () { promise->set_value(std::move(*result)); };
+	request->fail = [promise] (std::exception_ptr error) { promise->set_exception(error); };
+
+	if (steps == 0) {
+		// nothing to queue, but a stopped token still fails it
+		try {
+			if (request->token) {
+				request->token->throw_if_stopped();
+			}
+			request->finish();
+		} catch (const EJDCancelled&) {
+			request->fail(std::current_exception());
+		}
+		return future;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queues[static_cast<int>(request->priority)].push_back(std::move(request));
+	}
+	wake.notify_all();
+	return future;
+}
+
+void AsyncExecutor::work()
+{
+	auto & interactive = queues[static_cast<int>(RequestPriority::interactive)];
+	auto & batch = queues[static_cast<int>(RequestPriority::batch)];
+	for (;;) {
+		std::shared_ptr<Request> request;
+		std::size_t first = 0;
+		std::size_t count = 1;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&] () { return stopping || !interactive.empty() || !batch.empty(); });
+			auto & queue = interactive.empty() ? batch : interactive;
+			if (queue.empty()) {
+				return;
+			}
+			request = std::move(queue.front());
+			queue.pop_front();
+			// one step at a time, the requests of a priority in turns; the steps of a stopped
+			// request are all skipped at once
+			first = request->next;
+			count = request->stopped() ? request->steps - first : 1;
+			request->next += count;
+			if (request->next < request->steps) {
+				queue.push_back(request);
+			}
+		}
+		request->run(first, count);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Requests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+std::future<ExtremeMeasures> AsyncExecutor::submit_measures(EmpDistrArray marginals,
+	std::vector<std::vector<int>> structures, const RequestOptions& request)
+{
+	struct State
+	{
+		EmpDistrArray marginals;
+		std::vector<std::vector<int>> structures;
+		EJDOptions options;
+		std::vector<double> means;
+		std::vector<double> variances;
+	};
+	auto state = std::make_shared<State>();
+	marginals.means_and_variances(&state->means, &state->variances);
+	state->marginals = std::move(marginals);
+	state->structures = std::move(structures);
+	state->options = request.options;
+	state->options.cancellation = request.token.get();
+
+	const std::size_t n = state->structures.size();
+	auto result = std::make_shared<ExtremeMeasures>(n);
+	return run(request, n, result, [state, result] (std::size_t s) {
+		auto & em = (*result)[s];
+		em = ejd(state->marginals, state->structures[s], state->options);
+		em.means = state->means;
+		em.variances = state->variances;
+	});
+}
+
+std::future<ExtremeMeasures> AsyncExecutor::submit_Poisson_measures(std::vector<double> intensities,
+	const RequestOptions& request)
+{
+	const MonotonicityStructure ms(intensities.size());
+	std::vector<std::vector<int>> structures(ms.num_extremepts());
+	for (int s = 0; s < ms.num_extremepts(); ++s) {
+		structures[s] = ms[s];
+	}
+	return submit_measures(construct_Poisson_EmpDistrArray(intensities), std::move(structures), request);
+}
+
+std::future<std::vector<std::pair<double,double>>> AsyncExecutor::submit_correlation_bounds(
+	std::vector<std::pair<double,double>> intensity_pairs, const RequestOptions& request)
+{
+	auto pairs = std::make_shared<const std::vector<std::pair<double,double>>>(std::move(intensity_pairs));
+	auto result = std::make_shared<std::vector<std::pair<double,double>>>(pairs->size());
+	return run(request, pairs->size(), result, [pairs, result] (std::size_t i) {
+		(*result)[i] = poiss_correlation_bounds_2d((*pairs)[i].first, (*pairs)[i].second);
+	});
+}
+
+std::future<std::vector<int>> AsyncExecutor::submit_samples(EmpDistrArray marginals,
+	std::vector<int> monotone_structure, std::size_t n, std::uint64_t seed, const RequestOptions& request)
+{
+	struct State
+	{
+		EmpDistrArray marginals;
+		std::vector<int> monotone_structure;
+		// built by the first step to run
+		std::once_flag built;
+		QuantileCoupling coupling;
+	};
+	auto state = std::make_shared<State>();
+	const std::size_t dim = marginals.dimensions();
+	state->marginals = std::move(marginals);
+	state->monotone_structure = std::move(monotone_structure);
+
+	auto result = std::make_shared<std::vector<int>>(n * dim);
+	const std::size_t blocks = (n + sample_block - 1) / sample_block;
+	return run(request, blocks, result, [state, result, n, dim, seed] (std::size_t b) {
+		std::call_once(state->built, [&] () {
+			state->coupling = construct_QuantileCoupling(state->marginals, state->monotone_structure);
+		});
+		std::seed_seq seq {
+			static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32),
+			static_cast<std::uint32_t>(b), static_cast<std::uint32_t>(static_cast<std::uint64_t>(b) >> 32)
+		};
+		std::mt19937_64 gen(seq);
+		const std::size_t begin = b * sample_block;
+		const auto draws = state->coupling.sample(gen, std::min(sample_block, n - begin));
+		std::copy(draws.begin(), draws.end(), result->begin() + begin * dim);
+	});
+}
+
+AsyncExecutor& shared_executor()
+{
+	static AsyncExecutor executor;
+	return executor;
+}
+
+// namespace ejd
+}
@@ -0,0 +1,446 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "BinaryFormat.hpp"
+// 3rd party libs
+#include <fmt/format.h>
+// posix
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+// std libs
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace ejd {
+
+static_assert(std::is_trivially_copyable_v<BinaryHeader>);
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Binary Format
+//
+//////////////////////////////////////////////////////////////////////////////
+
+static std::uint64_t align_up(std::uint64_t n) {
+	return (n + binary_section_alignment - 1) / binary_section_alignment * binary_section_alignment;
+}
+
+// The header of a file of these sizes; *overflow (if given) tells whether some section size
+// or offset does not fit in 64 bits, in which case the offsets are meaningless.
+static BinaryHeader binary_layout(
+	std::uint32_t dim,
+	std::uint64_t num_measures,
+	std::uint64_t total_points,
+	std::uint64_t marginal_points,
+	bool * overflow = nullptr)
+{
+	bool overflowed = false;
+	auto mul = [&overflowed] (std::uint64_t a, std::uint64_t b) {
+		std::uint64_t r;
+		overflowed |= __builtin_mul_overflow(a, b, &r);
+		return r;
+	};
+	auto add = [&overflowed] (std::uint64_t a, std::uint64_t b) {
+		std::uint64_t r;
+		overflowed |= __builtin_add_overflow(a, b, &r);
+		return r;
+	};
+
+	BinaryHeader h {};
+	std::memcpy(h.magic, binary_magic, sizeof(binary_magic));
+	h.version = binary_format_version;
+	h.endian_tag = binary_endian_tag;
+	h.dim = dim;
+	h.num_measures = num_measures;
+	h.total_points = total_points;
+	h.marginal_points = marginal_points;
+
+	std::uint64_t pos = align_up(sizeof(BinaryHeader));
+	auto place = [&] (std::uint64_t bytes) {
+		auto offset = pos;
+		pos = add(pos, bytes);
+		if (pos > std::numeric_limits<std::uint64_t>::max() - binary_section_alignment) {
+			overflowed = true;
+		}
+		pos = align_up(pos);
+		return offset;
+	};
+
+	h.marginal_offsets = place(mul(add(dim, 1), sizeof(std::uint64_t)));
+	h.marginal_weights = place(mul(marginal_points, sizeof(double)));
+	h.marginal_support = place(mul(marginal_points, sizeof(double)));
+	h.measure_offsets  = place(mul(add(num_measures, 1), sizeof(std::uint64_t)));
+	h.structures       = place(mul(mul(num_measures, dim), sizeof(std::int32_t)));
+	h.means            = place(mul(mul(num_measures, dim), sizeof(double)));
+	h.variances        = place(mul(mul(num_measures, dim), sizeof(double)));
+	h.weights          = place(mul(total_points, sizeof(double)));
+	h.coords           = place(mul(mul(total_points, dim), sizeof(std::int32_t)));
+	h.file_size = pos;
+
+	if (overflow) {
+		*overflow = overflowed;
+	}
+	return h;
+}
+
+// offsets[0] == 0, never decreasing, offsets[n] == total
+static bool valid_offsets(const std::uint64_t * offsets, std::uint64_t n, std::uint64_t total) {
+	if (offsets[0] != 0 || offsets[n] != total) {
+		return false;
+	}
+	for (std::uint64_t i = 0; i < n; ++i) {
+		if (offsets[i + 1] < offsets[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+namespace {
+
+// buffered, strictly sequential writer that tracks the file position for padding
+class SequentialWriter
+{
+public:
+	explicit SequentialWriter(const std::string& path)
+		: path(path), file(std::fopen(path.c_str(), "wb"))
+	{
+		if (!file) {
+			throw std::runtime_error(fmt::format("ejd::write_binary: cannot open {}: {}", path, std::strerror(errno)));
+		}
+		std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+	}
+
+	~SequentialWriter() {
+		if (file) {
+			std::fclose(file);
+		}
+	}
+
+	void write(const void * src, std::size_t bytes) {
+		if (bytes > 0 && std::fwrite(src, 1, bytes, file) != bytes) {
+			fail();
+		}
+		pos += bytes;
+	}
+
+	template <typename T>
+	void write_value(const T& value) {
+		write(&value, sizeof(T));
+	}
+
+	template <typename T>
+	void write_array(const std::vector<T>& v) {
+		write(v.data(), v.size() * sizeof(T));
+	}
+
+	void seek_to(std::uint64_t offset) {
+		static const char zeros[binary_section_alignment] = {};
+		while (pos < offset) {
+			write(zeros, std::min<std::uint64_t>(offset - pos, sizeof(zeros)));
+		}
+	}
+
+	void close() {
+		if (std::fclose(file) != 0) {
+			file = nullptr;
+			fail();
+		}
+		file = nullptr;
+	}
+
+private:
+	std::string path;
+	std::FILE * file;
+	std::uint64_t pos = 0;
+
+	[[noreturn]] void fail() const {
+		throw std::runtime_error(fmt::format("ejd::write_binary: write to {} failed: {}", path, std::strerror(errno)));
+	}
+};
+
+}	// namespace
+
+void write_binary(const std::string& path, const EmpDistrArray& marginals, const ExtremeMeasures& ems)
+{
+	int dim = marginals.dimensions();
+	if (dim == 0 && !ems.empty()) {
+		dim = ems[0].dimension();
+	}
+
+	std::uint64_t total_points = 0;
+	for (const auto & em : ems) {
+		if (em.size() > 0 && em.dimension() != dim) {
+			throw std::invalid_argument("ejd::write_binary: measures and marginals differ in dimension");
+		}
+		if (static_cast<int>(em.monotone_structure.size()) != dim) {
+			throw std::invalid_argument("ejd::write_binary: monotone structure does not match the dimension");
+		}
+		total_points += em.size();
+	}
+
+	std::uint64_t marginal_points = 0;
+	for (const auto & m : marginals.marginals) {
+		marginal_points += m.weights.size();
+	}
+
+	const BinaryHeader h = binary_layout(dim, ems.size(), total_points, marginal_points);
+
+	SequentialWriter out(path);
+	out.write_value(h);
+
+	// marginals
+	out.seek_to(h.marginal_offsets);
+	std::uint64_t offset = 0;
+	out.write_value(offset);
+	for (const auto & m : marginals.marginals) {
+		offset += m.weights.size();
+		out.write_value(offset);
+	}
+	out.seek_to(h.marginal_weights);
+	for (const auto & m : marginals.marginals) {
+		out.write_array(m.weights);
+	}
+	out.seek_to(h.marginal_support);
+	for (const auto & m : marginals.marginals) {
+		out.write_array(m.support);
+	}
+
+	// measures
+	out.seek_to(h.measure_offsets);
+	offset = 0;
+	out.write_value(offset);
+	for (const auto & em : ems) {
+		offset += em.size();
+		out.write_value(offset);
+	}
+	out.seek_to(h.structures);
+	for (const auto & em : ems) {
+		for (int s : em.monotone_structure) {
+			out.write_value(static_cast<std::int32_t>(s));
+		}
+	}
+
+	// means and variances are optional on an ExtremeMeasure; missing values are stored as NaN
+	auto write_per_coordinate = [&out, dim] (const std::vector<double>& v) {
+		for (int j = 0; j < dim; ++j) {
+			out.write_value(j < static_cast<int>(v.size()) ? v[j] : std::numeric_limits<double>::quiet_NaN());
+		}
+	};
+	out.seek_to(h.means);
+	for (const auto & em : ems) {
+		write_per_coordinate(em.means);
+	}
+	out.seek_to(h.variances);
+	for (const auto & em : ems) {
+		write_per_coordinate(em.variances);
+	}
+
+	out.seek_to(h.weights);
+	for (const auto & em : ems) {
+		out.write_array(em.weights);
+	}
+
+	out.seek_to(h.coords);
+	for (const auto & em : ems) {
+		for (int j = 0; j < dim; ++j) {
+			for (const auto & p : em.support) {
+				out.write_value(static_cast<std::int32_t>(p.point[j]));
+			}
+		}
+	}
+
+	out.seek_to(h.file_size);
+	out.close();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Mapped Extreme Measures
+//
+//////////////////////////////////////////////////////////////////////////////
+
+MappedExtremeMeasures::MappedExtremeMeasures(const std::string& path)
+{
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw std::runtime_error(fmt::format("ejd::MappedExtremeMeasures: cannot open {}: {}", path, std::strerror(errno)));
+	}
+
+	struct stat st;
+	if (::fstat(fd, &st) != 0) {
+		::close(fd);
+		throw std::runtime_error(fmt::format("ejd::MappedExtremeMeasures: cannot stat {}: {}", path, std::strerror(errno)));
+	}
+	length = st.st_size;
+
+	if (length < sizeof(BinaryHeader)) {
+		::close(fd);
+		throw std::runtime_error(fmt::format("ejd::MappedExtremeMeasures: {} is too small to be an EJD file", path));
+	}
+
+	void * addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (addr == MAP_FAILED) {
+		throw std::runtime_error(fmt::format("ejd::MappedExtremeMeasures: cannot map {}: {}", path, std::strerror(errno)));
+	}
+	data = static_cast<const std::byte*>(addr);
+
+	auto invalid = [this, &path] (const char * what) {
+		release();
+		return std::runtime_error(fmt::format("ejd::MappedExtremeMeasures: {}: {}", path, what));
+	};
+
+	const BinaryHeader& h = header();
+	if (std::memcmp(h.magic, binary_magic, sizeof(binary_magic)) != 0) {
+		throw invalid("not an EJD binary file");
+	}
+	if (h.version != binary_format_version) {
+		throw invalid("unsupported format version");
+	}
+	if (h.endian_tag != binary_endian_tag) {
+		throw invalid("file was written with a different byte order");
+	}
+	if (h.file_size != length) {
+		throw invalid("file is truncated");
+	}
+	// every section where the writer puts it for these sizes, so all of them lie in the file
+	bool overflow = false;
+	const BinaryHeader layout = binary_layout(h.dim, h.num_measures, h.total_points, h.marginal_points, &overflow);
+	if (overflow || layout.file_size != h.file_size
+		|| layout.marginal_offsets != h.marginal_offsets || layout.marginal_weights != h.marginal_weights
+		|| layout.marginal_support != h.marginal_support || layout.measure_offsets != h.measure_offsets
+		|| layout.structures != h.structures || layout.means != h.means || layout.variances != h.variances
+		|| layout.weights != h.weights || layout.coords != h.coords) {
+		throw invalid("sections do not match the file size");
+	}
+	if (!valid_offsets(section<std::uint64_t>(h.measure_offsets), h.num_measures, h.total_points)
+		|| !valid_offsets(section<std::uint64_t>(h.marginal_offsets), h.dim, h.marginal_points)) {
+		throw invalid("inconsistent section offsets");
+	}
+}
+
+MappedExtremeMeasures::~MappedExtremeMeasures() {
+	release();
+}
+
+MappedExtremeMeasures::MappedExtremeMeasures(MappedExtremeMeasures&& other) noexcept
+	: data(other.data), length(other.length)
+{
+	other.data = nullptr;
+	other.length = 0;
+}
+
+MappedExtremeMeasures& MappedExtremeMeasures::operator=(MappedExtremeMeasures&& other) noexcept
+{
+	if (this != &other) {
+		release();
+		data = other.data;
+		length = other.length;
+		other.data = nullptr;
+		other.length = 0;
+	}
+	return *this;
+}
+
+void MappedExtremeMeasures::release() noexcept
+{
+	if (data) {
+		::munmap(const_cast<std::byte*>(data), length);
+		data = nullptr;
+		length = 0;
+	}
+}
+
+const BinaryHeader& MappedExtremeMeasures::header() const noexcept {
+	return *reinterpret_cast<const BinaryHeader*>(data);
+}
+
+int MappedExtremeMeasures::dimension() const noexcept {
+	return header().dim;
+}
+
+std::size_t MappedExtremeMeasures::size() const noexcept {
+	return header().num_measures;
+}
+
+std::size_t MappedExtremeMeasures::total_points() const noexcept {
+	return header().total_points;
+}
+
+ExtremeMeasureView MappedExtremeMeasures::operator[](std::size_t i) const
+{
+	const BinaryHeader& h = header();
+	assert(i < h.num_measures);
+	const auto * offsets = section<std::uint64_t>(h.measure_offsets);
+	const std::size_t begin = offsets[i];
+	const int dim = h.dim;
+
+	ExtremeMeasureView view;
+	view.dim = dim;
+	view.size = offsets[i+1] - begin;
+	view.monotone_structure = section<std::int32_t>(h.structures) + i * dim;
+	view.means = section<double>(h.means) + i * dim;
+	view.variances = section<double>(h.variances) + i * dim;
+	view.weights = section<double>(h.weights) + begin;
+	view.coords = section<std::int32_t>(h.coords) + begin * dim;
+	return view;
+}
+
+EmpDistrArray MappedExtremeMeasures::marginals() const
+{
+	const BinaryHeader& h = header();
+	const auto * offsets = section<std::uint64_t>(h.marginal_offsets);
+	const auto * weights = section<double>(h.marginal_weights);
+	const auto * support = section<double>(h.marginal_support);
+
+	std::vector<EmpiricalDistribution> marginals;
+	marginals.reserve(h.dim);
+	for (std::uint32_t j = 0; j < h.dim && offsets[h.dim] > 0; ++j) {
+		marginals.emplace_back(EmpiricalDistribution {
+			.weights = std::vector<double>(weights + offsets[j], weights + offsets[j+1]),
+			.support = std::vector<double>(support + offsets[j], support + offsets[j+1])
+		});
+	}
+	return EmpDistrArray(marginals);
+}
+
+ExtremeMeasures MappedExtremeMeasures::to_ExtremeMeasures() const
+{
+	ExtremeMeasures ems;
+	ems.reserve(size());
+	for (std::size_t i = 0; i < size(); ++i) {
+		ems.emplace_back((*this)[i].to_ExtremeMeasure());
+	}
+	return ems;
+}
+
+// namespace ejd
+}
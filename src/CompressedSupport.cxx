@@ -0,0 +1,282 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "CompressedSupport.hpp"
+// std libs
+#include <algorithm>
+#include <cassert>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Compressed Support
+//
+//////////////////////////////////////////////////////////////////////////////
+
+static int step_direction(const std::vector<int>& monotone_structure, int j) {
+	// an empty structure is treated as all coordinates increasing
+	return monotone_structure.empty() ? 1 : monotone_structure[j];
+}
+
+static void apply_step(const CompressedSupport& cs, std::size_t i, int * point) {
+	const std::uint8_t * mask = cs.steps.data() + i * cs.bytes_per_step();
+	for (int j = 0; j < cs.dim; ++j) {
+		if (mask[j >> 3] & (1u << (j & 7))) {
+			point[j] += step_direction(cs.monotone_structure, j);
+		}
+	}
+}
+
+int CompressedSupport::dimension() const noexcept {
+	return dim;
+}
+
+std::size_t CompressedSupport::size() const noexcept {
+	return length;
+}
+
+std::size_t CompressedSupport::bytes_per_step() const noexcept {
+	return (dim + 7) / 8;
+}
+
+std::size_t CompressedSupport::memory_bytes() const noexcept {
+	return sizeof(CompressedSupport)
+		+ monotone_structure.capacity() * sizeof(int)
+		+ steps.capacity() * sizeof(std::uint8_t)
+		+ checkpoint_index.capacity() * sizeof(std::size_t)
+		+ checkpoints.capacity() * sizeof(int);
+}
+
+void CompressedSupport::decode(std::size_t i, int * out) const
+{
+	assert(i < length);
+
+	// last checkpoint at or before i
+	auto cp = std::upper_bound(checkpoint_index.begin(), checkpoint_index.end(), i) - 1;
+	auto cp_pos = std::distance(checkpoint_index.begin(), cp);
+
+	std::copy_n(checkpoints.begin() + cp_pos * dim, dim, out);
+	for (std::size_t k = *cp + 1; k <= i; ++k) {
+		apply_step(*this, k, out);
+	}
+}
+
+LatticePoint CompressedSupport::operator[](std::size_t i) const
+{
+	std::vector<int> point(dim);
+	decode(i, point.data());
+	return LatticePoint(point);
+}
+
+std::vector<LatticePoint> CompressedSupport::decompress() const
+{
+	std::vector<LatticePoint> support;
+	support.reserve(length);
+	for (const auto & point : *this) {
+		support.emplace_back(LatticePoint(point));
+	}
+	return support;
+}
+
+CompressedSupport::const_iterator CompressedSupport::begin() const {
+	return const_iterator(this, 0);
+}
+
+CompressedSupport::const_iterator CompressedSupport::end() const {
+	return const_iterator(this, length);
+}
+
+CompressedSupport::const_iterator::const_iterator(const CompressedSupport * cs, std::size_t index)
+	: cs(cs), index(index), point(cs->dim)
+{
+	if (index < cs->length) {
+		auto cp = std::upper_bound(cs->checkpoint_index.begin(), cs->checkpoint_index.end(), index);
+		next_checkpoint = std::distance(cs->checkpoint_index.begin(), cp);
+		cs->decode(index, point.data());
+	}
+}
+
+void CompressedSupport::const_iterator::load_checkpoint()
+{
+	std::copy_n(cs->checkpoints.begin() + next_checkpoint * cs->dim, cs->dim, point.begin());
+	++next_checkpoint;
+}
+
+CompressedSupport::const_iterator& CompressedSupport::const_iterator::operator++()
+{
+	++index;
+	if (index >= cs->length) {
+		return *this;
+	}
+	if (next_checkpoint < cs->checkpoint_index.size() && cs->checkpoint_index[next_checkpoint] == index) {
+		load_checkpoint();
+	}
+	else {
+		apply_step(*cs, index, point.data());
+	}
+	return *this;
+}
+
+CompressedSupport::const_iterator CompressedSupport::const_iterator::operator++(int)
+{
+	auto old = *this;
+	++(*this);
+	return old;
+}
+
+CompressedSupport compress_support(
+	const std::vector<LatticePoint>& support,
+	const std::vector<int>& monotone_structure,
+	int checkpoint_interval)
+{
+	assert(checkpoint_interval > 0);
+
+	CompressedSupport cs;
+	cs.length = support.size();
+	cs.checkpoint_interval = checkpoint_interval;
+	cs.monotone_structure = monotone_structure;
+
+	if (support.empty()) {
+		return cs;
+	}
+
+	cs.dim = support[0].dimension();
+	const auto bytes_per_step = cs.bytes_per_step();
+	cs.steps.assign(cs.length * bytes_per_step, 0);
+	cs.checkpoint_index.reserve(cs.length / checkpoint_interval + 1);
+	cs.checkpoints.reserve((cs.length / checkpoint_interval + 1) * cs.dim);
+
+	auto add_checkpoint = [&cs] (std::size_t i, const std::vector<int>& point) {
+		cs.checkpoint_index.push_back(i);
+		cs.checkpoints.insert(cs.checkpoints.end(), point.begin(), point.end());
+	};
+
+	add_checkpoint(0, support[0].point);
+	std::size_t last_checkpoint = 0;
+
+	for (std::size_t i = 1; i < cs.length; ++i)
+	{
+		const auto & prev = support[i-1].point;
+		const auto & curr = support[i].point;
+		assert(curr.size() == prev.size());
+
+		if (i - last_checkpoint >= static_cast<std::size_t>(checkpoint_interval)) {
+			add_checkpoint(i, curr);
+			last_checkpoint = i;
+			continue;
+		}
+
+		std::uint8_t * mask = cs.steps.data() + i * bytes_per_step;
+		bool encodable = true;
+
+		for (int j = 0; j < cs.dim; ++j) {
+			const int delta = curr[j] - prev[j];
+			if (delta == 0) {
+				continue;
+			}
+			if (delta != step_direction(monotone_structure, j)) {
+				encodable = false;
+				break;
+			}
+			mask[j >> 3] |= static_cast<std::uint8_t>(1u << (j & 7));
+		}
+
+		if (!encodable) {
+			// resync on the full point; the mask of a checkpoint is never read
+			std::fill_n(mask, bytes_per_step, 0);
+			add_checkpoint(i, curr);
+			last_checkpoint = i;
+		}
+	}
+
+	cs.checkpoint_index.shrink_to_fit();
+	cs.checkpoints.shrink_to_fit();
+	return cs;
+}
+
+std::size_t uncompressed_support_bytes(const std::vector<LatticePoint>& support)
+{
+	std::size_t bytes = sizeof(std::vector<LatticePoint>) + support.capacity() * sizeof(LatticePoint);
+	for (const auto & p : support) {
+		bytes += p.point.capacity() * sizeof(int);
+	}
+	return bytes;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Compressed Extreme Measure
+//
+//////////////////////////////////////////////////////////////////////////////
+
+int CompressedExtremeMeasure::dimension() const noexcept {
+	return support.dimension();
+}
+
+int CompressedExtremeMeasure::size() const noexcept {
+	return support.size();
+}
+
+std::size_t CompressedExtremeMeasure::memory_bytes() const noexcept {
+	return support.memory_bytes()
+		+ weights.capacity() * sizeof(double)
+		+ monotone_structure.capacity() * sizeof(int)
+		+ means.capacity() * sizeof(double)
+		+ variances.capacity() * sizeof(double);
+}
+
+ExtremeMeasure CompressedExtremeMeasure::decompress() const
+{
+	ExtremeMeasure em;
+	em.support = support.decompress();
+	em.weights = weights;
+	em.monotone_structure = monotone_structure;
+	em.means = means;
+	em.variances = variances;
+	return em;
+}
+
+CompressedExtremeMeasure compress(const ExtremeMeasure& em, int checkpoint_interval)
+{
+	return CompressedExtremeMeasure {
+		.support = compress_support(em.support, em.monotone_structure, checkpoint_interval),
+		.weights = em.weights,
+		.monotone_structure = em.monotone_structure,
+		.means = em.means,
+		.variances = em.variances
+	};
+}
+
+CompressedExtremeMeasures compress(const ExtremeMeasures& ems, int checkpoint_interval)
+{
+	CompressedExtremeMeasures cems;
+	cems.reserve(ems.size());
+	for (const auto & em : ems) {
+		cems.emplace_back(compress(em, checkpoint_interval));
+	}
+	return cems;
+}
+
+// namespace ejd
+}
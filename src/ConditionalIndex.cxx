@@ -0,0 +1,296 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ConditionalIndex.hpp"
+// std libs
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+
+namespace ejd {
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Measure Accessors
+//
+//////////////////////////////////////////////////////////////////////////////
+
+int dim_of(const ExtremeMeasure& em) {
+	return em.support.empty() ? static_cast<int>(em.monotone_structure.size()) : em.dimension();
+}
+std::size_t size_of(const ExtremeMeasure& em) { return em.support.size(); }
+double weight_of(const ExtremeMeasure& em, std::size_t i) { return em.weights[i]; }
+int coord_of(const ExtremeMeasure& em, std::size_t i, int j) { return em.support[i].point[j]; }
+int structure_of(const ExtremeMeasure& em, int j) {
+	return em.monotone_structure.empty() ? 1 : em.monotone_structure[j];
+}
+
+int dim_of(const ExtremeMeasureView& em) { return em.dim; }
+std::size_t size_of(const ExtremeMeasureView& em) { return em.size; }
+double weight_of(const ExtremeMeasureView& em, std::size_t i) { return em.weights[i]; }
+int coord_of(const ExtremeMeasureView& em, std::size_t i, int j) { return em.coord(i,j); }
+int structure_of(const ExtremeMeasureView& em, int j) {
+	return em.monotone_structure ? em.monotone_structure[j] : 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Run Queries
+//
+//////////////////////////////////////////////////////////////////////////////
+
+constexpr double no_mass = std::numeric_limits<double>::quiet_NaN();
+
+// calls f with the comparator that orders values the way coordinate c runs along the chain
+template <typename F>
+decltype(auto) with_chain_order(const ConditionalIndex::Coordinate& c, F&& f) {
+	if (c.descending) {
+		return f(std::greater<int>());
+	}
+	return f(std::less<int>());
+}
+
+// weight of the points [a, b) of run r of coordinate c
+double sub_run_mass(const ConditionalIndex::Coordinate& c, std::size_t r, std::size_t a, std::size_t b) {
+	const double upto_b = b == c.begin[r + 1] ? c.mass[r] : c.cumulative[b];
+	const double upto_a = a == c.begin[r + 1] ? c.mass[r] : c.cumulative[a];
+	return upto_b - upto_a;
+}
+
+double run_pmf(const ConditionalIndex& ci, int j, int k, int i, std::size_t r) {
+	if (r == ConditionalIndex::npos) {
+		return no_mass;
+	}
+	const auto & c = ci.coordinates[i];
+	const int * column = ci.coords.data() + j * ci.length;
+	const int * lo = column + c.begin[r];
+	const int * hi = column + c.begin[r + 1];
+	auto [first, last] = with_chain_order(ci.coordinates[j], [&] (auto order) {
+		return std::equal_range(lo, hi, k, order);
+	});
+	return sub_run_mass(c, r, first - column, last - column) / c.mass[r];
+}
+
+double run_cdf(const ConditionalIndex& ci, int j, int k, int i, std::size_t r) {
+	if (r == ConditionalIndex::npos) {
+		return no_mass;
+	}
+	const auto & c = ci.coordinates[i];
+	const int * column = ci.coords.data() + j * ci.length;
+	const int * lo = column + c.begin[r];
+	const int * hi = column + c.begin[r + 1];
+	// X_j <= k is a prefix of the run if X_j increases along the chain, a suffix otherwise
+	if (ci.coordinates[j].descending) {
+		const int * first = std::lower_bound(lo, hi, k, std::greater<int>());
+		return sub_run_mass(c, r, first - column, hi - column) / c.mass[r];
+	}
+	const int * last = std::upper_bound(lo, hi, k);
+	return sub_run_mass(c, r, lo - column, last - column) / c.mass[r];
+}
+
+double run_expectation(const ConditionalIndex& ci, int j, int i, std::size_t r) {
+	if (r == ConditionalIndex::npos) {
+		return no_mass;
+	}
+	return ci.coordinates[i].means[r * ci.dim + j];
+}
+
+template <typename Measure>
+ConditionalIndex build_index(const Measure& em)
+{
+	ConditionalIndex ci;
+	ci.dim = dim_of(em);
+	ci.length = size_of(em);
+
+	ci.coords.resize(ci.dim * ci.length);
+	for (std::size_t p = 0; p < ci.length; ++p) {
+		for (int j = 0; j < ci.dim; ++j) {
+			ci.coords[j * ci.length + p] = coord_of(em, p, j);
+		}
+	}
+
+	std::vector<double> moments(ci.dim);
+	ci.coordinates.resize(ci.dim);
+	for (int i = 0; i < ci.dim; ++i) {
+		auto & c = ci.coordinates[i];
+		c.descending = structure_of(em, i) == -1;
+		c.cumulative.resize(ci.length);
+
+		const int * column = ci.coords.data() + i * ci.length;
+		double run_mass = 0;
+		auto close_run = [&] () {
+			c.mass.push_back(run_mass);
+			for (auto moment : moments) {
+				c.means.push_back(moment / run_mass);
+			}
+		};
+
+		for (std::size_t p = 0; p < ci.length; ++p) {
+			if (p == 0 || column[p] != column[p - 1]) {
+				if (p > 0) {
+					if ((column[p] < column[p - 1]) != c.descending) {
+						throw std::invalid_argument("ejd: index_conditionals: support is not a monotone chain");
+					}
+					close_run();
+				}
+				c.values.push_back(column[p]);
+				c.begin.push_back(p);
+				run_mass = 0;
+				std::fill(moments.begin(), moments.end(), 0.0);
+			}
+			const double w = weight_of(em, p);
+			c.cumulative[p] = run_mass;
+			run_mass += w;
+			for (int j = 0; j < ci.dim; ++j) {
+				moments[j] += w * ci.coords[j * ci.length + p];
+			}
+		}
+		if (ci.length > 0) {
+			close_run();
+		}
+		c.begin.push_back(ci.length);
+	}
+	return ci;
+}
+
+}	// namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Conditional Index
+//
+//////////////////////////////////////////////////////////////////////////////
+
+int ConditionalIndex::dimension() const noexcept {
+	return dim;
+}
+
+std::size_t ConditionalIndex::size() const noexcept {
+	return length;
+}
+
+std::size_t ConditionalIndex::memory_bytes() const noexcept {
+	std::size_t bytes = sizeof(ConditionalIndex) + coords.capacity() * sizeof(int);
+	for (const auto & c : coordinates) {
+		bytes += sizeof(Coordinate)
+			+ c.values.capacity() * sizeof(int)
+			+ c.begin.capacity() * sizeof(std::size_t)
+			+ (c.mass.capacity() + c.means.capacity() + c.cumulative.capacity()) * sizeof(double);
+	}
+	return bytes;
+}
+
+std::size_t ConditionalIndex::find_run(int i, int m) const
+{
+	const auto & values = coordinates[i].values;
+	auto it = with_chain_order(coordinates[i], [&] (auto order) {
+		return std::lower_bound(values.begin(), values.end(), m, order);
+	});
+	return it != values.end() && *it == m ? static_cast<std::size_t>(it - values.begin()) : npos;
+}
+
+std::vector<std::size_t> ConditionalIndex::find_runs(int i, const std::vector<int>& ms) const
+{
+	const auto & values = coordinates[i].values;
+	std::vector<std::size_t> order(ms.size());
+	std::iota(order.begin(), order.end(), 0);
+
+	std::vector<std::size_t> runs(ms.size(), npos);
+	with_chain_order(coordinates[i], [&] (auto chain_order) {
+		std::sort(order.begin(), order.end(), [&] (std::size_t a, std::size_t b) {
+			return chain_order(ms[a], ms[b]);
+		});
+		std::size_t r = 0;
+		for (auto q : order) {
+			while (r < values.size() && chain_order(values[r], ms[q])) {
+				++r;
+			}
+			if (r < values.size() && values[r] == ms[q]) {
+				runs[q] = r;
+			}
+		}
+	});
+	return runs;
+}
+
+double ConditionalIndex::probability(int i, int m) const {
+	const std::size_t r = find_run(i, m);
+	return r == npos ? 0.0 : coordinates[i].mass[r];
+}
+
+double ConditionalIndex::conditional_pmf(int j, int k, int i, int m) const {
+	return run_pmf(*this, j, k, i, find_run(i, m));
+}
+
+double ConditionalIndex::conditional_cdf(int j, int k, int i, int m) const {
+	return run_cdf(*this, j, k, i, find_run(i, m));
+}
+
+double ConditionalIndex::conditional_expectation(int j, int i, int m) const {
+	return run_expectation(*this, j, i, find_run(i, m));
+}
+
+std::vector<double> ConditionalIndex::conditional_pmf(int j, int k, int i, const std::vector<int>& ms) const
+{
+	const auto runs = find_runs(i, ms);
+	std::vector<double> result(runs.size());
+	for (std::size_t q = 0; q < runs.size(); ++q) {
+		result[q] = run_pmf(*this, j, k, i, runs[q]);
+	}
+	return result;
+}
+
+std::vector<double> ConditionalIndex::conditional_cdf(int j, int k, int i, const std::vector<int>& ms) const
+{
+	const auto runs = find_runs(i, ms);
+	std::vector<double> result(runs.size());
+	for (std::size_t q = 0; q < runs.size(); ++q) {
+		result[q] = run_cdf(*this, j, k, i, runs[q]);
+	}
+	return result;
+}
+
+std::vector<double> ConditionalIndex::conditional_expectation(int j, int i, const std::vector<int>& ms) const
+{
+	const auto runs = find_runs(i, ms);
+	std::vector<double> result(runs.size());
+	for (std::size_t q = 0; q < runs.size(); ++q) {
+		result[q] = run_expectation(*this, j, i, runs[q]);
+	}
+	return result;
+}
+
+ConditionalIndex index_conditionals(const ExtremeMeasure& em) {
+	return build_index(em);
+}
+
+ConditionalIndex index_conditionals(const ExtremeMeasureView& em) {
+	return build_index(em);
+}
+
+// namespace ejd
+}
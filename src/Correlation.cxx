@@ -22,29 +22,37 @@
 */
 
 #include "Correlation.hpp"
+#include "EJDEngine.hpp"
 #include "EmpiricalDistribution.hpp"
 #include "ExtremeMeasures.hpp"
+#include "Kernels.hpp"
 // 3rd party lib
 #include "Discreture/Combinations.hpp"
 // std lib
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 namespace ejd {
 
 namespace detail  {
 
-double bivariate_expectation(std::vector<LatticePoint> support, std::vector<double> weights)
+double bivariate_expectation(const std::vector<LatticePoint>& support, const std::vector<double>& weights)
 {
     // note : for now, ensure marginals are unidimensional
     assert(support[0].dimension() == 2);
-    double bivarexp = 0.;
-    for (int i = 0; i < support.size(); ++i) {
-        bivarexp += support[i].product() * weights[i];
+    // the kernels read the coordinates column-wise
+    std::vector<int> x(support.size());
+    std::vector<int> y(support.size());
+    for (std::size_t i = 0; i < support.size(); ++i) {
+        x[i] = support[i].point[0];
+        y[i] = support[i].point[1];
     }
-    return bivarexp;
+    return kernels::bivariate_expectation(x.data(), y.data(), weights.data(), support.size());
 }
 
-double correlation(std::vector<LatticePoint> support, std::vector<double> weights, std::vector<double> means, std::vector<double> variances)
+double correlation(const std::vector<LatticePoint>& support, const std::vector<double>& weights,
+    const std::vector<double>& means, const std::vector<double>& variances)
 {
     assert(support[0].dimension() == 2);
 
@@ -60,6 +68,13 @@ double correlation(const ExtremeMeasure& em)
     return detail::correlation(em.support, em.weights, em.means, em.variances);
 }
 
+double correlation(const ExtremeMeasureView& em)
+{
+    assert(em.dim == 2);
+    const double bivarexp = kernels::bivariate_expectation(em.column(0), em.column(1), em.weights, em.size);
+    return ( bivarexp - em.means[0] * em.means[1] ) / std::sqrt( em.variances[0] * em.variances[1] );
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //
 // Extreme Measure
@@ -88,6 +103,42 @@ std::vector<double> correlations(const ExtremeMeasure & em)
 //
 //////////////////////////////////////////////////////////////////////////////
 
+namespace {
+
+// mean and variance of a marginal on the support [0, n)
+template <typename Scalar>
+std::pair<Scalar,Scalar> moments(const std::vector<Scalar>& weights)
+{
+    Scalar mean = 0;
+    Scalar second_moment = 0;
+    for (std::size_t k = 0; k < weights.size(); ++k) {
+        mean += weights[k] * double(k);
+        second_moment += weights[k] * double(k * k);
+    }
+    return {mean, second_moment - mean * mean};
+}
+
+// E[XY] under the extreme measure of the monotone structure, the supports [0, n) flipped by it
+template <typename Scalar>
+Scalar bivariate_expectation(const std::vector<std::vector<Scalar>>& weights, const std::vector<int>& monotone_structure)
+{
+    const auto joint = basic_joint_cdf<Scalar>(weights, monotone_structure);
+    auto coordinate = [&] (std::size_t i, int j) {
+        const int atom = joint.indices[i * 2 + j];
+        return monotone_structure[j] == -1 ? double(weights[j].size() - 1 - atom) : double(atom);
+    };
+
+    std::vector<Scalar> weights_of_support;
+    breakpoint_weights(joint.breakpoints, joint.errors, &weights_of_support);
+    Scalar bivarexp = 0;
+    for (std::size_t i = 0; i < weights_of_support.size(); ++i) {
+        bivarexp += weights_of_support[i] * (coordinate(i, 0) * coordinate(i, 1));
+    }
+    return bivarexp;
+}
+
+}   // namespace
+
 // TODO finish
 std::pair<double,double> poiss_correlation_bounds_2d(const double intensity1, const double intensity2) 
 {
@@ -99,5 +150,33 @@ std::pair<double,double> poiss_correlation_bounds_2d(const double intensity1, co
     return std::make_pair(max_corr, min_corr);
 }
 
+template <typename Scalar>
+std::pair<Scalar,Scalar> basic_poiss_correlation_bounds_2d(const Scalar& intensity1, const Scalar& intensity2)
+{
+    using std::sqrt;
+    // the common support of construct_Poisson_EmpDistrArray
+    const int support_end = std::max(
+        recurrence_upper_bounds(bm::poisson(value_of(intensity1))),
+        recurrence_upper_bounds(bm::poisson(value_of(intensity2))));
+    const std::vector<std::vector<Scalar>> weights {
+        basic_poisson_pmf(intensity1, support_end),
+        basic_poisson_pmf(intensity2, support_end)
+    };
+
+    const auto [mean1, variance1] = moments(weights[0]);
+    const auto [mean2, variance2] = moments(weights[1]);
+    const Scalar scale = sqrt(variance1 * variance2);
+
+    const MonotonicityStructure ms(2);
+    const Scalar max_corr = (bivariate_expectation(weights, ms[0]) - mean1 * mean2) / scale;
+    const Scalar min_corr = (bivariate_expectation(weights, ms[1]) - mean1 * mean2) / scale;
+
+    return std::make_pair(max_corr, min_corr);
+}
+
+template std::pair<double,double> basic_poiss_correlation_bounds_2d<double>(const double&, const double&);
+template std::pair<Dual<1>,Dual<1>> basic_poiss_correlation_bounds_2d<Dual<1>>(const Dual<1>&, const Dual<1>&);
+template std::pair<Dual<2>,Dual<2>> basic_poiss_correlation_bounds_2d<Dual<2>>(const Dual<2>&, const Dual<2>&);
+
 // namespace ejd
 }
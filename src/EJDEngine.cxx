@@ -0,0 +1,561 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "EJDEngine.hpp"
+#include "EmpiricalDistribution.hpp"
+#include "Utils/Parallel.hpp"
+// std libs
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <utility>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// EJD Engine
+//
+//////////////////////////////////////////////////////////////////////////////
+
+template <typename Scalar>
+ExtremeMeasure BasicExtremeMeasure<Scalar>::to_ExtremeMeasure() const
+{
+	ExtremeMeasure em;
+	em.support = support;
+	em.weights.assign(weights.begin(), weights.end());
+	em.monotone_structure = monotone_structure;
+	return em;
+}
+
+namespace {
+
+// joint cdf of the values [begin[j], end[j]) of every marginal cdf
+template <typename Scalar>
+struct MergedChunk
+{
+	BasicJointCDF<Scalar> joint;
+	std::size_t folded = 0;
+	bool tail = false;
+};
+
+// cdf values merged between two polls of the cancellation token
+constexpr std::size_t values_per_poll = 1 << 14;
+
+// the merge for any totally ordered Scalar whose cdfs end at one; with tol = 0 it only folds
+// equal values, which is exact for the fixed-point cdfs
+template <typename Scalar>
+MergedChunk<Scalar> merge_chunk(const std::vector<std::vector<Scalar>>& marginal_cdfs,
+	const std::vector<std::vector<Scalar>>& errors, const Scalar tol, const Scalar one,
+	const std::vector<std::size_t>& begin, const std::vector<std::size_t>& end,
+	const CancellationToken * cancellation = nullptr)
+{
+	const int dim = marginal_cdfs.size();
+	auto error_of = [&errors] (int j, std::size_t i) -> Scalar {
+		return errors.empty() || errors[j].empty() ? Scalar(0) : errors[j][i];
+	};
+
+	// k-way merge over the heads of the marginal cdfs, ties broken by marginal
+	using Head = std::pair<Scalar,int>;
+	std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+	std::vector<std::size_t> position = begin;
+	std::size_t total = 0;
+	for (int j = 0; j < dim; ++j) {
+		total += end[j] - begin[j];
+		if (begin[j] < end[j]) {
+			heads.emplace(marginal_cdfs[j][begin[j]], j);
+		}
+	}
+
+	MergedChunk<Scalar> chunk;
+	auto & joint = chunk.joint;
+	// room for the breakpoint at one that may be appended after the merge
+	joint.breakpoints.reserve(total + 1);
+	joint.errors.reserve(total + 1);
+	joint.indices.reserve((total + 1) * dim);
+
+	// atoms of each marginal fully allocated so far; the support index of marginal j at a
+	// breakpoint is the number of its cdf values strictly below it
+	std::vector<std::size_t> consumed = begin;
+
+	// values within tol of 0 would only produce zero-weight points
+	Scalar anchor = 0;
+	bool open_run = false;
+
+	std::size_t until_poll = values_per_poll;
+	while (!heads.empty())
+	{
+		if (cancellation && --until_poll == 0) {
+			cancellation->throw_if_stopped();
+			until_poll = values_per_poll;
+		}
+		auto [value, j] = heads.top();
+		heads.pop();
+
+		if (!chunk.tail && value > anchor + tol) {
+			// start a new breakpoint
+			anchor = value;
+			open_run = true;
+			chunk.tail = value >= one - tol;
+			joint.breakpoints.push_back(value);
+			joint.errors.push_back(error_of(j, position[j]));
+			for (int k = 0; k < dim; ++k) {
+				// a marginal that is already exhausted (total mass below 1) stays on its last atom
+				joint.indices.push_back(std::min<int>(consumed[k], marginal_cdfs[k].size() - 1));
+			}
+		}
+		else {
+			++chunk.folded;
+			if (open_run && value >= joint.breakpoints.back()) {
+				joint.breakpoints.back() = value;
+				joint.errors.back() = error_of(j, position[j]);
+			}
+		}
+
+		++consumed[j];
+		if (++position[j] < end[j]) {
+			heads.emplace(marginal_cdfs[j][position[j]], j);
+		}
+	}
+	return chunk;
+}
+
+// lower_bound of x in every marginal cdf
+template <typename Scalar>
+std::vector<std::size_t> co_rank(const std::vector<std::vector<Scalar>>& marginal_cdfs, Scalar x)
+{
+	std::vector<std::size_t> positions(marginal_cdfs.size());
+	for (std::size_t j = 0; j < marginal_cdfs.size(); ++j) {
+		const auto & cdf = marginal_cdfs[j];
+		positions[j] = std::lower_bound(cdf.begin(), cdf.end(), x) - cdf.begin();
+	}
+	return positions;
+}
+
+// largest cdf value with at most r values strictly below it, i.e. the value at rank r of the
+// merged sequence; a binary search per marginal over the number of values below its entries
+template <typename Scalar>
+Scalar value_at_rank(const std::vector<std::vector<Scalar>>& marginal_cdfs, std::size_t r)
+{
+	auto rank_of = [&marginal_cdfs] (Scalar x) {
+		const auto positions = co_rank(marginal_cdfs, x);
+		return std::accumulate(positions.begin(), positions.end(), std::size_t(0));
+	};
+	Scalar value = 0;
+	for (const auto & cdf : marginal_cdfs) {
+		std::size_t lo = 0;
+		std::size_t hi = cdf.size();
+		while (lo < hi) {
+			const std::size_t mid = lo + (hi - lo) / 2;
+			if (rank_of(cdf[mid]) <= r) {
+				lo = mid + 1;
+			} else {
+				hi = mid;
+			}
+		}
+		if (lo > 0) {
+			value = std::max(value, cdf[lo - 1]);
+		}
+	}
+	return value;
+}
+
+// First value at or after x that is more than tol above the value merged before it, so that it
+// starts a new breakpoint whatever run came before; returns the positions it splits the cdfs
+// at, or nothing if there is no such value below the tail within max_steps values.
+template <typename Scalar>
+std::vector<std::size_t> split_at_gap(const std::vector<std::vector<Scalar>>& marginal_cdfs,
+	Scalar x, const Scalar tol, const Scalar one, std::size_t max_steps)
+{
+	const int dim = marginal_cdfs.size();
+	auto positions = co_rank(marginal_cdfs, x);
+
+	Scalar previous = 0;
+	for (int j = 0; j < dim; ++j) {
+		if (positions[j] > 0) {
+			previous = std::max(previous, marginal_cdfs[j][positions[j] - 1]);
+		}
+	}
+	for (std::size_t step = 0; step < max_steps; ++step) {
+		int next = -1;
+		for (int j = 0; j < dim; ++j) {
+			if (positions[j] < marginal_cdfs[j].size()
+				&& (next < 0 || marginal_cdfs[j][positions[j]] < marginal_cdfs[next][positions[next]])) {
+				next = j;
+			}
+		}
+		if (next < 0) {
+			break;
+		}
+		const Scalar value = marginal_cdfs[next][positions[next]];
+		if (value >= one - tol) {
+			break;
+		}
+		if (value > previous + tol && value > tol) {
+			return positions;
+		}
+		previous = value;
+		++positions[next];
+	}
+	return {};
+}
+
+// below this many cdf values the merge is not split up
+constexpr std::size_t min_values_per_chunk = 1 << 15;
+
+// Merges the cdfs on up to `threads` threads. The merged sequence is cut at about equal ranks
+// (co-ranked by value in every marginal), each cut moved up to the next gap wider than tol, so
+// that every chunk starts a breakpoint of its own and the chunks are merged independently
+// into exactly what the sequential merge gives.
+template <typename Scalar>
+BasicJointCDF<Scalar> merge_cdfs(const std::vector<std::vector<Scalar>>& marginal_cdfs,
+	const std::vector<std::vector<Scalar>>& errors, const Scalar tol, const Scalar one, EJDStats * stats,
+	unsigned threads = 1, const CancellationToken * cancellation = nullptr)
+{
+	const int dim = marginal_cdfs.size();
+	std::size_t total = 0;
+	for (const auto & cdf : marginal_cdfs) {
+		total += cdf.size();
+	}
+
+	// cut positions of every chunk, from all zeros to the ends of the cdfs
+	std::vector<std::vector<std::size_t>> cuts {std::vector<std::size_t>(dim, 0)};
+	const std::size_t chunks = std::min<std::size_t>(resolve_threads(threads),
+		std::max<std::size_t>(total / min_values_per_chunk, 1));
+	for (std::size_t c = 1; c < chunks; ++c) {
+		const Scalar x = value_at_rank(marginal_cdfs, total * c / chunks);
+		auto cut = split_at_gap(marginal_cdfs, x, tol, one, total / chunks);
+		if (!cut.empty() && std::accumulate(cut.begin(), cut.end(), std::size_t(0))
+			> std::accumulate(cuts.back().begin(), cuts.back().end(), std::size_t(0))) {
+			cuts.push_back(std::move(cut));
+		}
+	}
+	std::vector<std::size_t> ends(dim);
+	for (int j = 0; j < dim; ++j) {
+		ends[j] = marginal_cdfs[j].size();
+	}
+	cuts.push_back(ends);
+
+	const std::size_t n = cuts.size() - 1;
+	std::vector<MergedChunk<Scalar>> merged(n);
+	parallel_invoke(n, [&] (unsigned c) {
+		merged[c] = merge_chunk(marginal_cdfs, errors, tol, one, cuts[c], cuts[c + 1], cancellation);
+	});
+
+	// concatenate; only the last chunk can reach the tail
+	BasicJointCDF<Scalar> joint;
+	if (n == 1) {
+		joint = std::move(merged[0].joint);
+	}
+	else {
+		std::vector<std::size_t> offset(n + 1, 0);
+		for (std::size_t c = 0; c < n; ++c) {
+			offset[c + 1] = offset[c] + merged[c].joint.breakpoints.size();
+		}
+		joint.breakpoints.resize(offset[n]);
+		joint.errors.resize(offset[n]);
+		joint.indices.resize(offset[n] * dim);
+		parallel_invoke(n, [&] (unsigned c) {
+			const auto & chunk = merged[c].joint;
+			std::copy(chunk.breakpoints.begin(), chunk.breakpoints.end(), joint.breakpoints.begin() + offset[c]);
+			std::copy(chunk.errors.begin(), chunk.errors.end(), joint.errors.begin() + offset[c]);
+			std::copy(chunk.indices.begin(), chunk.indices.end(), joint.indices.begin() + offset[c] * dim);
+		});
+	}
+
+	if (merged.back().tail) {
+		joint.breakpoints.back() = one;
+		joint.errors.back() = 0;
+	}
+	else {
+		// marginals that do not reach 1: the remaining mass goes to their last atoms
+		joint.breakpoints.push_back(one);
+		joint.errors.push_back(0);
+		for (int j = 0; j < dim; ++j) {
+			joint.indices.push_back(std::max<int>(marginal_cdfs[j].size() - 1, 0));
+		}
+	}
+
+	if (stats) {
+		stats->breakpoints = total;
+		stats->folded = 0;
+		for (const auto & chunk : merged) {
+			stats->folded += chunk.folded;
+		}
+	}
+	return joint;
+}
+
+// the atom of each marginal at every breakpoint, filled in blocks on up to `threads` threads
+std::vector<LatticePoint> joint_support(const EmpDistrArray& empdistrarrs, const std::vector<int>& monotone_structs,
+	const std::vector<int>& indices, std::size_t support_length, unsigned threads = 1)
+{
+	const int dim = empdistrarrs.dimensions();
+	auto marginal_supports = flip_supports(empdistrarrs.marginals, monotone_structs);
+
+	std::vector<LatticePoint> support(support_length, LatticePoint({}));
+	parallel_for(0, support_length, threads, [&] (std::size_t begin, std::size_t end) {
+		std::vector<int> ith_support(dim);
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			for (int j = 0; j < dim; ++j) {
+				ith_support[j] = marginal_supports[j][indices[i * dim + j]];
+			}
+			support[i] = LatticePoint(ith_support);
+		}
+	});
+	return support;
+}
+
+// cdfs of the marginals, flipped to be consistent with the monotone structure; weights_of(j)
+// gives the weights of marginal j, which are converted to Scalar before they are summed
+template <typename Scalar, typename SummationPolicy, typename WeightsOf>
+void flipped_cdfs(int dim, WeightsOf weights_of, const std::vector<int>& monotone_structs, unsigned threads,
+	std::vector<std::vector<Scalar>> * marginal_cdfs, std::vector<std::vector<Scalar>> * cdf_errors)
+{
+	parallel_for(0, dim, threads, [&] (std::size_t begin, std::size_t end) {
+		for (std::size_t j = begin; j < end; ++j)
+		{
+			const auto & w = weights_of(j);
+			const bool flip = monotone_structs[j] == -1;
+			auto & cdf = (*marginal_cdfs)[j];
+			auto & error = (*cdf_errors)[j];
+			cdf.resize(w.size());
+			error.resize(w.size());
+
+			typename SummationPolicy::template Accumulator<Scalar> acc;
+			for (std::size_t i = 0; i < w.size(); ++i) {
+				acc.add(static_cast<Scalar>(flip ? w[w.size() - 1 - i] : w[i]));
+				cdf[i] = acc.value();
+				error[i] = acc.error();
+			}
+		}
+	}, 1);
+}
+
+}	// namespace
+
+template <typename Scalar>
+BasicJointCDF<Scalar> basic_merge_marginal_cdfs(const std::vector<std::vector<Scalar>>& marginal_cdfs,
+	const std::vector<std::vector<Scalar>>& errors, double tol, EJDStats * stats, unsigned threads)
+{
+	return merge_cdfs<Scalar>(marginal_cdfs, errors, tol, 1, stats, threads);
+}
+
+template <typename Scalar>
+BasicJointCDF<Scalar> basic_merge_marginal_cdf_range(const std::vector<std::vector<Scalar>>& marginal_cdfs,
+	const std::vector<std::vector<Scalar>>& errors, double tol, const std::vector<std::size_t>& begin,
+	const std::vector<std::size_t>& end, bool * tail)
+{
+	auto chunk = merge_chunk<Scalar>(marginal_cdfs, errors, tol, 1, begin, end);
+	if (tail) {
+		*tail = chunk.tail;
+	}
+	return std::move(chunk.joint);
+}
+
+template <typename Scalar, typename SummationPolicy>
+BasicExtremeMeasure<Scalar> basic_ejd(const EmpDistrArray& empdistrarrs, const std::vector<int>& monotone_structs,
+	const EJDOptions& options, EJDStats * stats)
+{
+	const int dim = empdistrarrs.dimensions();
+
+	std::vector<std::vector<Scalar>> marginal_cdfs(dim);
+	std::vector<std::vector<Scalar>> cdf_errors(dim);
+	flipped_cdfs<Scalar, SummationPolicy>(dim, [&] (int j) -> const auto & { return empdistrarrs.marginals[j].weights; },
+		monotone_structs, options.threads, &marginal_cdfs, &cdf_errors);
+
+	const double tol = std::max<double>(options.coalesce_tol, 4 * std::numeric_limits<Scalar>::epsilon());
+	const auto joint = merge_cdfs<Scalar>(marginal_cdfs, cdf_errors, tol, 1, stats, options.threads, options.cancellation);
+	const std::size_t support_length = joint.breakpoints.size();
+
+	BasicExtremeMeasure<Scalar> em;
+	em.monotone_structure = monotone_structs;
+
+	breakpoint_weights(joint.breakpoints, joint.errors, &em.weights);
+
+	em.support = joint_support(empdistrarrs, monotone_structs, joint.indices, support_length, options.threads);
+	return em;
+}
+
+template <typename Scalar, typename SummationPolicy>
+BasicJointCDF<Scalar> basic_joint_cdf(const std::vector<std::vector<Scalar>>& marginal_weights,
+	const std::vector<int>& monotone_structs, const EJDOptions& options, EJDStats * stats)
+{
+	const int dim = marginal_weights.size();
+
+	std::vector<std::vector<Scalar>> marginal_cdfs(dim);
+	std::vector<std::vector<Scalar>> cdf_errors(dim);
+	flipped_cdfs<Scalar, SummationPolicy>(dim, [&] (int j) -> const auto & { return marginal_weights[j]; },
+		monotone_structs, options.threads, &marginal_cdfs, &cdf_errors);
+
+	const double tol = std::max<double>(options.coalesce_tol, 4 * std::numeric_limits<Scalar>::epsilon());
+	return merge_cdfs<Scalar>(marginal_cdfs, cdf_errors, tol, 1, stats, options.threads, options.cancellation);
+}
+
+void oriented_cdf(const EmpiricalDistribution& marginal, bool flip, std::vector<double> * cdf,
+	std::vector<double> * errors, std::vector<int> * support)
+{
+	const auto & w = marginal.weights;
+	const auto & s = marginal.support;
+	const std::size_t n = w.size();
+	cdf->resize(n);
+	errors->resize(n);
+	support->resize(n);
+
+	NeumaierSummation::Accumulator<double> acc;
+	for (std::size_t i = 0; i < n; ++i) {
+		const std::size_t k = flip ? n - 1 - i : i;
+		acc.add(w[k]);
+		(*cdf)[i] = acc.value();
+		(*errors)[i] = acc.error();
+		(*support)[i] = static_cast<int>(s[k]);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Fixed-Point EJD
+//
+//////////////////////////////////////////////////////////////////////////////
+
+template <typename UInt>
+UInt to_fixed_point(double c)
+{
+	constexpr int bits = FixedPointExtremeMeasure<UInt>::fraction_bits;
+	if (!(c > 0)) {
+		return 0;
+	}
+	if (c >= 1) {
+		return FixedPointExtremeMeasure<UInt>::one;
+	}
+	// c = M 2^(e-53) with M a 53 bit integer, so c 2^bits = M 2^(bits+e-53)
+	int e;
+	const UInt M = static_cast<std::uint64_t>(std::ldexp(std::frexp(c, &e), 53));
+	const int shift = bits + e - 53;
+	if (shift >= 0) {
+		return M << shift;
+	}
+	if (-shift >= 54) {
+		return 0;
+	}
+	// round half up
+	return (M + (UInt(1) << (-shift - 1))) >> -shift;
+}
+
+template <typename UInt>
+ExtremeMeasure FixedPointExtremeMeasure<UInt>::to_ExtremeMeasure() const
+{
+	ExtremeMeasure em;
+	em.support = support;
+	em.weights.resize(weights.size());
+	for (std::size_t i = 0; i < weights.size(); ++i) {
+		em.weights[i] = std::ldexp(static_cast<long double>(weights[i]), -fraction_bits);
+	}
+	em.monotone_structure = monotone_structure;
+	return em;
+}
+
+template <typename UInt>
+FixedPointExtremeMeasure<UInt> fixed_point_ejd(const EmpDistrArray& empdistrarrs,
+	const std::vector<int>& monotone_structs, EJDStats * stats, unsigned threads)
+{
+	constexpr UInt one = FixedPointExtremeMeasure<UInt>::one;
+	const int dim = empdistrarrs.dimensions();
+
+	// flipped cdfs, accumulated in double and then rounded; every one of them ends at exactly one
+	std::vector<std::vector<UInt>> marginal_cdfs(dim);
+	for (int j = 0; j < dim; ++j)
+	{
+		const auto & w = empdistrarrs.marginals[j].weights;
+		const bool flip = monotone_structs[j] == -1;
+		marginal_cdfs[j].resize(w.size());
+
+		NeumaierSummation::Accumulator<double> acc;
+		for (std::size_t i = 0; i < w.size(); ++i) {
+			acc.add(flip ? w[w.size() - 1 - i] : w[i]);
+			marginal_cdfs[j][i] = to_fixed_point<UInt>(acc.value());
+		}
+		if (!w.empty()) {
+			marginal_cdfs[j].back() = one;
+		}
+	}
+
+	const auto joint = merge_cdfs<UInt>(marginal_cdfs, {}, 0, one, stats, threads);
+	const std::size_t support_length = joint.breakpoints.size();
+
+	FixedPointExtremeMeasure<UInt> em;
+	em.monotone_structure = monotone_structs;
+	em.weights.resize(support_length);
+	std::adjacent_difference(joint.breakpoints.begin(), joint.breakpoints.end(), em.weights.begin());
+	em.support = joint_support(empdistrarrs, monotone_structs, joint.indices, support_length, threads);
+	return em;
+}
+
+#define EJD_INSTANTIATE_FIXED_POINT(UInt) \
+	template struct FixedPointExtremeMeasure<UInt>; \
+	template UInt to_fixed_point<UInt>(double); \
+	template FixedPointExtremeMeasure<UInt> fixed_point_ejd<UInt>( \
+		const EmpDistrArray&, const std::vector<int>&, EJDStats *, unsigned);
+
+EJD_INSTANTIATE_FIXED_POINT(std::uint64_t)
+#ifdef EJD_HAS_UINT128
+EJD_INSTANTIATE_FIXED_POINT(uint128_t)
+#endif
+
+#undef EJD_INSTANTIATE_FIXED_POINT
+
+#define EJD_INSTANTIATE_JOINT_CDF(Scalar) \
+	template BasicJointCDF<Scalar> basic_merge_marginal_cdfs<Scalar>( \
+		const std::vector<std::vector<Scalar>>&, const std::vector<std::vector<Scalar>>&, double, EJDStats *, unsigned); \
+	template BasicJointCDF<Scalar> basic_merge_marginal_cdf_range<Scalar>( \
+		const std::vector<std::vector<Scalar>>&, const std::vector<std::vector<Scalar>>&, double, \
+		const std::vector<std::size_t>&, const std::vector<std::size_t>&, bool *); \
+	template BasicJointCDF<Scalar> basic_joint_cdf<Scalar, NaiveSummation>( \
+		const std::vector<std::vector<Scalar>>&, const std::vector<int>&, const EJDOptions&, EJDStats *); \
+	template BasicJointCDF<Scalar> basic_joint_cdf<Scalar, NeumaierSummation>( \
+		const std::vector<std::vector<Scalar>>&, const std::vector<int>&, const EJDOptions&, EJDStats *);
+
+#define EJD_INSTANTIATE_ENGINE(Scalar) \
+	EJD_INSTANTIATE_JOINT_CDF(Scalar) \
+	template struct BasicExtremeMeasure<Scalar>; \
+	template BasicExtremeMeasure<Scalar> basic_ejd<Scalar, NaiveSummation>( \
+		const EmpDistrArray&, const std::vector<int>&, const EJDOptions&, EJDStats *); \
+	template BasicExtremeMeasure<Scalar> basic_ejd<Scalar, NeumaierSummation>( \
+		const EmpDistrArray&, const std::vector<int>&, const EJDOptions&, EJDStats *);
+
+EJD_INSTANTIATE_ENGINE(float)
+EJD_INSTANTIATE_ENGINE(double)
+EJD_INSTANTIATE_ENGINE(long double)
+EJD_INSTANTIATE_JOINT_CDF(Dual<1>)
+EJD_INSTANTIATE_JOINT_CDF(Dual<2>)
+
+#undef EJD_INSTANTIATE_ENGINE
+#undef EJD_INSTANTIATE_JOINT_CDF
+
+// namespace ejd
+}
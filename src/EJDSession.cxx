@@ -0,0 +1,506 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "EJDSession.hpp"
+#include "EJDEngine.hpp"
+// std libs
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace ejd {
+
+namespace {
+
+constexpr double infinity = std::numeric_limits<double>::infinity();
+
+// kept breakpoints between two regions below which they are merged as one
+constexpr std::size_t fuse_below = 32;
+
+// a structure is spliced when the old and new values of the changed marginal are fewer than
+// this fraction of its breakpoints, and merged again in full otherwise
+constexpr std::size_t splice_ratio = 8;
+
+std::vector<std::vector<int>> all_structures(int dim)
+{
+	const MonotonicityStructure ms(dim);
+	std::vector<std::vector<int>> structures;
+	structures.reserve(ms.num_extremepts());
+	for (int s = 0; s < ms.num_extremepts(); ++s) {
+		structures.push_back(ms[s]);
+	}
+	return structures;
+}
+
+// the values [lo, hi) of the sorted lists, a run of them without a gap wider than tol inside
+// and with one on either side, so that every merge of them starts a breakpoint at lo and at hi
+struct Region
+{
+	double lo;
+	double hi;
+};
+
+// the largest value below y and the smallest above it over all the lists, -/+ infinity for none
+double predecessor(const std::vector<const std::vector<double>*>& lists, double y)
+{
+	double p = -infinity;
+	for (const auto * list : lists) {
+		auto it = std::lower_bound(list->begin(), list->end(), y);
+		if (it != list->begin()) {
+			p = std::max(p, *std::prev(it));
+		}
+	}
+	return p;
+}
+
+double successor(const std::vector<const std::vector<double>*>& lists, double y)
+{
+	double q = infinity;
+	for (const auto * list : lists) {
+		auto it = std::upper_bound(list->begin(), list->end(), y);
+		if (it != list->end()) {
+			q = std::min(q, *it);
+		}
+	}
+	return q;
+}
+
+// the first value after x that follows a gap wider than tol, infinity for none
+double gap_after(const std::vector<const std::vector<double>*>& lists, double x, double tol)
+{
+	for (;;) {
+		const double q = successor(lists, x);
+		if (q > x + tol) {
+			return q;
+		}
+		x = q;
+	}
+}
+
+Region region_around(const std::vector<const std::vector<double>*>& lists, double x, double tol)
+{
+	Region r {x, x};
+	for (;;) {
+		const double p = predecessor(lists, r.lo);
+		if (p == -infinity) {
+			r.lo = -infinity;
+			break;
+		}
+		if (r.lo > p + tol) {
+			break;
+		}
+		r.lo = p;
+	}
+	r.hi = gap_after(lists, x, tol);
+	return r;
+}
+
+// first position of the sorted v at or after x, with -/+ infinity for its ends
+std::size_t position_of(const std::vector<double>& v, double x)
+{
+	if (x == -infinity) {
+		return 0;
+	}
+	return std::lower_bound(v.begin(), v.end(), x) - v.begin();
+}
+
+}	// namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// EJD Session
+//
+//////////////////////////////////////////////////////////////////////////////
+
+EJDSession::EJDSession(EmpDistrArray marginals, const EJDOptions& options)
+	: EJDSession(marginals, all_structures(marginals.dimensions()), options)
+{}
+
+EJDSession::EJDSession(EmpDistrArray marginals, std::vector<std::vector<int>> monotone_structures,
+	const EJDOptions& options)
+	: marginals_(std::move(marginals)),
+	  options(options)
+{
+	if (options.arithmetic != EJDArithmetic::floating) {
+		throw std::invalid_argument("ejd: EJDSession: only floating arithmetic is supported");
+	}
+	const int dim = marginals_.dimensions();
+	for (const auto & m : marginals_.marginals) {
+		if (m.weights.empty() || m.weights.size() != m.support.size()) {
+			throw std::invalid_argument("ejd: EJDSession: empty or malformed marginal");
+		}
+	}
+	for (const auto & ms : monotone_structures) {
+		if (static_cast<int>(ms.size()) != dim
+				|| !std::all_of(ms.begin(), ms.end(), [] (int s) { return s == 1 || s == -1; })) {
+			throw std::invalid_argument("ejd: EJDSession: monotone structures must have dim entries of +1 or -1");
+		}
+	}
+	tol = std::max(options.coalesce_tol, 4 * std::numeric_limits<double>::epsilon());
+
+	means.resize(dim);
+	variances.resize(dim);
+	supports[0].resize(dim);
+	supports[1].resize(dim);
+	structures.resize(monotone_structures.size());
+	for (std::size_t s = 0; s < structures.size(); ++s) {
+		structures[s].monotone_structure = std::move(monotone_structures[s]);
+		structures[s].cdfs.resize(dim);
+		structures[s].cdf_errors.resize(dim);
+	}
+	for (int j = 0; j < dim; ++j) {
+		set_marginal(j);
+	}
+	for (auto & st : structures) {
+		rebuild(st);
+	}
+}
+
+int EJDSession::dimension() const noexcept {
+	return marginals_.marginals.size();
+}
+
+int EJDSession::num_structures() const noexcept {
+	return structures.size();
+}
+
+const EmpDistrArray& EJDSession::marginals() const noexcept {
+	return marginals_;
+}
+
+const std::vector<int>& EJDSession::monotone_structure(int s) const noexcept {
+	return structures[s].monotone_structure;
+}
+
+ExtremeMeasureView EJDSession::view(int s) const noexcept
+{
+	const auto & st = structures[s];
+	ExtremeMeasureView v;
+	v.dim = dimension();
+	v.size = st.weights.size();
+	v.monotone_structure = st.monotone_structure.data();
+	v.means = means.data();
+	v.variances = variances.data();
+	v.weights = st.weights.data();
+	v.coords = st.coords.data();
+	return v;
+}
+
+ExtremeMeasure EJDSession::measure(int s) const {
+	return view(s).to_ExtremeMeasure();
+}
+
+ExtremeMeasures EJDSession::measures() const
+{
+	ExtremeMeasures ems;
+	ems.reserve(structures.size());
+	for (int s = 0; s < num_structures(); ++s) {
+		ems.push_back(measure(s));
+	}
+	return ems;
+}
+
+const EJDSessionStats& EJDSession::last_update() const noexcept {
+	return stats;
+}
+
+// the supports, moments and cdfs of marginal j, as basic_ejd<double> sums them
+void EJDSession::set_marginal(int j)
+{
+	const auto summary = marginals_.marginals[j].summary();
+	means[j] = summary.mean;
+	variances[j] = summary.variance;
+
+	for (int flip = 0; flip < 2; ++flip) {
+		std::vector<double> cdf;
+		std::vector<double> error;
+		oriented_cdf(marginals_.marginals[j], flip, &cdf, &error, &supports[flip][j]);
+		for (auto & st : structures) {
+			if ((st.monotone_structure[j] == -1) == flip) {
+				st.cdfs[j] = cdf;
+				st.cdf_errors[j] = error;
+			}
+		}
+	}
+}
+
+void EJDSession::rebuild(Structure& st)
+{
+	const int dim = dimension();
+	const auto joint = basic_merge_marginal_cdfs<double>(st.cdfs, st.cdf_errors, tol, nullptr, options.threads);
+	const std::size_t n = joint.breakpoints.size();
+
+	st.breakpoints = joint.breakpoints;
+	st.errors = joint.errors;
+	st.atoms.resize(n * dim);
+	for (std::size_t i = 0; i < n; ++i) {
+		for (int k = 0; k < dim; ++k) {
+			st.atoms[k * n + i] = joint.indices[i * dim + k];
+		}
+	}
+	fill_measure(st);
+}
+
+// weights and coordinates from the breakpoints and atoms
+void EJDSession::fill_measure(Structure& st)
+{
+	const int dim = dimension();
+	const std::size_t n = st.breakpoints.size();
+	breakpoint_weights(st.breakpoints, st.errors, &st.weights);
+	st.coords.resize(n * dim);
+	for (int k = 0; k < dim; ++k) {
+		const auto & support = supports[st.monotone_structure[k] == -1][k];
+		for (std::size_t i = 0; i < n; ++i) {
+			st.coords[k * n + i] = support[st.atoms[k * n + i]];
+		}
+	}
+}
+
+// merges again the regions around the old and new cdf values of marginal j, plus the one at
+// the top where the last breakpoint is made, and keeps the breakpoints in between
+void EJDSession::splice(Structure& st, int j, const std::vector<double>& old_cdf)
+{
+	const int dim = dimension();
+	const auto & new_cdf = st.cdfs[j];
+	const std::size_t old_n = st.breakpoints.size();
+
+	// regions around every old and new value of j, over both versions of the cdfs
+	std::vector<const std::vector<double>*> lists;
+	for (int k = 0; k < dim; ++k) {
+		if (k != j) {
+			lists.push_back(&st.cdfs[k]);
+		}
+	}
+	lists.push_back(&old_cdf);
+	lists.push_back(&new_cdf);
+
+	std::vector<Region> regions;
+	// a region that would keep only a few breakpoints before the next one is stretched over
+	// them instead, which merges them again but saves a walk and a merge call
+	auto cover = [&] (double x) {
+		if (!regions.empty() && x < regions.back().hi) {
+			return;
+		}
+		if (!regions.empty()
+				&& position_of(st.breakpoints, x) - position_of(st.breakpoints, regions.back().hi) < fuse_below) {
+			regions.back().hi = gap_after(lists, x, tol);
+			return;
+		}
+		regions.push_back(region_around(lists, x, tol));
+	};
+	std::size_t a = 0;
+	std::size_t b = 0;
+	while (a < old_cdf.size() || b < new_cdf.size()) {
+		if (b == new_cdf.size() || (a < old_cdf.size() && old_cdf[a] < new_cdf[b])) {
+			cover(old_cdf[a++]);
+		} else {
+			cover(new_cdf[b++]);
+		}
+	}
+	double top = -infinity;
+	for (const auto * list : lists) {
+		top = std::max(top, list->back());
+	}
+	cover(top);
+
+	std::vector<double> breakpoints;
+	std::vector<double> errors;
+	std::vector<std::vector<int>> atoms(dim);
+	breakpoints.reserve(old_n + new_cdf.size() + 1);
+	errors.reserve(old_n + new_cdf.size() + 1);
+	for (auto & column : atoms) {
+		column.reserve(old_n + new_cdf.size() + 1);
+	}
+
+	// breakpoints between the regions keep every atom but that of j, which is the number of
+	// values of j below them since no value of j lies between the regions
+	std::size_t below = 0;
+	auto keep = [&] (std::size_t begin, std::size_t end) {
+		for (std::size_t i = begin; i < end; ++i) {
+			const double x = st.breakpoints[i];
+			breakpoints.push_back(x);
+			errors.push_back(st.errors[i]);
+			for (int k = 0; k < dim; ++k) {
+				if (k != j) {
+					atoms[k].push_back(st.atoms[k * old_n + i]);
+				}
+			}
+			while (below < new_cdf.size() && new_cdf[below] < x) {
+				++below;
+			}
+			atoms[j].push_back(std::min(below, new_cdf.size() - 1));
+		}
+	};
+
+	std::size_t kept = 0;
+	std::vector<std::size_t> begin(dim);
+	std::vector<std::size_t> end(dim);
+	for (const auto & r : regions)
+	{
+		const std::size_t old_begin = position_of(st.breakpoints, r.lo);
+		const std::size_t old_end = r.hi == infinity ? old_n : position_of(st.breakpoints, r.hi);
+		keep(kept, old_begin);
+		kept = old_end;
+		stats.replaced += old_end - old_begin;
+
+		for (int k = 0; k < dim; ++k) {
+			begin[k] = position_of(st.cdfs[k], r.lo);
+			end[k] = r.hi == infinity ? st.cdfs[k].size() : position_of(st.cdfs[k], r.hi);
+			stats.merged_values += end[k] - begin[k];
+		}
+		bool tail = false;
+		const auto joint = basic_merge_marginal_cdf_range<double>(st.cdfs, st.cdf_errors, tol, begin, end, &tail);
+		breakpoints.insert(breakpoints.end(), joint.breakpoints.begin(), joint.breakpoints.end());
+		errors.insert(errors.end(), joint.errors.begin(), joint.errors.end());
+		for (std::size_t i = 0; i < joint.breakpoints.size(); ++i) {
+			for (int k = 0; k < dim; ++k) {
+				atoms[k].push_back(joint.indices[i * dim + k]);
+			}
+		}
+
+		// the top region ends the joint cdf as merge_marginal_cdfs does
+		if (r.hi == infinity) {
+			if (tail) {
+				breakpoints.back() = 1;
+				errors.back() = 0;
+			}
+			else {
+				breakpoints.push_back(1);
+				errors.push_back(0);
+				for (int k = 0; k < dim; ++k) {
+					atoms[k].push_back(st.cdfs[k].size() - 1);
+				}
+			}
+		}
+	}
+	keep(kept, old_n);
+
+	const std::size_t n = breakpoints.size();
+	st.breakpoints = std::move(breakpoints);
+	st.errors = std::move(errors);
+	st.atoms.resize(n * dim);
+	for (int k = 0; k < dim; ++k) {
+		std::copy(atoms[k].begin(), atoms[k].end(), st.atoms.begin() + k * n);
+	}
+	fill_measure(st);
+}
+
+void EJDSession::update_marginal(int j, EmpiricalDistribution marginal)
+{
+	if (j < 0 || j >= dimension()) {
+		throw std::invalid_argument("ejd: EJDSession::update_marginal: no such marginal");
+	}
+	if (marginal.weights.empty() || marginal.weights.size() != marginal.support.size()) {
+		throw std::invalid_argument("ejd: EJDSession::update_marginal: empty or malformed marginal");
+	}
+	marginals_.marginals[j] = std::move(marginal);
+	marginals_.invalidate_summaries();
+	stats = EJDSessionStats();
+
+	std::vector<std::vector<double>> old_cdfs(structures.size());
+	for (std::size_t s = 0; s < structures.size(); ++s) {
+		old_cdfs[s] = std::move(structures[s].cdfs[j]);
+	}
+	set_marginal(j);
+	for (std::size_t s = 0; s < structures.size(); ++s) {
+		auto & st = structures[s];
+		if ((old_cdfs[s].size() + st.cdfs[j].size()) * splice_ratio < st.breakpoints.size()) {
+			splice(st, j, old_cdfs[s]);
+			++stats.spliced;
+		}
+		else {
+			stats.replaced += st.breakpoints.size();
+			for (const auto & cdf : st.cdfs) {
+				stats.merged_values += cdf.size();
+			}
+			rebuild(st);
+		}
+	}
+}
+
+void EJDSession::update_distribution(int j, const MarginalDistribution& distribution)
+{
+	if (distributions.empty()) {
+		throw std::logic_error("ejd: EJDSession::update_distribution: the session was not made from distributions");
+	}
+	if (j < 0 || j >= dimension()) {
+		throw std::invalid_argument("ejd: EJDSession::update_distribution: no such marginal");
+	}
+	const int old_end = *std::max_element(upper_bounds.begin(), upper_bounds.end());
+	distributions[j] = distribution;
+	upper_bounds[j] = recurrence_upper_bounds(distribution, errtol);
+	const int support_end = *std::max_element(upper_bounds.begin(), upper_bounds.end());
+
+	if (support_end == old_end) {
+		auto weights = recurrence_pmf(distribution, support_end);
+		if (!weights.empty()) {
+			edit_sum_1(&weights);
+		}
+		std::vector<double> support(support_end);
+		std::iota(support.begin(), support.end(), 0);
+		update_marginal(j, EmpiricalDistribution {.weights = weights, .support = support});
+		return;
+	}
+
+	// the common support moved: every marginal changes
+	marginals_ = construct_EmpDistrArray(distributions, errtol);
+	stats = EJDSessionStats();
+	stats.rebuilt = true;
+	for (int k = 0; k < dimension(); ++k) {
+		set_marginal(k);
+	}
+	for (auto & st : structures) {
+		rebuild(st);
+		stats.replaced += st.breakpoints.size();
+		for (const auto & cdf : st.cdfs) {
+			stats.merged_values += cdf.size();
+		}
+	}
+}
+
+EJDSession construct_EJDSession(const std::vector<MarginalDistribution>& distrs, const EJDOptions& options,
+	double errtol)
+{
+	EJDSession session(construct_EmpDistrArray(distrs, errtol), options);
+	session.distributions = distrs;
+	session.errtol = errtol;
+	session.upper_bounds.reserve(distrs.size());
+	for (const auto & d : distrs) {
+		session.upper_bounds.push_back(recurrence_upper_bounds(d, errtol));
+	}
+	return session;
+}
+
+EJDSession construct_Poisson_EJDSession(const std::vector<double>& intensities, const EJDOptions& options)
+{
+	std::vector<MarginalDistribution> distrs;
+	distrs.reserve(intensities.size());
+	for (double lambda : intensities) {
+		distrs.emplace_back(bm::poisson(lambda));
+	}
+	return construct_EJDSession(distrs, options);
+}
+
+// namespace ejd
+}
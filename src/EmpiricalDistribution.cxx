@@ -24,6 +24,9 @@
 #include "EmpiricalDistribution.hpp"
 // std libs
 #include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
 
 namespace ejd {
 
@@ -89,11 +92,17 @@ double EmpiricalDistribution::total_prob() const {
 }
 
 double EmpiricalDistribution::entropy() const {
-	double ent = 0;
-	for (const auto & w : weights) {
-		ent += w * std::log(w);
-	}
-	return -ent;
+	return kernels::entropy(weights.data(), weights.size());
+}
+
+MarginalSummary EmpiricalDistribution::summary() const {
+	const auto sums = kernels::moment_sums(weights.data(), support.data(), std::min(weights.size(), support.size()));
+	return {
+		.total_mass = sums.mass,
+		.mean = sums.first,
+		.variance = sums.second - sums.first * sums.first,
+		.entropy = sums.entropy
+	};
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -107,57 +116,79 @@ bool EmpDistrArray::operator==(const EmpDistrArray& rhs) const {
 }
 
 std::vector<double> EmpDistrArray::means() const {
-	std::vector<double> means(marginals.size(),0.);
-
-	std::transform(
-		marginals.begin(),
-		marginals.end(),
-		means.begin(),
-		[](const EmpiricalDistribution & empdistr) {
-			return empdistr.mean();
-		}
-	);
-
+	const auto & s = summaries();
+	std::vector<double> means(s.size());
+	std::transform(s.begin(), s.end(), means.begin(), [] (const MarginalSummary & m) { return m.mean; });
 	return means;
 }
 
 std::vector<double> EmpDistrArray::variances() const {
-	std::vector<double> variances(marginals.size(),0.);
-
-	std::transform(
-		marginals.begin(),
-		marginals.end(),
-		variances.begin(),
-		[] (const EmpiricalDistribution & empdistr) {
-			return empdistr.variance();
-		}
-	);
-
+	const auto & s = summaries();
+	std::vector<double> variances(s.size());
+	std::transform(s.begin(), s.end(), variances.begin(), [] (const MarginalSummary & m) { return m.variance; });
 	return variances;
 }
 
+void EmpDistrArray::means_and_variances(std::vector<double> * means, std::vector<double> * variances) const
+{
+	const auto & s = summaries();
+	means->resize(s.size());
+	variances->resize(s.size());
+	for (std::size_t j = 0; j < s.size(); ++j) {
+		(*means)[j] = s[j].mean;
+		(*variances)[j] = s[j].variance;
+	}
+}
+
 int EmpDistrArray::dimensions() const {
 	return marginals.size();
 }
 
-EmpDistrArray construct_EmpDistrArray(const std::vector<bm::poisson>& poisson_distrs) 
+struct EmpDistrArray::SummaryCache
 {
-	std::vector<EmpiricalDistribution> emp_distr_data;
-
-	// calculate the max length of uspport 
-	int max_upper_bound = 0;
-	for (int i = 0; i < poisson_distrs.size(); ++i) {
-		int this_ub = upper_bounds(poisson_distrs[i]);
-		max_upper_bound = max_upper_bound < this_ub ? this_ub : max_upper_bound;
-	}
-
-	for (int i = 0; i < poisson_distrs.size(); ++i) {
-		emp_distr_data.emplace_back(
-			construct_discrete_EmpDistr(poisson_distrs[i], max_upper_bound)
+	std::vector<EmpiricalDistribution> marginals;
+	std::vector<MarginalSummary> summaries;
+};
+
+const std::vector<MarginalSummary>& EmpDistrArray::summaries() const {
+	auto cache = std::atomic_load(&summary_cache);
+	if (!cache || !std::equal(marginals.begin(), marginals.end(), cache->marginals.begin(), cache->marginals.end())) {
+		auto computed = std::make_shared<SummaryCache>();
+		computed->marginals = marginals;
+		computed->summaries.resize(marginals.size());
+		std::transform(
+			marginals.begin(),
+			marginals.end(),
+			computed->summaries.begin(),
+			[] (const EmpiricalDistribution & empdistr) {
+				return empdistr.summary();
+			}
 		);
+		// a concurrent caller of the same marginals may have won the race, in which case its
+		// summaries are used
+		std::shared_ptr<const SummaryCache> expected = cache;
+		cache = computed;
+		if (!std::atomic_compare_exchange_strong(&summary_cache, &expected, cache)) {
+			if (expected && std::equal(marginals.begin(), marginals.end(), expected->marginals.begin(), expected->marginals.end())) {
+				cache = expected;
+			} else {
+				// the member has to hold what the reference is to
+				std::atomic_store(&summary_cache, cache);
+			}
+		}
 	}
+	return cache->summaries;
+}
 
-	return EmpDistrArray(emp_distr_data);
+void EmpDistrArray::invalidate_summaries() {
+	std::atomic_store(&summary_cache, std::shared_ptr<const SummaryCache>());
+}
+
+EmpDistrArray construct_EmpDistrArray(const std::vector<bm::poisson>& poisson_distrs) 
+{
+	return construct_EmpDistrArray(
+		std::vector<MarginalDistribution>(poisson_distrs.begin(), poisson_distrs.end())
+	);
 }
 
 EmpDistrArray construct_Poisson_EmpDistrArray(const std::vector<double>& intensities)
@@ -170,5 +201,178 @@ EmpDistrArray construct_Poisson_EmpDistrArray(const std::vector<double>& intensi
 	}
 	return construct_EmpDistrArray(poiss_distrs);
 }
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Recurrence Marginals
+//
+//////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// ratios of consecutive atoms: up(k) = p(k+1)/p(k) and down(k) = p(k-1)/p(k)
+struct PoissonRatios {
+	double lambda;
+	int mode() const { return static_cast<int>(std::floor(lambda)); }
+	double up(int k) const { return lambda / (k + 1); }
+	double down(int k) const { return k / lambda; }
+};
+
+struct BinomialRatios {
+	int n;
+	double p;
+	int mode() const { return std::min(n, static_cast<int>(std::floor((n + 1) * p))); }
+	double up(int k) const { return k >= n ? 0. : (n - k) / (k + 1.) * p / (1 - p); }
+	double down(int k) const { return k / (n - k + 1.) * (1 - p) / p; }
+};
+
+struct NegativeBinomialRatios {
+	double r;
+	double p;
+	int mode() const { return r > 1 ? static_cast<int>(std::floor((r - 1) * (1 - p) / p)) : 0; }
+	double up(int k) const { return (k + r) / (k + 1) * (1 - p); }
+	double down(int k) const { return k / ((k - 1 + r) * (1 - p)); }
+};
+
+struct GeometricRatios {
+	double p;
+	int mode() const { return 0; }
+	double up(int) const { return 1 - p; }
+	double down(int) const { return 1 / (1 - p); }
+};
+
+// Produces the atoms of a marginal in order. Everything up to the mode is filled on construction
+// by recurring down from p(mode); the rest is produced on demand by recurring up.
+class RecurrencePmf
+{
+public:
+	template <typename Distribution, typename Ratios>
+	RecurrencePmf(const Distribution& distr, Ratios ratios)
+		: mode(std::max(ratios.mode(), 0)),
+		  next_atom([this, ratios] (int k) { return atoms[k-1] * ratios.up(k-1); })
+	{
+		atoms.resize(mode + 1);
+		atoms[mode] = bm::pdf(distr, mode);
+		for (int k = mode; k > 0; --k) {
+			atoms[k-1] = atoms[k] * ratios.down(k);
+		}
+	}
+
+	explicit RecurrencePmf(const GenericMarginal& distr)
+		: next_atom(distr.pdf),
+		  tail(distr.tail)
+	{}
+
+	// captures this
+	RecurrencePmf(const RecurrencePmf&) = delete;
+	RecurrencePmf& operator=(const RecurrencePmf&) = delete;
+
+	double operator[](int k) {
+		while (static_cast<int>(atoms.size()) <= k) {
+			atoms.push_back(next_atom(atoms.size()));
+		}
+		return atoms[k];
+	}
+
+	// the first k with P(X > k) <= errtol, reading the atoms once
+	int upper_bound(double errtol) {
+		if (tail) {
+			int k = 0;
+			while (tail(k) > errtol) {
+				++k;
+			}
+			return k;
+		}
+		double cdf = 0;
+		double compensation = 0;
+		for (int k = 0; ; ++k) {
+			const double p = (*this)[k];
+			// Neumaier summation, P(X > k) is a small difference of nearly equal numbers
+			const double t = cdf + p;
+			compensation += (cdf >= p) ? (cdf - t) + p : (p - t) + cdf;
+			cdf = t;
+			// past the mode the atoms only decrease, once they vanish so does the tail
+			if (1 - (cdf + compensation) <= errtol || (p == 0 && k > mode)) {
+				return k;
+			}
+		}
+	}
+
+	std::vector<double> pmf(int support_end) {
+		if (support_end > 0) {
+			(*this)[support_end - 1];
+		}
+		return std::vector<double>(atoms.begin(), atoms.begin() + std::max(support_end, 0));
+	}
+
+private:
+	int mode = 0;
+	std::function<double(int)> next_atom;
+	std::function<double(int)> tail;	// only set for generic marginals
+	std::vector<double> atoms;
+};
+
+std::unique_ptr<RecurrencePmf> make_recurrence(const MarginalDistribution& distr)
+{
+	return std::visit(
+		[] (const auto & d) {
+			using D = std::decay_t<decltype(d)>;
+			if constexpr (std::is_same_v<D, bm::poisson>) {
+				return std::make_unique<RecurrencePmf>(d, PoissonRatios {d.mean()});
+			} else if constexpr (std::is_same_v<D, bm::binomial>) {
+				return std::make_unique<RecurrencePmf>(d,
+					BinomialRatios {static_cast<int>(d.trials()), d.success_fraction()});
+			} else if constexpr (std::is_same_v<D, bm::negative_binomial>) {
+				return std::make_unique<RecurrencePmf>(d,
+					NegativeBinomialRatios {d.successes(), d.success_fraction()});
+			} else if constexpr (std::is_same_v<D, bm::geometric>) {
+				return std::make_unique<RecurrencePmf>(d, GeometricRatios {d.success_fraction()});
+			} else {
+				return std::make_unique<RecurrencePmf>(d);
+			}
+		},
+		distr
+	);
+}
+
+}	// namespace
+
+int recurrence_upper_bounds(const MarginalDistribution& distr, double errtol)
+{
+	return make_recurrence(distr)->upper_bound(errtol);
+}
+
+std::vector<double> recurrence_pmf(const MarginalDistribution& distr, int support_end)
+{
+	return make_recurrence(distr)->pmf(support_end);
+}
+
+EmpDistrArray construct_EmpDistrArray(const std::vector<MarginalDistribution>& distrs, double errtol)
+{
+	std::vector<std::unique_ptr<RecurrencePmf>> pmfs;
+	pmfs.reserve(distrs.size());
+
+	// calculate the max length of support
+	int max_upper_bound = 0;
+	for (const auto & d : distrs) {
+		pmfs.emplace_back(make_recurrence(d));
+		max_upper_bound = std::max(max_upper_bound, pmfs.back()->upper_bound(errtol));
+	}
+
+	std::vector<double> support(max_upper_bound);
+	std::iota(support.begin(), support.end(), 0);
+
+	std::vector<EmpiricalDistribution> emp_distr_data;
+	emp_distr_data.reserve(distrs.size());
+	for (auto & pmf : pmfs) {
+		auto weights = pmf->pmf(max_upper_bound);
+		if (!weights.empty()) {
+			edit_sum_1(&weights);
+		}
+		emp_distr_data.emplace_back(EmpiricalDistribution {.weights = weights, .support = support});
+	}
+	return EmpDistrArray(emp_distr_data);
+}
+
 // namespace ejd
 }
@@ -0,0 +1,207 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ExtremeMeasureBatch.hpp"
+#include "EJDEngine.hpp"
+#include "EmpiricalDistribution.hpp"
+// std libs
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Extreme Measure Batch
+//
+//////////////////////////////////////////////////////////////////////////////
+
+int ExtremeMeasureBatch::dimension() const noexcept {
+	return dim;
+}
+
+std::size_t ExtremeMeasureBatch::size() const noexcept {
+	return num_portfolios * num_structures;
+}
+
+std::size_t ExtremeMeasureBatch::index(std::size_t portfolio, int structure) const noexcept {
+	return portfolio * num_structures + structure;
+}
+
+std::size_t ExtremeMeasureBatch::support_size(std::size_t m) const noexcept {
+	return offsets[m + 1] - offsets[m];
+}
+
+ExtremeMeasureView ExtremeMeasureBatch::view(std::size_t m) const noexcept
+{
+	const std::size_t portfolio = m / num_structures;
+	ExtremeMeasureView v;
+	v.dim = dim;
+	v.size = support_size(m);
+	v.monotone_structure = monotone_structures.data() + (m % num_structures) * dim;
+	v.means = means.data() + portfolio * dim;
+	v.variances = variances.data() + portfolio * dim;
+	v.weights = weights.data() + offsets[m];
+	v.coords = coords.data() + offsets[m] * dim;
+	return v;
+}
+
+ExtremeMeasure ExtremeMeasureBatch::measure(std::size_t m) const {
+	return view(m).to_ExtremeMeasure();
+}
+
+namespace {
+
+// cdfs of the marginals of one portfolio, along their support [0] and flipped [1]
+struct PortfolioCDFs
+{
+	std::vector<std::vector<double>> cdfs[2];
+	std::vector<std::vector<double>> errors[2];
+	std::vector<std::vector<int>> supports[2];
+	// moments of the truncated marginals, as construct_Poisson_ExtremeMeasures reports them
+	std::vector<double> means;
+	std::vector<double> variances;
+};
+
+PortfolioCDFs portfolio_cdfs(const double * intensities, int dim)
+{
+	std::vector<MarginalDistribution> distrs;
+	distrs.reserve(dim);
+	for (int j = 0; j < dim; ++j) {
+		distrs.emplace_back(bm::poisson(intensities[j]));
+	}
+	const auto marginals = construct_EmpDistrArray(distrs);
+
+	PortfolioCDFs p;
+	marginals.means_and_variances(&p.means, &p.variances);
+	for (int flip = 0; flip < 2; ++flip) {
+		p.cdfs[flip].resize(dim);
+		p.errors[flip].resize(dim);
+		p.supports[flip].resize(dim);
+		for (int j = 0; j < dim; ++j) {
+			oriented_cdf(marginals.marginals[j], flip, &p.cdfs[flip][j], &p.errors[flip][j], &p.supports[flip][j]);
+		}
+	}
+	return p;
+}
+
+// weights and column-wise coordinates of one measure
+struct MeasurePiece
+{
+	std::vector<double> weights;
+	std::vector<int> coords;
+};
+
+// what basic_ejd<double> does, on the cdfs of the portfolio
+MeasurePiece merge_piece(const PortfolioCDFs& p, const int * ms, int dim, double tol)
+{
+	std::vector<std::vector<double>> cdfs(dim);
+	std::vector<std::vector<double>> errors(dim);
+	for (int j = 0; j < dim; ++j) {
+		const int flip = ms[j] == -1;
+		cdfs[j] = p.cdfs[flip][j];
+		errors[j] = p.errors[flip][j];
+	}
+	const auto joint = basic_merge_marginal_cdfs<double>(cdfs, errors, tol);
+	const std::size_t n = joint.breakpoints.size();
+
+	MeasurePiece piece;
+	breakpoint_weights(joint.breakpoints, joint.errors, &piece.weights);
+	piece.coords.resize(n * dim);
+	for (int j = 0; j < dim; ++j) {
+		const auto & support = p.supports[ms[j] == -1][j];
+		for (std::size_t i = 0; i < n; ++i) {
+			piece.coords[j * n + i] = support[joint.indices[i * dim + j]];
+		}
+	}
+	return piece;
+}
+
+}	// namespace
+
+ExtremeMeasureBatch construct_Poisson_ExtremeMeasureBatch(const double * intensities, std::size_t num_portfolios,
+	int dim, ThreadPool& pool, const EJDOptions& options)
+{
+	if (options.arithmetic != EJDArithmetic::floating) {
+		throw std::invalid_argument("ejd: construct_Poisson_ExtremeMeasureBatch: only floating arithmetic is supported");
+	}
+	const double tol = std::max(options.coalesce_tol, 4 * std::numeric_limits<double>::epsilon());
+
+	ExtremeMeasureBatch batch;
+	batch.dim = dim;
+	batch.num_portfolios = num_portfolios;
+
+	const MonotonicityStructure structures(dim);
+	batch.num_structures = structures.num_extremepts();
+	batch.monotone_structures.reserve(batch.num_structures * dim);
+	for (int s = 0; s < batch.num_structures; ++s) {
+		const auto ms = structures[s];
+		batch.monotone_structures.insert(batch.monotone_structures.end(), ms.begin(), ms.end());
+	}
+
+	// marginals, once per portfolio
+	std::vector<PortfolioCDFs> portfolios(num_portfolios);
+	batch.means.resize(num_portfolios * dim);
+	batch.variances.resize(num_portfolios * dim);
+	pool.for_each_index(num_portfolios, [&] (std::size_t p) {
+		portfolios[p] = portfolio_cdfs(intensities + p * dim, dim);
+		std::copy(portfolios[p].means.begin(), portfolios[p].means.end(), batch.means.begin() + p * dim);
+		std::copy(portfolios[p].variances.begin(), portfolios[p].variances.end(), batch.variances.begin() + p * dim);
+	});
+
+	// one task per (portfolio, structure)
+	std::vector<MeasurePiece> pieces(batch.size());
+	pool.for_each_index(batch.size(), [&] (std::size_t m) {
+		if (options.cancellation) {
+			options.cancellation->throw_if_stopped();
+		}
+		pieces[m] = merge_piece(portfolios[m / batch.num_structures],
+			batch.monotone_structures.data() + (m % batch.num_structures) * dim, dim, tol);
+	});
+
+	batch.offsets.resize(batch.size() + 1, 0);
+	for (std::size_t m = 0; m < batch.size(); ++m) {
+		batch.offsets[m + 1] = batch.offsets[m] + pieces[m].weights.size();
+	}
+	batch.weights.resize(batch.offsets.back());
+	batch.coords.resize(batch.offsets.back() * dim);
+	pool.for_each_index(batch.size(), [&] (std::size_t m) {
+		std::copy(pieces[m].weights.begin(), pieces[m].weights.end(), batch.weights.begin() + batch.offsets[m]);
+		std::copy(pieces[m].coords.begin(), pieces[m].coords.end(), batch.coords.begin() + batch.offsets[m] * dim);
+	});
+	return batch;
+}
+
+ExtremeMeasureBatch construct_Poisson_ExtremeMeasureBatch(const std::vector<double>& intensities, int dim,
+	unsigned threads, const EJDOptions& options)
+{
+	if (dim <= 0 || intensities.size() % dim != 0) {
+		throw std::invalid_argument("ejd: construct_Poisson_ExtremeMeasureBatch: intensities is not a matrix of dim columns");
+	}
+	ThreadPool pool(threads);
+	return construct_Poisson_ExtremeMeasureBatch(intensities.data(), intensities.size() / dim, dim, pool, options);
+}
+
+// namespace ejd
+}
@@ -0,0 +1,252 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ExtremeMeasureOrbits.hpp"
+// std libs
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Extreme Measure Orbits
+//
+//////////////////////////////////////////////////////////////////////////////
+
+ExtremeMeasureOrbits::ExtremeMeasureOrbits(EmpDistrArray marginals, const EJDOptions& options)
+	: marginals_(std::move(marginals))
+{
+	const int dim = marginals_.dimensions();
+	if (dim < 1 || dim > 31) {
+		throw std::invalid_argument("ExtremeMeasureOrbits: need between 1 and 31 marginals");
+	}
+
+	// groups of identical marginals
+	groups.resize(dim);
+	for (int j = 0; j < dim; ++j) {
+		int g = 0;
+		while (g < static_cast<int>(members.size()) && !(marginals_.marginals[members[g][0]] == marginals_.marginals[j])) {
+			++g;
+		}
+		if (g == static_cast<int>(members.size())) {
+			members.emplace_back();
+		}
+		members[g].push_back(j);
+		groups[j] = g;
+	}
+
+	// one representative per canonical count of antitone marginals
+	const int num_groups = members.size();
+	strides.resize(num_groups + 1);
+	strides[0] = 1;
+	for (int g = 0; g < num_groups; ++g) {
+		strides[g + 1] = strides[g] * (members[g].size() + 1);
+	}
+	representatives.assign(strides[num_groups], -1);
+	mirror = options.arithmetic == EJDArithmetic::floating
+		&& options.coalesce_tol <= 4 * std::numeric_limits<double>::epsilon();
+
+	std::vector<double> means;
+	std::vector<double> variances;
+	marginals_.means_and_variances(&means, &variances);
+	std::vector<int> counts(num_groups);
+	std::vector<int> others(num_groups);
+	std::vector<int> signs(dim);
+	for (std::size_t idx = 0; idx < representatives.size(); ++idx) {
+		for (int g = 0; g < num_groups; ++g) {
+			counts[g] = idx / strides[g] % (members[g].size() + 1);
+			others[g] = members[g].size() - counts[g];
+		}
+		// without the flip, marginal 0 (first of group 0) is comonotone in every structure
+		if (mirror ? others < counts : others[0] == 0) {
+			continue;
+		}
+		for (int g = 0; g < num_groups; ++g) {
+			const int comonotone = others[g];
+			for (int i = 0; i < static_cast<int>(members[g].size()); ++i) {
+				signs[members[g][i]] = i < comonotone ? 1 : -1;
+			}
+		}
+		if (options.cancellation) {
+			options.cancellation->throw_if_stopped();
+		}
+		representatives[idx] = measures_.size();
+		measures_.emplace_back(ejd(marginals_, signs, options));
+		measures_.back().means = means;
+		measures_.back().variances = variances;
+	}
+
+	std::size_t values = 0;
+	for (const auto & m : marginals_.marginals) {
+		values += m.weights.size();
+	}
+	stats_.structures = num_structures();
+	stats_.representatives = measures_.size();
+	stats_.merged_values = stats_.representatives * values;
+	stats_.saved_values = (stats_.structures - stats_.representatives) * values;
+}
+
+int ExtremeMeasureOrbits::dimension() const noexcept
+{
+	return groups.size();
+}
+
+int ExtremeMeasureOrbits::num_structures() const noexcept
+{
+	return groups.empty() ? 0 : 1 << (groups.size() - 1);
+}
+
+int ExtremeMeasureOrbits::num_representatives() const noexcept
+{
+	return measures_.size();
+}
+
+const EmpDistrArray& ExtremeMeasureOrbits::marginals() const noexcept
+{
+	return marginals_;
+}
+
+int ExtremeMeasureOrbits::num_groups() const noexcept
+{
+	return members.size();
+}
+
+int ExtremeMeasureOrbits::group(int j) const noexcept
+{
+	return groups[j];
+}
+
+std::vector<int> ExtremeMeasureOrbits::monotone_structure(int s) const
+{
+	// row r > 0 of column s is antitone iff bit r - 1 of s is set
+	std::vector<int> signs(dimension(), 1);
+	for (int r = 1; r < dimension(); ++r) {
+		if ((s >> (r - 1)) & 1) {
+			signs[r] = -1;
+		}
+	}
+	return signs;
+}
+
+std::vector<int> ExtremeMeasureOrbits::canonical_counts(int s, bool * flip) const
+{
+	const auto signs = monotone_structure(s);
+	std::vector<int> counts(members.size(), 0);
+	std::vector<int> others(members.size());
+	for (std::size_t g = 0; g < members.size(); ++g) {
+		for (int j : members[g]) {
+			counts[g] += signs[j] < 0;
+		}
+		others[g] = members[g].size() - counts[g];
+	}
+	*flip = mirror && others < counts;
+	return *flip ? others : counts;
+}
+
+int ExtremeMeasureOrbits::representative(int s) const
+{
+	bool flip;
+	const auto counts = canonical_counts(s, &flip);
+	std::size_t idx = 0;
+	for (std::size_t g = 0; g < counts.size(); ++g) {
+		idx += counts[g] * strides[g];
+	}
+	return representatives[idx];
+}
+
+bool ExtremeMeasureOrbits::flipped(int s) const
+{
+	bool flip;
+	canonical_counts(s, &flip);
+	return flip;
+}
+
+std::vector<int> ExtremeMeasureOrbits::permutation(int s) const
+{
+	bool flip;
+	const auto counts = canonical_counts(s, &flip);
+	const auto signs = monotone_structure(s);
+	std::vector<int> perm(dimension());
+	for (std::size_t g = 0; g < members.size(); ++g) {
+		// the representative's comonotone members go to those of s in order, and so do the
+		// antitone ones; with every sign flipped they swap roles
+		const int comonotone = members[g].size() - counts[g];
+		int next[2] = {0, comonotone};
+		for (int j : members[g]) {
+			const bool antitone = (signs[j] < 0) != flip;
+			perm[members[g][next[antitone]++]] = j;
+		}
+	}
+	return perm;
+}
+
+const ExtremeMeasure& ExtremeMeasureOrbits::representative_measure(int r) const noexcept
+{
+	return measures_[r];
+}
+
+ExtremeMeasure ExtremeMeasureOrbits::measure(int s) const
+{
+	bool flip;
+	canonical_counts(s, &flip);
+	const auto perm = permutation(s);
+	ExtremeMeasure em = measures_[representative(s)];
+	for (auto & p : em.support) {
+		const auto point = p.point;
+		for (std::size_t j = 0; j < perm.size(); ++j) {
+			p.point[perm[j]] = point[j];
+		}
+	}
+	if (flip) {
+		std::reverse(em.support.begin(), em.support.end());
+		std::reverse(em.weights.begin(), em.weights.end());
+	}
+	em.monotone_structure = monotone_structure(s);
+	return em;
+}
+
+ExtremeMeasures ExtremeMeasureOrbits::measures() const
+{
+	ExtremeMeasures ems;
+	ems.reserve(num_structures());
+	for (int s = 0; s < num_structures(); ++s) {
+		ems.push_back(measure(s));
+	}
+	return ems;
+}
+
+const OrbitStats& ExtremeMeasureOrbits::stats() const noexcept
+{
+	return stats_;
+}
+
+ExtremeMeasureOrbits construct_Poisson_ExtremeMeasureOrbits(const std::vector<double>& intensities,
+	const EJDOptions& options)
+{
+	return ExtremeMeasureOrbits(construct_Poisson_EmpDistrArray(intensities), options);
+}
+
+// namespace ejd
+}
@@ -21,15 +21,19 @@
     DEALINGS IN THE SOFTWARE.
 */
 
+#include "EJDEngine.hpp"
 #include "EmpiricalDistribution.hpp"
 #include "ExtremeMeasures.hpp"
+#include "PointIndex.hpp"
 #include "Utils/AnsiColor.hpp"
-#include "Utils/Enumerate.hpp"
 #include "Utils/PrettyPrint.hpp"
 // 3rd party libs
 #include <blaze/math/Submatrix.h>
 // std libs
 #include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
 
 namespace ejd {
 
@@ -160,30 +164,40 @@ bool LatticePoint::operator==(const LatticePoint &y) const {
 	return true;
 }
 
+// lower dimensions first, then lexicographic; a strict weak ordering, unlike dominance
 bool LatticePoint::operator<(const LatticePoint &y) const {
-
 	if (point.size() != y.point.size()) {
-		return false;
+		return point.size() < y.point.size();
 	}
+	return std::lexicographical_compare(point.begin(), point.end(), y.point.begin(), y.point.end());
+}
 
-	bool prev_coord_less_than = false;
+bool LatticePoint::operator!=(const LatticePoint &y) const {
+	return !(*this == y);
+}
 
-	for (int i = 0; i < point.size(); ++i) {
-		if (point[i] == y.point[i]) {
-			continue;
-		}
-		else if (point[i] < y.point[i]) {
-			if (prev_coord_less_than) {
-				return false;
-			} else {
-				return true;
-			}
+bool dominates(const LatticePoint& x, const LatticePoint& y) {
+	if (x.point.size() != y.point.size() || x == y) {
+		return false;
+	}
+	for (std::size_t i = 0; i < x.point.size(); ++i) {
+		if (x.point[i] < y.point[i]) {
+			return false;
 		}
-		else {
-			prev_coord_less_than = true;
+	}
+	return true;
+}
+
+bool dominates(const LatticePoint& x, const LatticePoint& y, const std::vector<int>& monotone_structure) {
+	if (x.point.size() != y.point.size() || x == y) {
+		return false;
+	}
+	for (std::size_t i = 0; i < x.point.size(); ++i) {
+		if (monotone_structure[i] * x.point[i] < monotone_structure[i] * y.point[i]) {
+			return false;
 		}
 	}
-	return false;
+	return true;
 }
 
 int LatticePoint::dimension() const {
@@ -228,14 +242,41 @@ DiscreteMeasure DiscreteMeasure::operator+(const DiscreteMeasure &other_dm)
 
 DiscreteMeasure& DiscreteMeasure::operator+=(const DiscreteMeasure &other_em)
 {
+	if (other_em.support.empty()) {
+		coalesce();
+		return *this;
+	}
+	if (!support.empty() && dimension() != other_em.dimension()) {
+		throw std::invalid_argument("ejd: cannot add discrete measures of different dimensions");
+	}
+	if (is_sorted() && other_em.is_sorted()) {
+		*this = merge_sorted(*this, other_em);
+		return *this;
+	}
+	// every distinct point of this support, moved to the front under its index
+	FlatPointMap index(other_em.dimension(), support.size() + other_em.size());
+	std::size_t distinct = 0;
+	for (std::size_t i = 0; i < support.size(); ++i) {
+		auto [found, inserted] = index.insert(support[i]);
+		if (!inserted) {
+			weights[found] += weights[i];
+			continue;
+		}
+		if (distinct != i) {
+			support[distinct] = std::move(support[i]);
+			weights[distinct] = weights[i];
+		}
+		++distinct;
+	}
+	support.resize(distinct, LatticePoint({}));
+	weights.resize(distinct);
+
 	for(int i = 0; i < other_em.size(); ++i) {
-		// note : may have to implement custom comparator should numerical issues arise
-		auto found = std::find(std::begin(support), std::end(support), other_em.support[i]);
+		auto [found, inserted] = index.insert(other_em.support[i]);
 
-		if (found != std::end(support)) {
+		if (!inserted) {
 			// found in this support
-			int index = std::distance(std::begin(support),found);
-			weights[index] += other_em.weights[i];
+			weights[found] += other_em.weights[i];
 			continue;
 		}
 		// add point
@@ -257,10 +298,74 @@ int DiscreteMeasure::size() const noexcept {
 	return support.size();
 }
 
-void DiscreteMeasure::sort() noexcept {
-	auto sorted_indices = sort_indices(this->support);	
-	std::sort(this->support.begin(), this->support.end());
-	reorder(this->weights, sorted_indices);
+void DiscreteMeasure::sort() {
+	// sort_indices gives, for each position, the index of the point that belongs there
+	auto sorted_indices = sort_indices(this->support);
+
+	std::vector<LatticePoint> sorted_support;
+	std::vector<double> sorted_weights;
+	sorted_support.reserve(support.size());
+	sorted_weights.reserve(weights.size());
+	for (auto i : sorted_indices) {
+		sorted_support.emplace_back(std::move(support[i]));
+		sorted_weights.push_back(weights[i]);
+	}
+	support = std::move(sorted_support);
+	weights = std::move(sorted_weights);
+}
+
+bool DiscreteMeasure::is_sorted() const noexcept {
+	return std::is_sorted(support.begin(), support.end());
+}
+
+void DiscreteMeasure::coalesce() {
+	if (!is_sorted()) {
+		sort();
+	}
+	std::size_t last = 0;
+	for (std::size_t i = 1; i < support.size(); ++i) {
+		if (support[i] == support[last]) {
+			weights[last] += weights[i];
+		} else if (++last != i) {
+			support[last] = std::move(support[i]);
+			weights[last] = weights[i];
+		}
+	}
+	if (!support.empty()) {
+		support.resize(last + 1, LatticePoint({}));
+		weights.resize(last + 1);
+	}
+}
+
+DiscreteMeasure merge_sorted(const DiscreteMeasure& x, const DiscreteMeasure& y)
+{
+	assert(x.is_sorted() && y.is_sorted());
+
+	DiscreteMeasure merged;
+	merged.support.reserve(x.support.size() + y.support.size());
+	merged.weights.reserve(x.weights.size() + y.weights.size());
+
+	auto push = [&merged] (const LatticePoint& p, double w) {
+		if (!merged.support.empty() && merged.support.back() == p) {
+			merged.weights.back() += w;
+		} else {
+			merged.support.push_back(p);
+			merged.weights.push_back(w);
+		}
+	};
+
+	std::size_t i = 0;
+	std::size_t k = 0;
+	while (i < x.support.size() || k < y.support.size()) {
+		if (k == y.support.size() || (i < x.support.size() && !(y.support[k] < x.support[i]))) {
+			push(x.support[i], x.weights[i]);
+			++i;
+		} else {
+			push(y.support[k], y.weights[k]);
+			++k;
+		}
+	}
+	return merged;
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -318,6 +423,12 @@ std::ostream& operator<<(std::ostream& os, const ExtremeMeasure& em)
 
 // convenience function
 ExtremeMeasures construct_Poisson_ExtremeMeasures(const std::vector<double>& intensities)
+{
+	return construct_Poisson_ExtremeMeasures(intensities, EJDOptions());
+}
+
+ExtremeMeasures construct_Poisson_ExtremeMeasures(const std::vector<double>& intensities,
+	const EJDOptions& options)
 {
 	// construct EmpDistrArray
 	auto poiss_emdistr_array = construct_Poisson_EmpDistrArray(intensities);
@@ -329,17 +440,51 @@ ExtremeMeasures construct_Poisson_ExtremeMeasures(const std::vector<double>& int
 	ExtremeMeasures ems;
 	ems.reserve(num_ms);
 
+	// moments of the truncated marginals the measures are built from
+	std::vector<double> means;
+	std::vector<double> variances;
+	poiss_emdistr_array.means_and_variances(&means, &variances);
+
 	for (int i = 0; i < num_ms; ++i) {
-		ems.emplace_back( ejd( poiss_emdistr_array, ms[i] ) );
-		for(int j = 0; j < intensities.size(); ++j) {
-			const int this_intensity = intensities[j];
-			ems[i].means.push_back(this_intensity);
-			ems[i].variances.push_back(this_intensity);
+		if (options.cancellation) {
+			options.cancellation->throw_if_stopped();
 		}
+		ems.emplace_back( ejd( poiss_emdistr_array, ms[i], options ) );
+		ems[i].means = means;
+		ems[i].variances = variances;
 	}
 	return ems;
 }
 
+//////////////////////////////////////////////////////////////////////////////
+//
+// Extreme Measure View
+//
+//////////////////////////////////////////////////////////////////////////////
+
+LatticePoint ExtremeMeasureView::point(std::size_t i) const
+{
+	std::vector<int> pt(dim);
+	for (int j = 0; j < dim; ++j) {
+		pt[j] = coord(i,j);
+	}
+	return LatticePoint(pt);
+}
+
+ExtremeMeasure ExtremeMeasureView::to_ExtremeMeasure() const
+{
+	ExtremeMeasure em;
+	em.support.reserve(size);
+	for (std::size_t i = 0; i < size; ++i) {
+		em.support.emplace_back(point(i));
+	}
+	em.weights.assign(weights, weights + size);
+	em.monotone_structure.assign(monotone_structure, monotone_structure + dim);
+	em.means.assign(means, means + dim);
+	em.variances.assign(variances, variances + dim);
+	return em;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //
 // Extreme Joint Distribution
@@ -364,7 +509,7 @@ std::vector<std::vector<double>> flip_EmpDistrArray_CDF(
 	std::for_each(
 		marginal_cdf.begin(), marginal_cdf.end(),
 		[] (auto & z) {
-			apply_cumsum(&z);
+			apply_compensated_cumsum(&z);
 		}
 	);
 	return marginal_cdf;
@@ -387,83 +532,48 @@ std::vector<std::vector<double>> flip_supports(
 	return flipped_support;
 }
 
-void ensure_right_tail(std::vector<double> * prob_distr_) {
+void ensure_right_tail(std::vector<double> * prob_distr_, double tol) {
 
 	std::vector<double> & prob_distr = * prob_distr_;
 
-	// note : in essence, machine eps is hard-coded
-	auto indices = std::remove_if(
-		std::begin(prob_distr), std::end(prob_distr),
-		[](double x){
-			return( std::abs(x-1) <= 1e-9);
-		}
-	);
-	prob_distr.erase(indices,std::end(prob_distr));
+	// sorted, so everything within tol of 1 sits at the back
+	while (!prob_distr.empty() && prob_distr.back() >= 1 - tol) {
+		prob_distr.pop_back();
+	}
 	prob_distr.push_back(1.0);
 }
 
-ExtremeMeasure ejd(EmpDistrArray empdistrarrs, std::vector<int> monotone_structs) {
-
-	auto b = ExtremeMeasure();		// so this compiles
-	std::vector<LatticePoint> latticePoints;
-
-	// algorithm works on the cdf
-	// copy the raw marginals and process such that it is consistent with the monotone structure
-	std::vector<std::vector<double>> marginal_cdfs = flip_EmpDistrArray_CDF(empdistrarrs.marginals, monotone_structs);
+JointCDF merge_marginal_cdfs(const std::vector<std::vector<double>>& marginal_cdfs, double tol, EJDStats * stats,
+	unsigned threads)
+{
+	auto joint = basic_merge_marginal_cdfs<double>(marginal_cdfs, {}, tol, stats, threads);
+	return {.breakpoints = std::move(joint.breakpoints), .indices = std::move(joint.indices)};
+}
 
-	std::vector<std::vector<double>> marginal_supports = flip_supports(empdistrarrs.marginals,
-		monotone_structs);
+ExtremeMeasure ejd(EmpDistrArray empdistrarrs, std::vector<int> monotone_structs) {
+	return ejd(empdistrarrs, monotone_structs, EJDOptions());
+}
 
-	std::vector<int> support_lengths;
-	for(auto i : marginal_cdfs) {
-		support_lengths.push_back(i.size());
+ExtremeMeasure ejd(const EmpDistrArray& empdistrarrs, const std::vector<int>& monotone_structs,
+	const EJDOptions& options, EJDStats * stats)
+{
+	if (options.cancellation) {
+		options.cancellation->throw_if_stopped();
 	}
-
-	auto jointcdf = flatten(marginal_cdfs);
-	std::sort(jointcdf.begin(), jointcdf.end());
-	std::unique(jointcdf.begin(), jointcdf.end());
-	ensure_right_tail(&jointcdf);
-	auto support_length = jointcdf.size();
-	
-	// weights of the Extreme Measure can be easily obtained from the combined CDF points
-	// from the marginals CDFs
-	auto weights = jointcdf;
-	std::adjacent_difference(weights.begin(), weights.end(), weights.begin());
-
-	std::vector<LatticePoint> support;
-
-	// find the support of the Extreme Measures
-	// we know the length of the support of the Extreme Measure since the marginals have to be satisfied
-	for (int i = 0; i < support_length; ++i) 
-	{
-		std::vector<int> ith_support;	// ensure that it gets reset each iteration
-
-		for (auto && [marginalcdf_index, marginalcdf_value] : enumerate(marginal_cdfs))
-		{
-			auto temp_jointval = jointcdf[i];
-
-			auto a = std::find_if(
-				marginalcdf_value.begin(), marginalcdf_value.end(),
-				[&](const double marginalcdf_value_){
-					return ( marginalcdf_value_ >= temp_jointval);
-				}
-			);
-			if (a == std::end(marginalcdf_value)) 
-			{
-				// should be the case where all the probabilities from the ith marginal is allocated to the joint measure
-				ith_support.push_back(marginalcdf_value.size());
-			} 
-			else
-			{
-				ith_support.push_back(std::distance(marginalcdf_value.begin(),a));
-			}
-		}
-		for(int i = 0; i < ith_support.size(); ++i) {
-			ith_support[i] = marginal_supports[i][static_cast<int>(ith_support[i])];
-		}
-		support.emplace_back(LatticePoint(ith_support));
+	switch (options.arithmetic) {
+	case EJDArithmetic::fixed64:
+		return fixed_point_ejd<std::uint64_t>(empdistrarrs, monotone_structs, stats, options.threads).to_ExtremeMeasure();
+	case EJDArithmetic::fixed128:
+#ifdef EJD_HAS_UINT128
+		return fixed_point_ejd<uint128_t>(empdistrarrs, monotone_structs, stats, options.threads).to_ExtremeMeasure();
+#else
+		throw std::invalid_argument("ejd: 128-bit fixed point is not supported by this compiler");
+#endif
+	default:
+		break;
 	}
-	return { {.support=support, .weights=weights}, .monotone_structure=monotone_structs};
+	auto em = basic_ejd<double, NeumaierSummation>(empdistrarrs, monotone_structs, options, stats);
+	return { {.support=std::move(em.support), .weights=std::move(em.weights)}, .monotone_structure=monotone_structs};
 }
 // namespace ejd	
 }
@@ -0,0 +1,332 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "HDF5Format.hpp"
+// 3rd party libs
+#include <highfive/H5DataSet.hpp>
+#include <highfive/H5DataSpace.hpp>
+#include <highfive/H5File.hpp>
+#include <highfive/H5Group.hpp>
+#include <highfive/H5PropertyList.hpp>
+// std libs
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+namespace ejd {
+
+namespace h5 = HighFive;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// HDF5 Helper Functions
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// chunk along the last dimension, which is the support for every large dataset
+static h5::DataSetCreateProps chunked_props(const HDF5Options& options, std::vector<hsize_t> dims)
+{
+	h5::DataSetCreateProps props;
+	if (dims.back() == 0) {
+		return props;
+	}
+	dims.back() = std::min<hsize_t>(dims.back(), std::max<std::size_t>(options.chunk_size, 1));
+	props.add(h5::Chunking(dims));
+	if (options.compression_level > 0) {
+		if (options.shuffle) {
+			props.add(h5::Shuffle());
+		}
+		props.add(h5::Deflate(options.compression_level));
+	}
+	return props;
+}
+
+// HDF5 is only thread-safe when built for it, so every HDF5 call of this file, from any
+// writer or reader, is made under this one lock
+static std::mutex& hdf5_mutex()
+{
+	static std::mutex mutex;
+	return mutex;
+}
+
+template <typename T>
+static void write_vector(h5::Group& group, const std::string& name, const std::vector<T>& v,
+	const HDF5Options * chunk_options = nullptr)
+{
+	auto props = chunk_options ? chunked_props(*chunk_options, {v.size()}) : h5::DataSetCreateProps();
+	auto ds = group.createDataSet<T>(name, h5::DataSpace({v.size()}), props);
+	if (!v.empty()) {
+		ds.write(v);
+	}
+}
+
+template <typename T>
+static std::vector<T> read_vector(const h5::Group& group, const std::string& name)
+{
+	std::vector<T> v;
+	auto ds = group.getDataSet(name);
+	if (ds.getElementCount() > 0) {
+		ds.read(v);
+	}
+	return v;
+}
+
+static std::vector<std::vector<int>> support_columns(const ExtremeMeasure& em)
+{
+	const int dim = em.support.empty() ? em.monotone_structure.size() : em.dimension();
+	std::vector<std::vector<int>> columns(dim, std::vector<int>(em.support.size()));
+	for (std::size_t i = 0; i < em.support.size(); ++i) {
+		for (int j = 0; j < dim; ++j) {
+			columns[j][i] = em.support[i].point[j];
+		}
+	}
+	return columns;
+}
+
+static void write_measure(h5::Group& measures, std::size_t index, const ExtremeMeasure& em,
+	const std::vector<std::vector<int>>& columns, const HDF5Options& options)
+{
+	auto group = measures.createGroup(std::to_string(index));
+
+	const std::vector<hsize_t> dims {columns.size(), em.support.size()};
+	auto support = group.createDataSet<int>("support", h5::DataSpace({dims[0], dims[1]}),
+		chunked_props(options, dims));
+	if (dims[0] > 0 && dims[1] > 0) {
+		support.write(columns);
+	}
+
+	write_vector(group, "weights", em.weights, &options);
+	write_vector(group, "monotone_structure", em.monotone_structure);
+	if (!em.means.empty()) {
+		write_vector(group, "means", em.means);
+	}
+	if (!em.variances.empty()) {
+		write_vector(group, "variances", em.variances);
+	}
+}
+
+static void write_marginals(h5::File& file, const EmpDistrArray& marginals, const HDF5Options& options)
+{
+	auto group = file.exist("marginals") ? file.getGroup("marginals") : file.createGroup("marginals");
+	for (int j = 0; j < marginals.dimensions(); ++j) {
+		auto marginal = group.createGroup(std::to_string(j));
+		write_vector(marginal, "weights", marginals.marginals[j].weights, &options);
+		write_vector(marginal, "support", marginals.marginals[j].support, &options);
+	}
+}
+
+static ExtremeMeasure read_measure(const h5::Group& measures, std::size_t i, std::size_t begin, std::size_t count)
+{
+	auto group = measures.getGroup(std::to_string(i));
+
+	ExtremeMeasure em;
+	em.monotone_structure = read_vector<int>(group, "monotone_structure");
+	if (group.exist("means")) {
+		em.means = read_vector<double>(group, "means");
+	}
+	if (group.exist("variances")) {
+		em.variances = read_vector<double>(group, "variances");
+	}
+
+	auto support = group.getDataSet("support");
+	auto weights = group.getDataSet("weights");
+	const auto dims = support.getDimensions();
+	const std::size_t dim = dims[0];
+	const std::size_t length = dims[1];
+
+	begin = std::min(begin, length);
+	count = std::min(count, length - begin);
+	if (dim == 0 || count == 0) {
+		return em;
+	}
+
+	std::vector<std::vector<int>> columns;
+	support.select({0, begin}, {dim, count}).read(columns);
+	weights.select({begin}, {count}).read(em.weights);
+
+	em.support.reserve(count);
+	std::vector<int> point(dim);
+	for (std::size_t k = 0; k < count; ++k) {
+		for (std::size_t j = 0; j < dim; ++j) {
+			point[j] = columns[j][k];
+		}
+		em.support.emplace_back(LatticePoint(point));
+	}
+	return em;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// HDF5 Format
+//
+//////////////////////////////////////////////////////////////////////////////
+
+void write_hdf5(const std::string& path, const EmpDistrArray& marginals, const ExtremeMeasures& ems,
+	const HDF5Options& options)
+{
+	HDF5Writer writer(path, options);
+	writer.write(marginals);
+	for (std::size_t i = 0; i < ems.size(); ++i) {
+		writer.write(i, ems[i]);
+	}
+	writer.flush();
+}
+
+EmpDistrArray read_EmpDistrArray_hdf5(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(hdf5_mutex());
+	h5::File file(path, h5::File::ReadOnly);
+	if (!file.exist("marginals")) {
+		return EmpDistrArray();
+	}
+	auto group = file.getGroup("marginals");
+	const std::size_t dim = group.getNumberObjects();
+
+	std::vector<EmpiricalDistribution> marginals;
+	marginals.reserve(dim);
+	for (std::size_t j = 0; j < dim; ++j) {
+		auto marginal = group.getGroup(std::to_string(j));
+		marginals.emplace_back(EmpiricalDistribution {
+			.weights = read_vector<double>(marginal, "weights"),
+			.support = read_vector<double>(marginal, "support")
+		});
+	}
+	return EmpDistrArray(marginals);
+}
+
+std::size_t num_ExtremeMeasures_hdf5(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(hdf5_mutex());
+	h5::File file(path, h5::File::ReadOnly);
+	return file.exist("measures") ? file.getGroup("measures").getNumberObjects() : 0;
+}
+
+ExtremeMeasures read_ExtremeMeasures_hdf5(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(hdf5_mutex());
+	h5::File file(path, h5::File::ReadOnly);
+	ExtremeMeasures ems;
+	if (!file.exist("measures")) {
+		return ems;
+	}
+	// the indices a writer used need not be contiguous; read them in increasing order
+	auto measures = file.getGroup("measures");
+	std::vector<std::size_t> indices;
+	for (const auto & name : measures.listObjectNames()) {
+		indices.push_back(std::stoull(name));
+	}
+	std::sort(indices.begin(), indices.end());
+	ems.reserve(indices.size());
+	for (auto i : indices) {
+		ems.emplace_back(read_measure(measures, i, 0, hdf5_all));
+	}
+	return ems;
+}
+
+ExtremeMeasures read_ExtremeMeasures_hdf5(const std::string& path, const std::vector<std::size_t>& which)
+{
+	std::lock_guard<std::mutex> lock(hdf5_mutex());
+	h5::File file(path, h5::File::ReadOnly);
+	auto measures = file.getGroup("measures");
+	ExtremeMeasures ems;
+	ems.reserve(which.size());
+	for (auto i : which) {
+		ems.emplace_back(read_measure(measures, i, 0, hdf5_all));
+	}
+	return ems;
+}
+
+ExtremeMeasure read_ExtremeMeasure_hdf5(const std::string& path, std::size_t i, std::size_t begin, std::size_t count)
+{
+	std::lock_guard<std::mutex> lock(hdf5_mutex());
+	h5::File file(path, h5::File::ReadOnly);
+	return read_measure(file.getGroup("measures"), i, begin, count);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// HDF5 Writer
+//
+//////////////////////////////////////////////////////////////////////////////
+
+struct HDF5Writer::Impl
+{
+	Impl(const std::string& path, const HDF5Options& options)
+		: options(options),
+		  file(path, h5::File::ReadWrite | h5::File::Create | h5::File::Truncate),
+		  measures(file.createGroup("measures"))
+	{}
+
+	HDF5Options options;
+	h5::File file;
+	h5::Group measures;
+	std::atomic<std::size_t> next_index {0};
+};
+
+HDF5Writer::HDF5Writer(const std::string& path, const HDF5Options& options)
+{
+	std::lock_guard<std::mutex> lock(hdf5_mutex());
+	impl = std::make_unique<Impl>(path, options);
+}
+
+HDF5Writer::~HDF5Writer()
+{
+	// closing the file is an HDF5 call as well
+	std::lock_guard<std::mutex> lock(hdf5_mutex());
+	impl.reset();
+}
+
+void HDF5Writer::write(const EmpDistrArray& marginals)
+{
+	std::lock_guard<std::mutex> lock(hdf5_mutex());
+	write_marginals(impl->file, marginals, impl->options);
+}
+
+std::size_t HDF5Writer::append(const ExtremeMeasure& em)
+{
+	const std::size_t index = impl->next_index++;
+	write(index, em);
+	return index;
+}
+
+void HDF5Writer::write(std::size_t index, const ExtremeMeasure& em)
+{
+	// keep append() from reusing an index that was written explicitly
+	std::size_t next = impl->next_index.load();
+	while (next <= index && !impl->next_index.compare_exchange_weak(next, index + 1)) {}
+
+	// pack outside the lock so that producers only serialize on the HDF5 calls
+	const auto columns = support_columns(em);
+
+	std::lock_guard<std::mutex> lock(hdf5_mutex());
+	write_measure(impl->measures, index, em, columns, impl->options);
+}
+
+void HDF5Writer::flush()
+{
+	std::lock_guard<std::mutex> lock(hdf5_mutex());
+	impl->file.flush();
+}
+
+// namespace ejd
+}
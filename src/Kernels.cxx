@@ -0,0 +1,420 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Kernels.hpp"
+// std libs
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define EJD_X86_KERNELS 1
+#endif
+
+namespace ejd {
+
+namespace kernels {
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Lane Arithmetic
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#define EJD_INLINE inline __attribute__((always_inline))
+
+// The lane helpers pass vectors wider than the default target by value, but are always inlined
+// into a kernel compiled for a target that has them, so no call ever uses that ABI.
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+template <int W>
+struct VectorTypes;
+
+#define EJD_VECTOR_TYPES(W) \
+	template <> \
+	struct VectorTypes<W> { \
+		typedef double D __attribute__((vector_size(8 * W))); \
+		typedef std::int64_t I __attribute__((vector_size(8 * W))); \
+		typedef int I32 __attribute__((vector_size(4 * W))); \
+	};
+
+EJD_VECTOR_TYPES(2)
+EJD_VECTOR_TYPES(4)
+EJD_VECTOR_TYPES(8)
+
+#undef EJD_VECTOR_TYPES
+
+// W doubles processed together; compiled for whatever target the calling kernel enables
+template <int W>
+struct Lanes
+{
+	using D = typename VectorTypes<W>::D;
+	using I = typename VectorTypes<W>::I;
+	using I32 = typename VectorTypes<W>::I32;
+
+	static EJD_INLINE D load(const double * p) { D v; std::memcpy(&v, p, sizeof(v)); return v; }
+	static EJD_INLINE D load(const int * p) {
+		I32 v;
+		std::memcpy(&v, p, sizeof(v));
+		return __builtin_convertvector(v, D);
+	}
+	static EJD_INLINE D broadcast(double x) { return D{} + x; }
+
+	// the first count < W elements, the other lanes set to fill
+	template <typename T>
+	static EJD_INLINE D load_partial(const T * p, std::size_t count, double fill) {
+		D v = broadcast(fill);
+		for (std::size_t l = 0; l < count; ++l) {
+			v[l] = p[l];
+		}
+		return v;
+	}
+
+	// lanes in order, so the result does not depend on how the compiler shuffles
+	static EJD_INLINE double sum(const D& v) {
+		double s = 0;
+		for (int l = 0; l < W; ++l) {
+			s += v[l];
+		}
+		return s;
+	}
+
+	// N >= 0
+	static EJD_INLINE D pow(const D& base, int N) {
+		D x = base;
+		D result = broadcast(1.);
+		for (; N > 0; N >>= 1) {
+			if (N & 1) {
+				result *= x;
+			}
+			x *= x;
+		}
+		return result;
+	}
+
+	// natural log for x > 0: x = 2^e m with m in [sqrt(1/2), sqrt(2)), log(m) = 2 atanh(z) for
+	// z = (m-1)/(m+1), |z| < 0.172, summed as an odd series to within an ulp
+	static EJD_INLINE D log(const D& arg) {
+		const double min_normal = 2.2250738585072014e-308;
+		const I subnormal = arg < min_normal;
+		const D x = subnormal ? arg * 18014398509481984. : arg;			// 2^54
+
+		I bits = reinterpret_cast<I>(x);
+		I exponent = ((bits >> 52) & 0x7ff) - 1023 - (subnormal & 54);
+		bits = (bits & 0x000fffffffffffffLL) | 0x3ff0000000000000LL;
+		D m = reinterpret_cast<D>(bits);
+
+		const I big = m > 1.4142135623730951;
+		m = big ? m * 0.5 : m;
+		exponent -= big;									// masks are -1
+
+		const D z = (m - 1.) / (m + 1.);
+		const D z2 = z * z;
+		D p = broadcast(1. / 23);
+		p = p * z2 + 1. / 21;
+		p = p * z2 + 1. / 19;
+		p = p * z2 + 1. / 17;
+		p = p * z2 + 1. / 15;
+		p = p * z2 + 1. / 13;
+		p = p * z2 + 1. / 11;
+		p = p * z2 + 1. / 9;
+		p = p * z2 + 1. / 7;
+		p = p * z2 + 1. / 5;
+		p = p * z2 + 1. / 3;
+
+		const D e = __builtin_convertvector(exponent, D);
+		const double ln2_hi = 6.93147180369123816490e-01;
+		const double ln2_lo = 1.90821492927058770002e-10;
+		return e * ln2_hi + (e * ln2_lo + (2 * z + 2 * z * z2 * p));
+	}
+
+	// -w log(w), zero for w <= 0
+	static EJD_INLINE D neg_entropy_term(const D& w) {
+		const I positive = w > 0.;
+		const D safe = positive ? w : broadcast(1.);
+		return positive ? -w * log(safe) : broadcast(0.);
+	}
+};
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Generic Kernels
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// U independent accumulators of W lanes per reduction; the last n % (U W) elements are
+// loaded into zero-padded lanes and added to the first accumulator
+constexpr int accumulators = 4;
+
+template <int W>
+struct Kernel
+{
+	using L = Lanes<W>;
+	using D = typename L::D;
+	static constexpr std::size_t block = accumulators * W;
+
+	static EJD_INLINE double combine(const D (&acc)[accumulators]) {
+		return L::sum((acc[0] + acc[1]) + (acc[2] + acc[3]));
+	}
+
+	// the usual low moments get their power unrolled
+	static EJD_INLINE double nth_moment(const double * w, const double * s, std::size_t n, int N) {
+		switch (N) {
+		case 0: return nth_moment(w, s, n, [] (const D&) { return L::broadcast(1.); });
+		case 1: return nth_moment(w, s, n, [] (const D& x) { return x; });
+		case 2: return nth_moment(w, s, n, [] (const D& x) { return x * x; });
+		case 3: return nth_moment(w, s, n, [] (const D& x) { return x * x * x; });
+		case 4: return nth_moment(w, s, n, [] (const D& x) { const D x2 = x * x; return x2 * x2; });
+		default: return nth_moment(w, s, n, [N] (const D& x) { return L::pow(x, N); });
+		}
+	}
+
+	template <typename Power>
+	static EJD_INLINE double nth_moment(const double * w, const double * s, std::size_t n, Power pow) {
+		D acc[accumulators] = {};
+		std::size_t i = 0;
+		for (; i + block <= n; i += block) {
+			for (int u = 0; u < accumulators; ++u) {
+				acc[u] += L::load(w + i + u * W) * pow(L::load(s + i + u * W));
+			}
+		}
+		for (; i < n; i += W) {
+			const std::size_t count = std::min<std::size_t>(W, n - i);
+			acc[0] += L::load_partial(w + i, count, 0.) * pow(L::load_partial(s + i, count, 0.));
+		}
+		return combine(acc);
+	}
+
+	static EJD_INLINE double entropy(const double * w, std::size_t n) {
+		D acc[accumulators] = {};
+		std::size_t i = 0;
+		for (; i + block <= n; i += block) {
+			for (int u = 0; u < accumulators; ++u) {
+				acc[u] += L::neg_entropy_term(L::load(w + i + u * W));
+			}
+		}
+		for (; i < n; i += W) {
+			const std::size_t count = std::min<std::size_t>(W, n - i);
+			acc[0] += L::neg_entropy_term(L::load_partial(w + i, count, 0.));
+		}
+		return combine(acc);
+	}
+
+	// one accumulator per sum, which already gives four independent chains
+	static EJD_INLINE MomentSums moment_sums(const double * w, const double * s, std::size_t n) {
+		D mass = {}, first = {}, second = {}, ent = {};
+		for (std::size_t i = 0; i < n; i += W) {
+			const std::size_t count = std::min<std::size_t>(W, n - i);
+			const D wi = count == W ? L::load(w + i) : L::load_partial(w + i, count, 0.);
+			const D si = count == W ? L::load(s + i) : L::load_partial(s + i, count, 0.);
+			const D ws = wi * si;
+			mass += wi;
+			first += ws;
+			second += ws * si;
+			ent += L::neg_entropy_term(wi);
+		}
+		return {L::sum(mass), L::sum(first), L::sum(second), L::sum(ent)};
+	}
+
+	static EJD_INLINE double bivariate_expectation(const int * x, const int * y, const double * w, std::size_t n) {
+		D acc[accumulators] = {};
+		std::size_t i = 0;
+		for (; i + block <= n; i += block) {
+			for (int u = 0; u < accumulators; ++u) {
+				const std::size_t k = i + u * W;
+				acc[u] += L::load(w + k) * (L::load(x + k) * L::load(y + k));
+			}
+		}
+		for (; i < n; i += W) {
+			const std::size_t count = std::min<std::size_t>(W, n - i);
+			acc[0] += L::load_partial(w + i, count, 0.)
+				* (L::load_partial(x + i, count, 0.) * L::load_partial(y + i, count, 0.));
+		}
+		return combine(acc);
+	}
+};
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Dispatch
+//
+//////////////////////////////////////////////////////////////////////////////
+
+struct KernelTable
+{
+	KernelISA isa;
+	double (*nth_moment)(const double *, const double *, std::size_t, int);
+	double (*entropy)(const double *, std::size_t);
+	MomentSums (*moment_sums)(const double *, const double *, std::size_t);
+	double (*bivariate_expectation)(const int *, const int *, const double *, std::size_t);
+};
+
+#define EJD_KERNEL_TABLE(name, isa, W, ...) \
+	__VA_ARGS__ double name##_nth_moment(const double * w, const double * s, std::size_t n, int N) \
+		{ return Kernel<W>::nth_moment(w, s, n, N); } \
+	__VA_ARGS__ double name##_entropy(const double * w, std::size_t n) \
+		{ return Kernel<W>::entropy(w, n); } \
+	__VA_ARGS__ MomentSums name##_moment_sums(const double * w, const double * s, std::size_t n) \
+		{ return Kernel<W>::moment_sums(w, s, n); } \
+	__VA_ARGS__ double name##_bivariate_expectation(const int * x, const int * y, const double * w, std::size_t n) \
+		{ return Kernel<W>::bivariate_expectation(x, y, w, n); } \
+	constexpr KernelTable name##_table { \
+		isa, name##_nth_moment, name##_entropy, name##_moment_sums, name##_bivariate_expectation \
+	};
+
+EJD_KERNEL_TABLE(generic, KernelISA::generic, 2)
+#ifdef EJD_X86_KERNELS
+EJD_KERNEL_TABLE(avx2, KernelISA::avx2, 4, __attribute__((target("avx2"))))
+EJD_KERNEL_TABLE(avx512, KernelISA::avx512, 8, __attribute__((target("avx512f"))))
+#endif
+
+#undef EJD_KERNEL_TABLE
+
+bool supported(KernelISA isa)
+{
+	switch (isa) {
+	case KernelISA::generic:
+		return true;
+#ifdef EJD_X86_KERNELS
+	case KernelISA::avx2:
+		return __builtin_cpu_supports("avx2");
+	case KernelISA::avx512:
+		return __builtin_cpu_supports("avx512f");
+#endif
+	default:
+		return false;
+	}
+}
+
+const KernelTable * table_of(KernelISA isa)
+{
+	switch (isa) {
+#ifdef EJD_X86_KERNELS
+	case KernelISA::avx2:
+		return &avx2_table;
+	case KernelISA::avx512:
+		return &avx512_table;
+#endif
+	default:
+		return &generic_table;
+	}
+}
+
+std::atomic<const KernelTable *> active_table {nullptr};
+
+const KernelTable & table()
+{
+	const KernelTable * t = active_table.load(std::memory_order_acquire);
+	if (!t) {
+		t = table_of(best_kernel_isa());
+		active_table.store(t, std::memory_order_release);
+	}
+	return *t;
+}
+
+}	// namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Kernel Selection
+//
+//////////////////////////////////////////////////////////////////////////////
+
+const char * to_string(KernelISA isa)
+{
+	switch (isa) {
+	case KernelISA::avx2:
+		return "avx2";
+	case KernelISA::avx512:
+		return "avx512";
+	default:
+		return "generic";
+	}
+}
+
+KernelISA best_kernel_isa()
+{
+	for (auto isa : {KernelISA::avx512, KernelISA::avx2}) {
+		if (supported(isa)) {
+			return isa;
+		}
+	}
+	return KernelISA::generic;
+}
+
+KernelISA active_kernel_isa()
+{
+	return table().isa;
+}
+
+void set_kernel_isa(KernelISA isa)
+{
+	if (!supported(isa)) {
+		throw std::invalid_argument(std::string("ejd: kernels not supported on this cpu: ") + to_string(isa));
+	}
+	active_table.store(table_of(isa), std::memory_order_release);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Kernels
+//
+//////////////////////////////////////////////////////////////////////////////
+
+double nth_moment(const double * w, const double * s, std::size_t n, int N)
+{
+	if (N < 0) {
+		// the lanes pad the tail with zero atoms, which a negative power would turn into NaN
+		double moment = 0;
+		for (std::size_t i = 0; i < n; ++i) {
+			moment += w[i] * std::pow(s[i], N);
+		}
+		return moment;
+	}
+	return table().nth_moment(w, s, n, N);
+}
+
+double entropy(const double * w, std::size_t n)
+{
+	return table().entropy(w, n);
+}
+
+MomentSums moment_sums(const double * w, const double * s, std::size_t n)
+{
+	return table().moment_sums(w, s, n);
+}
+
+double bivariate_expectation(const int * x, const int * y, const double * w, std::size_t n)
+{
+	return table().bivariate_expectation(x, y, w, n);
+}
+
+}	// namespace kernels
+
+// namespace ejd
+}
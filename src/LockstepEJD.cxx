@@ -0,0 +1,304 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "LockstepEJD.hpp"
+#include "EJDEngine.hpp"
+#include "Utils/Parallel.hpp"
+// std libs
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+namespace ejd {
+
+namespace {
+
+// the lane vectors only ever live inside lockstep_group, which is inlined with them
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+template <int W>
+struct LaneTypes;
+
+#define EJD_LANE_TYPES(W) \
+	template <> \
+	struct LaneTypes<W> { \
+		typedef double D __attribute__((vector_size(8 * W))); \
+		typedef std::int64_t I __attribute__((vector_size(8 * W))); \
+	};
+
+EJD_LANE_TYPES(4)
+EJD_LANE_TYPES(8)
+EJD_LANE_TYPES(16)
+
+#undef EJD_LANE_TYPES
+
+// weights and column-wise coordinates of one measure
+struct LanePiece
+{
+	std::vector<double> weights;
+	std::vector<int> coords;
+};
+
+// basic_ejd<double> on W problems at once; lane l computes problems[l] into pieces[l]
+template <int W>
+void lockstep_group(const EmpDistrArray * const * problems, const std::vector<int>& ms, double tol, LanePiece * pieces)
+{
+	using D = typename LaneTypes<W>::D;
+	using I = typename LaneTypes<W>::I;
+	constexpr double inf = std::numeric_limits<double>::infinity();
+	const int dim = ms.size();
+
+	// cdfs padded to the longest marginal of the group, then an infinite sentinel, stored
+	// lane-interleaved: value i of marginal j in lane l is at (j * stride + i) * W + l
+	std::size_t length = 0;
+	std::vector<std::size_t> lengths(dim * W);
+	std::size_t steps = 0;
+	for (int l = 0; l < W; ++l) {
+		std::size_t total = 0;
+		for (int j = 0; j < dim; ++j) {
+			lengths[j * W + l] = problems[l]->marginals[j].weights.size();
+			length = std::max(length, lengths[j * W + l]);
+			total += lengths[j * W + l];
+		}
+		steps = std::max(steps, total);
+	}
+	const std::size_t stride = length + 1;
+	std::vector<double> cdfs(dim * stride * W);
+	std::vector<double> errors(dim * stride * W);
+
+	// Neumaier sums of all lanes together, as NeumaierSummation does one at a time
+	for (int j = 0; j < dim; ++j)
+	{
+		const bool flip = ms[j] == -1;
+		D sum = D{};
+		D compensation = D{};
+		for (std::size_t i = 0; i < stride; ++i) {
+			D x = D{};
+			D pad = D{};
+			for (int l = 0; l < W; ++l) {
+				const auto & w = problems[l]->marginals[j].weights;
+				const std::size_t n = w.size();
+				x[l] = i < n ? w[flip ? n - 1 - i : i] : 0.;
+				pad[l] = i < n ? 0. : inf;
+			}
+			const D t = sum + x;
+			const I big = (sum < 0 ? -sum : sum) >= (x < 0 ? -x : x);
+			compensation += big ? (sum - t) + x : (x - t) + sum;
+			sum = t;
+			const D value = sum + compensation;
+			const D error = (sum - value) + compensation;
+			for (int l = 0; l < W; ++l) {
+				cdfs[(j * stride + i) * W + l] = value[l] + pad[l];
+				errors[(j * stride + i) * W + l] = error[l];
+			}
+		}
+	}
+
+	auto gather = [&] (const std::vector<double>& a, const I& j, const I& i) {
+		D v;
+		for (int l = 0; l < W; ++l) {
+			v[l] = a[(j[l] * stride + i[l]) * W + l];
+		}
+		return v;
+	};
+
+	std::vector<double> breakpoints[W];
+	std::vector<double> bp_errors[W];
+	std::vector<int> indices[W];
+	for (int l = 0; l < W; ++l) {
+		breakpoints[l].reserve(steps + 1);
+		bp_errors[l].reserve(steps + 1);
+		indices[l].reserve((steps + 1) * dim);
+	}
+
+	// the merge of merge_marginal_cdfs, one value of every lane per step; an exhausted lane
+	// only sees the sentinels and is masked out
+	std::vector<I> position(dim, I{});
+	D anchor = D{};
+	D last = D{};				// value and error of the open breakpoint of each lane
+	D last_error = D{};
+	I open = I{};
+	I tail = I{};
+	for (std::size_t step = 0; step < steps; ++step)
+	{
+		// smallest head, ties broken by marginal
+		I j_min = I{};
+		D head = gather(cdfs, j_min, position[0]);
+		for (int j = 1; j < dim; ++j) {
+			const D h = gather(cdfs, I{} + j, position[j]);
+			const I smaller = h < head;
+			head = smaller ? h : head;
+			j_min = smaller ? I{} + j : j_min;
+		}
+		I i_min;
+		for (int l = 0; l < W; ++l) {
+			i_min[l] = position[j_min[l]][l];
+		}
+		const D error = gather(errors, j_min, i_min);
+
+		const I active = head < inf;
+		const I start = active & ~tail & (head > anchor + tol);
+		const I update = (active & ~start & open & (head >= last)) | start;
+
+		for (int l = 0; l < W; ++l) {
+			if (!start[l]) {
+				continue;
+			}
+			if (open[l]) {
+				breakpoints[l].back() = last[l];
+				bp_errors[l].back() = last_error[l];
+			}
+			breakpoints[l].push_back(head[l]);
+			bp_errors[l].push_back(error[l]);
+			for (int k = 0; k < dim; ++k) {
+				indices[l].push_back(std::min<std::size_t>(position[k][l], lengths[k * W + l] - 1));
+			}
+		}
+
+		last = update ? head : last;
+		last_error = update ? error : last_error;
+		anchor = start ? head : anchor;
+		open |= start;
+		tail |= start & (head >= 1 - tol);
+		for (int j = 0; j < dim; ++j) {
+			position[j] -= (j_min == j) & active;		// masks are -1
+		}
+	}
+
+	for (int l = 0; l < W; ++l)
+	{
+		auto & bp = breakpoints[l];
+		auto & err = bp_errors[l];
+		if (open[l]) {
+			bp.back() = last[l];
+			err.back() = last_error[l];
+		}
+		if (tail[l]) {
+			bp.back() = 1;
+			err.back() = 0;
+		}
+		else {
+			bp.push_back(1);
+			err.push_back(0);
+			for (int j = 0; j < dim; ++j) {
+				indices[l].push_back(lengths[j * W + l] - 1);
+			}
+		}
+
+		const std::size_t n = bp.size();
+		auto & piece = pieces[l];
+		breakpoint_weights(bp, err, &piece.weights);
+		piece.coords.resize(n * dim);
+		for (int j = 0; j < dim; ++j) {
+			const auto & s = problems[l]->marginals[j].support;
+			const bool flip = ms[j] == -1;
+			for (std::size_t i = 0; i < n; ++i) {
+				const std::size_t k = indices[l][i * dim + j];
+				piece.coords[j * n + i] = static_cast<int>(s[flip ? s.size() - 1 - k : k]);
+			}
+		}
+	}
+}
+
+}	// namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Lockstep EJD
+//
+//////////////////////////////////////////////////////////////////////////////
+
+ExtremeMeasureBatch lockstep_ejd(const std::vector<EmpDistrArray>& problems, const std::vector<int>& monotone_structure,
+	const EJDOptions& options, int lanes)
+{
+	if (options.arithmetic != EJDArithmetic::floating) {
+		throw std::invalid_argument("ejd: lockstep_ejd: only floating arithmetic is supported");
+	}
+	if (lanes != 4 && lanes != 8 && lanes != 16) {
+		throw std::invalid_argument("ejd: lockstep_ejd: lanes must be 4, 8 or 16");
+	}
+	const int dim = monotone_structure.size();
+	for (const auto & problem : problems) {
+		if (problem.dimensions() != dim) {
+			throw std::invalid_argument("ejd: lockstep_ejd: problem dimension differs from the monotone structure");
+		}
+		for (const auto & marginal : problem.marginals) {
+			if (marginal.weights.empty() || marginal.weights.size() != marginal.support.size()) {
+				throw std::invalid_argument("ejd: lockstep_ejd: empty or malformed marginal");
+			}
+		}
+	}
+	const double tol = std::max(options.coalesce_tol, 4 * std::numeric_limits<double>::epsilon());
+
+	const std::size_t n = problems.size();
+	ExtremeMeasureBatch batch;
+	batch.dim = dim;
+	batch.num_portfolios = n;
+	batch.num_structures = 1;
+	batch.monotone_structures = monotone_structure;
+	batch.means.reserve(n * dim);
+	batch.variances.reserve(n * dim);
+	for (const auto & problem : problems) {
+		for (const auto & s : problem.summaries()) {
+			batch.means.push_back(s.mean);
+			batch.variances.push_back(s.variance);
+		}
+	}
+
+	// the last group is filled up with copies of the last problem, computed and dropped
+	std::vector<LanePiece> pieces(n);
+	const std::size_t groups = (n + lanes - 1) / lanes;
+	parallel_for(0, groups, options.threads, [&] (std::size_t begin, std::size_t end) {
+		std::vector<const EmpDistrArray *> group(lanes);
+		std::vector<LanePiece> out(lanes);
+		for (std::size_t g = begin; g < end; ++g) {
+			for (int l = 0; l < lanes; ++l) {
+				group[l] = &problems[std::min(g * lanes + l, n - 1)];
+			}
+			switch (lanes) {
+			case 4: lockstep_group<4>(group.data(), monotone_structure, tol, out.data()); break;
+			case 8: lockstep_group<8>(group.data(), monotone_structure, tol, out.data()); break;
+			default: lockstep_group<16>(group.data(), monotone_structure, tol, out.data()); break;
+			}
+			for (int l = 0; l < lanes && g * lanes + l < n; ++l) {
+				pieces[g * lanes + l] = std::move(out[l]);
+			}
+		}
+	}, 1);
+
+	batch.offsets.resize(n + 1, 0);
+	for (std::size_t p = 0; p < n; ++p) {
+		batch.offsets[p + 1] = batch.offsets[p] + pieces[p].weights.size();
+	}
+	batch.weights.resize(batch.offsets.back());
+	batch.coords.resize(batch.offsets.back() * dim);
+	for (std::size_t p = 0; p < n; ++p) {
+		std::copy(pieces[p].weights.begin(), pieces[p].weights.end(), batch.weights.begin() + batch.offsets[p]);
+		std::copy(pieces[p].coords.begin(), pieces[p].coords.end(), batch.coords.begin() + batch.offsets[p] * dim);
+	}
+	return batch;
+}
+
+// namespace ejd
+}
@@ -0,0 +1,173 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MixtureMeasure.hpp"
+// std libs
+#include <cmath>
+#include <stdexcept>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Mixture Measure
+//
+//////////////////////////////////////////////////////////////////////////////
+
+int MixtureMeasure::dimension() const noexcept {
+	return components.empty() ? 0 : components[0]->dimension();
+}
+
+std::size_t MixtureMeasure::size() const noexcept {
+	return components.size();
+}
+
+double MixtureMeasure::total_weight() const noexcept {
+	return std::accumulate(weights.begin(), weights.end(), 0.0);
+}
+
+std::vector<double> MixtureMeasure::moments(int n, unsigned threads) const
+{
+	std::vector<double> result(dimension());
+	for (int j = 0; j < dimension(); ++j) {
+		result[j] = expectation([j, n] (const LatticePoint& p) {
+			return std::pow(static_cast<double>(p.point[j]), n);
+		}, threads);
+	}
+	return result;
+}
+
+std::vector<double> MixtureMeasure::means(unsigned threads) const {
+	return moments(1, threads);
+}
+
+std::vector<double> MixtureMeasure::variances(unsigned threads) const
+{
+	auto result = moments(2, threads);
+	const auto mu = means(threads);
+	for (int j = 0; j < dimension(); ++j) {
+		result[j] -= mu[j] * mu[j];
+	}
+	return result;
+}
+
+double MixtureMeasure::cross_moment(int i, int j, unsigned threads) const
+{
+	return expectation([i, j] (const LatticePoint& p) {
+		return static_cast<double>(p.point[i]) * p.point[j];
+	}, threads);
+}
+
+double MixtureMeasure::covariance(int i, int j, unsigned threads) const
+{
+	const auto mu = means(threads);
+	return cross_moment(i, j, threads) - mu[i] * mu[j];
+}
+
+double MixtureMeasure::correlation(int i, int j, unsigned threads) const
+{
+	const auto sigma2 = variances(threads);
+	return covariance(i, j, threads) / std::sqrt(sigma2[i] * sigma2[j]);
+}
+
+double MixtureMeasure::tail_probability(int j, int k, unsigned threads) const
+{
+	return expectation([j, k] (const LatticePoint& p) {
+		return p.point[j] >= k ? 1.0 : 0.0;
+	}, threads);
+}
+
+double MixtureMeasure::joint_tail_probability(const LatticePoint& x, unsigned threads) const
+{
+	return expectation([&x] (const LatticePoint& p) {
+		for (std::size_t j = 0; j < x.point.size(); ++j) {
+			if (p.point[j] < x.point[j]) {
+				return 0.0;
+			}
+		}
+		return 1.0;
+	}, threads);
+}
+
+DiscreteMeasure MixtureMeasure::materialize(unsigned threads) const
+{
+	// scaled and sorted components, merged in order
+	std::vector<DiscreteMeasure> scaled(size());
+	parallel_for(0, size(), threads, [&] (std::size_t begin, std::size_t end) {
+		for (std::size_t c = begin; c < end; ++c) {
+			scaled[c].support = components[c]->support;
+			scaled[c].weights = components[c]->weights;
+			for (auto & w : scaled[c].weights) {
+				w *= weights[c];
+			}
+			scaled[c].coalesce();
+		}
+	}, 1);
+
+	DiscreteMeasure merged;
+	for (const auto & dm : scaled) {
+		merged = merge_sorted(merged, dm);
+	}
+	return merged;
+}
+
+MixtureMeasure construct_MixtureMeasure(std::vector<std::shared_ptr<const ExtremeMeasure>> components,
+	std::vector<double> weights)
+{
+	if (components.size() != weights.size()) {
+		throw std::invalid_argument("ejd: construct_MixtureMeasure: one weight per component is needed");
+	}
+	for (std::size_t c = 0; c < components.size(); ++c) {
+		if (!components[c] || components[c]->support.empty()) {
+			throw std::invalid_argument("ejd: construct_MixtureMeasure: empty component");
+		}
+		if (components[c]->dimension() != components[0]->dimension()) {
+			throw std::invalid_argument("ejd: construct_MixtureMeasure: components differ in dimension");
+		}
+		if (!(weights[c] >= 0)) {
+			throw std::invalid_argument("ejd: construct_MixtureMeasure: negative mixture weight");
+		}
+	}
+	const double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+	if (!(total > 0)) {
+		throw std::invalid_argument("ejd: construct_MixtureMeasure: the mixture weights add up to zero");
+	}
+	// the functionals take a convex combination
+	for (auto & w : weights) {
+		w /= total;
+	}
+	return MixtureMeasure {.components = std::move(components), .weights = std::move(weights)};
+}
+
+MixtureMeasure construct_MixtureMeasure(const ExtremeMeasures& components, std::vector<double> weights)
+{
+	std::vector<std::shared_ptr<const ExtremeMeasure>> shared;
+	shared.reserve(components.size());
+	for (const auto & em : components) {
+		shared.push_back(std::make_shared<const ExtremeMeasure>(em));
+	}
+	return construct_MixtureMeasure(std::move(shared), std::move(weights));
+}
+
+// namespace ejd
+}
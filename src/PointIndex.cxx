@@ -0,0 +1,179 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "PointIndex.hpp"
+// std libs
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Lattice Point Hash
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// 64-bit finalizer of MurmurHash3
+static inline std::uint64_t mix(std::uint64_t h) noexcept
+{
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+static inline bool fits_16_bits(int x) noexcept
+{
+	return x >= -32768 && x < 32768;
+}
+
+std::size_t LatticePointHash::operator()(const int * coords, int dim) const noexcept
+{
+	if (dim <= 8 && std::all_of(coords, coords + dim, fits_16_bits)) {
+		std::uint64_t packed[2] = {0, 0};
+		for (int j = 0; j < dim; ++j) {
+			packed[j >> 2] |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(coords[j])) << (16 * (j & 3));
+		}
+		// the dimension keeps e.g. (0) and (0,0) apart
+		return mix(packed[0] ^ mix(packed[1] + dim));
+	}
+	std::uint64_t h = 0x9e3779b97f4a7c15ULL ^ static_cast<std::uint64_t>(dim);
+	for (int j = 0; j < dim; ++j) {
+		h = mix(h ^ static_cast<std::uint32_t>(coords[j])) + 0x9e3779b97f4a7c15ULL;
+	}
+	return mix(h);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Flat Point Map
+//
+//////////////////////////////////////////////////////////////////////////////
+
+static constexpr std::uint64_t slot_index_mask = 0xffffffffULL;
+
+FlatPointMap::FlatPointMap(int dim, std::size_t expected_size)
+	: dim(dim)
+{
+	reserve(std::max<std::size_t>(expected_size, 8));
+}
+
+std::size_t FlatPointMap::probe(const int * point, std::uint64_t hash) const
+{
+	const std::uint64_t tag = hash & ~slot_index_mask;
+	for (std::size_t s = hash & mask; ; s = (s + 1) & mask) {
+		const std::uint64_t slot = slots[s];
+		if (slot == 0) {
+			return s;
+		}
+		if ((slot & ~slot_index_mask) == tag) {
+			const std::size_t index = (slot & slot_index_mask) - 1;
+			if (std::memcmp(coords.data() + index * dim, point, dim * sizeof(int)) == 0) {
+				return s;
+			}
+		}
+	}
+}
+
+std::size_t FlatPointMap::find(const int * point) const
+{
+	const std::uint64_t slot = slots[probe(point, LatticePointHash()(point, dim))];
+	return slot == 0 ? npos : (slot & slot_index_mask) - 1;
+}
+
+std::pair<std::size_t, bool> FlatPointMap::insert(const int * point)
+{
+	if (2 * (count + 1) > slots.size()) {
+		rehash(2 * slots.size());
+	}
+	const std::uint64_t hash = LatticePointHash()(point, dim);
+	const std::size_t s = probe(point, hash);
+	if (slots[s] != 0) {
+		return {(slots[s] & slot_index_mask) - 1, false};
+	}
+	if (count >= slot_index_mask) {
+		throw std::length_error("ejd: FlatPointMap holds at most 2^32 - 1 points");
+	}
+	slots[s] = (hash & ~slot_index_mask) | (count + 1);
+	coords.insert(coords.end(), point, point + dim);
+	return {count++, true};
+}
+
+void FlatPointMap::rehash(std::size_t capacity)
+{
+	std::vector<std::uint64_t> old_slots(capacity, 0);
+	old_slots.swap(slots);
+	mask = capacity - 1;
+	for (std::uint64_t slot : old_slots) {
+		if (slot == 0) {
+			continue;
+		}
+		// the stored hash fragment is not enough to place the slot, rehash the point
+		const std::size_t index = (slot & slot_index_mask) - 1;
+		std::size_t s = LatticePointHash()(point(index), dim) & mask;
+		while (slots[s] != 0) {
+			s = (s + 1) & mask;
+		}
+		slots[s] = slot;
+	}
+}
+
+void FlatPointMap::reserve(std::size_t n)
+{
+	std::size_t capacity = 16;
+	while (capacity < 2 * n) {
+		capacity *= 2;
+	}
+	coords.reserve(n * dim);
+	if (capacity > slots.size()) {
+		rehash(capacity);
+	}
+}
+
+void FlatPointMap::clear()
+{
+	std::fill(slots.begin(), slots.end(), 0);
+	coords.clear();
+	count = 0;
+}
+
+std::size_t FlatPointMap::memory_bytes() const
+{
+	return coords.capacity() * sizeof(int) + slots.capacity() * sizeof(std::uint64_t);
+}
+
+FlatPointMap index_support(const std::vector<LatticePoint>& support)
+{
+	FlatPointMap map(support.empty() ? 0 : support[0].dimension(), support.size());
+	for (const auto & p : support) {
+		map.insert(p);
+	}
+	return map;
+}
+
+// namespace ejd
+}
@@ -0,0 +1,157 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "QuantileCoupling.hpp"
+// std libs
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Quantile Coupling
+//
+//////////////////////////////////////////////////////////////////////////////
+
+static QuantileCoupling::Marginal couple_marginal(const EmpiricalDistribution& marginal, bool flip)
+{
+	QuantileCoupling::Marginal m;
+	m.cdf = marginal.weights;
+	m.values.assign(marginal.support.begin(), marginal.support.end());
+	if (flip) {
+		std::reverse(m.cdf.begin(), m.cdf.end());
+		std::reverse(m.values.begin(), m.values.end());
+	}
+	apply_compensated_cumsum(&m.cdf);
+	if (m.cdf.empty()) {
+		throw std::invalid_argument("ejd: construct_QuantileCoupling: empty marginal");
+	}
+	// the tail left out by the truncation goes to the last atom, as in ejd()
+	m.cdf.back() = 1.0;
+
+	const std::size_t n = m.cdf.size();
+	m.guide.resize(n);
+	std::size_t a = 0;
+	for (std::size_t g = 0; g < n; ++g) {
+		const double u = static_cast<double>(g) / n;
+		while (m.cdf[a] < u) {
+			++a;
+		}
+		m.guide[g] = a;
+	}
+	return m;
+}
+
+int QuantileCoupling::dimension() const noexcept {
+	return dim;
+}
+
+std::size_t QuantileCoupling::memory_bytes() const noexcept {
+	std::size_t bytes = sizeof(QuantileCoupling) + monotone_structure.capacity() * sizeof(int);
+	for (const auto & m : marginals) {
+		bytes += sizeof(Marginal)
+			+ m.cdf.capacity() * sizeof(double)
+			+ m.values.capacity() * sizeof(int)
+			+ m.guide.capacity() * sizeof(std::uint32_t);
+	}
+	return bytes;
+}
+
+std::size_t QuantileCoupling::atom(int j, double u) const noexcept
+{
+	const auto & m = marginals[j];
+	// NaN goes to 0 with the negative values
+	u = u > 0 ? std::min(u, 1.0) : 0.0;
+	const std::size_t n = m.guide.size();
+	const std::size_t g = std::min(static_cast<std::size_t>(u * n), n - 1);
+	// cdf[guide[g]] >= g / n, the first atom that can reach u; the cdf ends at 1 so this stops
+	std::size_t a = m.guide[g];
+	while (m.cdf[a] < u) {
+		++a;
+	}
+	return a;
+}
+
+void QuantileCoupling::point(double u, int * out) const noexcept
+{
+	for (int j = 0; j < dim; ++j) {
+		out[j] = marginals[j].values[atom(j,u)];
+	}
+}
+
+LatticePoint QuantileCoupling::point(double u) const
+{
+	std::vector<int> p(dim);
+	point(u, p.data());
+	return LatticePoint(std::move(p));
+}
+
+std::vector<int> QuantileCoupling::points_sorted(const std::vector<double>& us) const
+{
+	if (std::any_of(us.begin(), us.end(), [] (double u) { return std::isnan(u); })) {
+		throw std::invalid_argument("ejd: QuantileCoupling::points_sorted: us has NaN");
+	}
+	if (!std::is_sorted(us.begin(), us.end())) {
+		throw std::invalid_argument("ejd: QuantileCoupling::points_sorted: us is not sorted");
+	}
+	std::vector<int> points(us.size() * dim);
+	for (int j = 0; j < dim; ++j) {
+		const auto & m = marginals[j];
+		std::size_t a = 0;
+		for (std::size_t i = 0; i < us.size(); ++i) {
+			const double u = std::min(us[i], 1.0);
+			while (m.cdf[a] < u) {
+				++a;
+			}
+			points[i * dim + j] = m.values[a];
+		}
+	}
+	return points;
+}
+
+QuantileCoupling construct_QuantileCoupling(const EmpDistrArray& empdistrarrs,
+	const std::vector<int>& monotone_structure)
+{
+	const int dim = empdistrarrs.dimensions();
+	if (monotone_structure.size() != static_cast<std::size_t>(dim)) {
+		throw std::invalid_argument("ejd: construct_QuantileCoupling: the monotone structure needs one entry per marginal");
+	}
+	for (int s : monotone_structure) {
+		if (s != 1 && s != -1) {
+			throw std::invalid_argument("ejd: construct_QuantileCoupling: monotone structure entries must be +1 or -1");
+		}
+	}
+	QuantileCoupling qc;
+	qc.dim = dim;
+	qc.monotone_structure = monotone_structure;
+	qc.marginals.reserve(qc.dim);
+	for (int j = 0; j < qc.dim; ++j) {
+		qc.marginals.push_back(couple_marginal(empdistrarrs.marginals[j], monotone_structure[j] == -1));
+	}
+	return qc;
+}
+
+// namespace ejd
+}
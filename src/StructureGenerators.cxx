@@ -0,0 +1,373 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "StructureGenerators.hpp"
+#include "EJDEngine.hpp"
+// std libs
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace ejd {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Structure Masks
+//
+//////////////////////////////////////////////////////////////////////////////
+
+bool StructureMask::operator==(const StructureMask& y) const {
+	return dim == y.dim && words == y.words;
+}
+
+bool StructureMask::operator!=(const StructureMask& y) const {
+	return !(*this == y);
+}
+
+void StructureMask::set_flipped(int j, bool flip) noexcept
+{
+	const std::uint64_t bit = std::uint64_t(1) << (j & 63);
+	if (flip) {
+		words[j >> 6] |= bit;
+	} else {
+		words[j >> 6] &= ~bit;
+	}
+}
+
+std::vector<int> StructureMask::signs() const
+{
+	std::vector<int> s(dim);
+	for (int j = 0; j < dim; ++j) {
+		s[j] = flipped(j) ? -1 : 1;
+	}
+	return s;
+}
+
+namespace {
+
+// clears the bits past dim in the last word
+void clear_tail(StructureMask * mask)
+{
+	if (mask->dim % 64 != 0) {
+		mask->words.back() &= (std::uint64_t(1) << (mask->dim % 64)) - 1;
+	}
+}
+
+// the mirror image of a structure that flips marginal 0
+void normalize(StructureMask * mask)
+{
+	if (mask->dim > 0 && mask->flipped(0)) {
+		for (auto & w : mask->words) {
+			w = ~w;
+		}
+		clear_tail(mask);
+	}
+}
+
+void reset(StructureMask * mask, int dim)
+{
+	mask->dim = dim;
+	mask->words.assign((dim + 63) / 64, 0);
+}
+
+}	// namespace
+
+StructureMask pack_structure(const std::vector<int>& monotone_structure)
+{
+	StructureMask mask(monotone_structure.size());
+	for (std::size_t j = 0; j < monotone_structure.size(); ++j) {
+		mask.set_flipped(j, monotone_structure[j] == -1);
+	}
+	normalize(&mask);
+	return mask;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Structure Generators
+//
+//////////////////////////////////////////////////////////////////////////////
+
+RandomStructures::RandomStructures(int dim, std::size_t count, std::uint64_t seed)
+	: dim(dim),
+	  remaining(count),
+	  gen(seed)
+{
+	if (dim <= 0) {
+		throw std::invalid_argument("ejd: RandomStructures: the dimension must be positive");
+	}
+}
+
+int RandomStructures::dimension() const noexcept {
+	return dim;
+}
+
+bool RandomStructures::next(StructureMask * mask)
+{
+	if (remaining == 0) {
+		return false;
+	}
+	--remaining;
+	reset(mask, dim);
+	for (auto & w : mask->words) {
+		w = gen();
+	}
+	mask->words[0] &= ~std::uint64_t(1);
+	clear_tail(mask);
+	return true;
+}
+
+SignPatternStructures::SignPatternStructures(int dim, const std::vector<int>& target, std::size_t count,
+	double fidelity, std::uint64_t seed)
+	: dim(dim),
+	  remaining(count),
+	  fidelity(fidelity),
+	  wanted(std::max(dim, 0)),
+	  signs(std::max(dim, 0)),
+	  gen(seed)
+{
+	if (dim <= 0 || target.size() != static_cast<std::size_t>(dim) * dim) {
+		throw std::invalid_argument("ejd: SignPatternStructures: target must be a dim x dim matrix");
+	}
+	if (!(fidelity >= 0 && fidelity <= 1)) {
+		throw std::invalid_argument("ejd: SignPatternStructures: fidelity must be in [0, 1]");
+	}
+	for (int j = 0; j < dim; ++j) {
+		for (int i = 0; i < j; ++i) {
+			const int sign = target[i * dim + j];
+			if (sign < -1 || sign > 1) {
+				throw std::invalid_argument("ejd: SignPatternStructures: target signs must be -1, 0 or 1");
+			}
+			if (sign != 0) {
+				wanted[j].push_back(Wanted {i, sign});
+			}
+		}
+	}
+}
+
+int SignPatternStructures::dimension() const noexcept {
+	return dim;
+}
+
+bool SignPatternStructures::next(StructureMask * mask)
+{
+	if (remaining == 0) {
+		return false;
+	}
+	--remaining;
+	reset(mask, dim);
+
+	std::bernoulli_distribution follow(fidelity);
+	std::bernoulli_distribution coin(0.5);
+	signs[0] = 1;
+	for (int j = 1; j < dim; ++j) {
+		int vote = 0;
+		for (const auto & w : wanted[j]) {
+			vote += w.sign * signs[w.other];
+		}
+		if (vote == 0) {
+			signs[j] = coin(gen) ? 1 : -1;
+		} else {
+			const int side = vote > 0 ? 1 : -1;
+			signs[j] = follow(gen) ? side : -side;
+		}
+		mask->set_flipped(j, signs[j] == -1);
+	}
+	return true;
+}
+
+ExplicitStructures::ExplicitStructures(int dim, std::vector<StructureMask> masks)
+	: dim(dim),
+	  masks(std::move(masks))
+{
+	for (auto & mask : this->masks) {
+		if (mask.dim != dim || mask.words.size() != static_cast<std::size_t>((dim + 63) / 64)) {
+			throw std::invalid_argument("ejd: ExplicitStructures: every mask must have the dimension of the generator");
+		}
+		clear_tail(&mask);
+		normalize(&mask);
+	}
+}
+
+int ExplicitStructures::dimension() const noexcept {
+	return dim;
+}
+
+bool ExplicitStructures::next(StructureMask * mask)
+{
+	if (position == masks.size()) {
+		return false;
+	}
+	*mask = masks[position++];
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Streaming EJD
+//
+//////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// cdfs of the marginals, along their support [0] and flipped [1], summed as basic_ejd<double> does
+struct MarginalCDFs
+{
+	std::vector<std::vector<double>> cdfs[2];
+	std::vector<std::vector<double>> errors[2];
+	std::vector<std::vector<int>> supports[2];
+};
+
+MarginalCDFs marginal_cdfs(const EmpDistrArray& marginals)
+{
+	const int dim = marginals.dimensions();
+	MarginalCDFs m;
+	for (int flip = 0; flip < 2; ++flip) {
+		m.cdfs[flip].resize(dim);
+		m.errors[flip].resize(dim);
+		m.supports[flip].resize(dim);
+		for (int j = 0; j < dim; ++j) {
+			oriented_cdf(marginals.marginals[j], flip, &m.cdfs[flip][j], &m.errors[flip][j], &m.supports[flip][j]);
+		}
+	}
+	return m;
+}
+
+// the cdfs one structure is merged from, in the direction of every marginal in it; the other
+// direction is kept aside and swapped in when the next structure needs it
+struct Slot
+{
+	std::vector<std::vector<double>> cdfs;
+	std::vector<std::vector<double>> errors;
+	std::vector<std::vector<double>> spare_cdfs;
+	std::vector<std::vector<double>> spare_errors;
+	std::vector<bool> flipped;
+	StructureMask mask;
+	// the measure, coordinates column-wise
+	std::vector<int> monotone_structure;
+	std::vector<double> weights;
+	std::vector<int> coords;
+
+	explicit Slot(const MarginalCDFs& m)
+		: cdfs(m.cdfs[0]),
+		  errors(m.errors[0]),
+		  spare_cdfs(m.cdfs[1]),
+		  spare_errors(m.errors[1]),
+		  flipped(m.cdfs[0].size(), false)
+	{}
+};
+
+void merge_slot(Slot& slot, const MarginalCDFs& m, double tol, unsigned threads)
+{
+	const int dim = slot.cdfs.size();
+	for (int j = 0; j < dim; ++j) {
+		if (slot.flipped[j] != slot.mask.flipped(j)) {
+			std::swap(slot.cdfs[j], slot.spare_cdfs[j]);
+			std::swap(slot.errors[j], slot.spare_errors[j]);
+			slot.flipped[j] = !slot.flipped[j];
+		}
+	}
+	const auto joint = basic_merge_marginal_cdfs<double>(slot.cdfs, slot.errors, tol, nullptr, threads);
+	const std::size_t n = joint.breakpoints.size();
+
+	slot.monotone_structure = slot.mask.signs();
+	breakpoint_weights(joint.breakpoints, joint.errors, &slot.weights);
+	slot.coords.resize(n * dim);
+	for (int j = 0; j < dim; ++j) {
+		const auto & support = m.supports[slot.flipped[j]][j];
+		for (std::size_t i = 0; i < n; ++i) {
+			slot.coords[j * n + i] = support[joint.indices[i * dim + j]];
+		}
+	}
+}
+
+std::size_t stream(const EmpDistrArray& marginals, StructureGenerator& structures, const StructureSink& sink,
+	ThreadPool * pool, const EJDOptions& options)
+{
+	if (options.arithmetic != EJDArithmetic::floating) {
+		throw std::invalid_argument("ejd: stream_ejd: only floating arithmetic is supported");
+	}
+	if (structures.dimension() != marginals.dimensions()) {
+		throw std::invalid_argument("ejd: stream_ejd: the structures do not have the dimension of the marginals");
+	}
+	const double tol = std::max(options.coalesce_tol, 4 * std::numeric_limits<double>::epsilon());
+	const auto m = marginal_cdfs(marginals);
+	std::vector<double> means;
+	std::vector<double> variances;
+	marginals.means_and_variances(&means, &variances);
+
+	const std::size_t window = pool ? pool->size() + 1 : 1;
+	std::vector<Slot> slots(window, Slot(m));
+
+	std::size_t k = 0;
+	for (;;) {
+		std::size_t n = 0;
+		while (n < window && structures.next(&slots[n].mask)) {
+			++n;
+		}
+		auto merge = [&] (std::size_t i) {
+			if (options.cancellation) {
+				options.cancellation->throw_if_stopped();
+			}
+			merge_slot(slots[i], m, tol, options.threads);
+		};
+		if (pool) {
+			pool->for_each_index(n, merge);
+		} else if (n > 0) {
+			merge(0);
+		}
+		for (std::size_t i = 0; i < n; ++i) {
+			ExtremeMeasureView em;
+			em.dim = marginals.dimensions();
+			em.size = slots[i].weights.size();
+			em.monotone_structure = slots[i].monotone_structure.data();
+			em.means = means.data();
+			em.variances = variances.data();
+			em.weights = slots[i].weights.data();
+			em.coords = slots[i].coords.data();
+			sink(k++, slots[i].mask, em);
+		}
+		if (n < window) {
+			return k;
+		}
+	}
+}
+
+}	// namespace
+
+std::size_t stream_ejd(const EmpDistrArray& marginals, StructureGenerator& structures, const StructureSink& sink,
+	const EJDOptions& options)
+{
+	return stream(marginals, structures, sink, nullptr, options);
+}
+
+std::size_t stream_ejd(const EmpDistrArray& marginals, StructureGenerator& structures, const StructureSink& sink,
+	ThreadPool& pool, const EJDOptions& options)
+{
+	return stream(marginals, structures, sink, &pool, options);
+}
+
+// namespace ejd
+}
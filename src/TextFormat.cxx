@@ -0,0 +1,305 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "TextFormat.hpp"
+// 3rd party libs
+#include <fmt/format.h>
+// std libs
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+namespace ejd {
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Buffered Sink
+//
+//////////////////////////////////////////////////////////////////////////////
+
+constexpr std::size_t text_buffer_bytes = 1 << 20;
+
+class BufferedSink
+{
+public:
+	explicit BufferedSink(std::FILE * out) : out(out) {}
+
+	void put(char c) { buffer.push_back(c); }
+	void put(const char * s) { buffer.append(s, s + std::strlen(s)); }
+
+	void put(int x) {
+		fmt::format_int f(x);
+		buffer.append(f.data(), f.data() + f.size());
+	}
+
+	void put(double x) {
+		fmt::format_to(std::back_inserter(buffer), "{}", x);
+	}
+
+	// JSON has no representation for nan/inf
+	void put_json(double x) {
+		if (std::isfinite(x)) {
+			put(x);
+		} else {
+			put("null");
+		}
+	}
+
+	void maybe_flush() {
+		if (buffer.size() >= text_buffer_bytes) {
+			flush();
+		}
+	}
+
+	void flush() {
+		if (buffer.size() > 0 && std::fwrite(buffer.data(), 1, buffer.size(), out) != buffer.size()) {
+			throw std::runtime_error(fmt::format("ejd: text output failed: {}", std::strerror(errno)));
+		}
+		buffer.clear();
+	}
+
+private:
+	std::FILE * out;
+	fmt::memory_buffer buffer;
+};
+
+class OutputFile
+{
+public:
+	explicit OutputFile(const std::string& path) : path(path), file(std::fopen(path.c_str(), "w")) {
+		if (!file) {
+			throw std::runtime_error(fmt::format("ejd: cannot open {}: {}", path, std::strerror(errno)));
+		}
+	}
+	// only when close() was not reached, e.g. after an exception
+	~OutputFile() {
+		if (file) {
+			std::fclose(file);
+		}
+	}
+	std::FILE * get() const { return file; }
+	// writes out what the FILE still buffers; errors throw
+	void close() {
+		std::FILE * f = file;
+		file = nullptr;
+		if (std::fclose(f) != 0) {
+			throw std::runtime_error(fmt::format("ejd: cannot close {}: {}", path, std::strerror(errno)));
+		}
+	}
+private:
+	std::string path;
+	std::FILE * file;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Measure Accessors
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// uniform access to owning measures and to column-wise views
+template <typename T>
+struct Span {
+	const T * data;
+	std::size_t size;
+};
+
+template <typename T>
+Span<T> span_of(const std::vector<T>& v) { return {v.data(), v.size()}; }
+
+int dim_of(const ExtremeMeasure& em) {
+	return em.support.empty() ? static_cast<int>(em.monotone_structure.size()) : em.dimension();
+}
+std::size_t size_of(const ExtremeMeasure& em) { return em.support.size(); }
+double weight_of(const ExtremeMeasure& em, std::size_t i) { return em.weights[i]; }
+int coord_of(const ExtremeMeasure& em, std::size_t i, int j) { return em.support[i].point[j]; }
+Span<int> structure_of(const ExtremeMeasure& em) { return span_of(em.monotone_structure); }
+Span<double> means_of(const ExtremeMeasure& em) { return span_of(em.means); }
+Span<double> variances_of(const ExtremeMeasure& em) { return span_of(em.variances); }
+
+int dim_of(const ExtremeMeasureView& em) { return em.dim; }
+std::size_t size_of(const ExtremeMeasureView& em) { return em.size; }
+double weight_of(const ExtremeMeasureView& em, std::size_t i) { return em.weights[i]; }
+int coord_of(const ExtremeMeasureView& em, std::size_t i, int j) { return em.coord(i,j); }
+Span<int> structure_of(const ExtremeMeasureView& em) { return {em.monotone_structure, static_cast<std::size_t>(em.dim)}; }
+Span<double> means_of(const ExtremeMeasureView& em) { return {em.means, static_cast<std::size_t>(em.dim)}; }
+Span<double> variances_of(const ExtremeMeasureView& em) { return {em.variances, static_cast<std::size_t>(em.dim)}; }
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Writers
+//
+//////////////////////////////////////////////////////////////////////////////
+
+template <typename Measure>
+void csv(BufferedSink& sink, const Measure& em)
+{
+	const int dim = dim_of(em);
+	const std::size_t n = size_of(em);
+
+	sink.put("weight");
+	for (int j = 0; j < dim; ++j) {
+		sink.put(",x");
+		sink.put(j);
+	}
+	sink.put('\n');
+
+	for (std::size_t i = 0; i < n; ++i) {
+		sink.put(weight_of(em,i));
+		for (int j = 0; j < dim; ++j) {
+			sink.put(',');
+			sink.put(coord_of(em,i,j));
+		}
+		sink.put('\n');
+		sink.maybe_flush();
+	}
+}
+
+template <typename T>
+void json_array(BufferedSink& sink, Span<T> v)
+{
+	sink.put('[');
+	for (std::size_t i = 0; i < v.size; ++i) {
+		if (i > 0) {
+			sink.put(',');
+		}
+		if constexpr (std::is_floating_point_v<T>) {
+			sink.put_json(v.data[i]);
+		} else {
+			sink.put(v.data[i]);
+		}
+	}
+	sink.put(']');
+}
+
+template <typename Measure>
+void json(BufferedSink& sink, const Measure& em)
+{
+	const int dim = dim_of(em);
+	const std::size_t n = size_of(em);
+
+	sink.put("{\"dimension\":");
+	sink.put(dim);
+	sink.put(",\"monotone_structure\":");
+	json_array(sink, structure_of(em));
+	sink.put(",\"means\":");
+	json_array(sink, means_of(em));
+	sink.put(",\"variances\":");
+	json_array(sink, variances_of(em));
+
+	sink.put(",\"weights\":[");
+	for (std::size_t i = 0; i < n; ++i) {
+		if (i > 0) {
+			sink.put(',');
+		}
+		sink.put_json(weight_of(em,i));
+		sink.maybe_flush();
+	}
+
+	// column at a time, so a column-wise view is read sequentially
+	sink.put("],\"support\":[");
+	for (int j = 0; j < dim; ++j) {
+		sink.put(j > 0 ? ",[" : "[");
+		for (std::size_t i = 0; i < n; ++i) {
+			if (i > 0) {
+				sink.put(',');
+			}
+			sink.put(coord_of(em,i,j));
+			sink.maybe_flush();
+		}
+		sink.put(']');
+	}
+	sink.put("]}");
+}
+
+}	// namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Text Format
+//
+//////////////////////////////////////////////////////////////////////////////
+
+void write_csv(std::FILE * out, const ExtremeMeasure& em)
+{
+	BufferedSink sink(out);
+	csv(sink, em);
+	sink.flush();
+}
+
+void write_csv(std::FILE * out, const ExtremeMeasureView& em)
+{
+	BufferedSink sink(out);
+	csv(sink, em);
+	sink.flush();
+}
+
+void write_csv(const std::string& path, const ExtremeMeasure& em)
+{
+	OutputFile file(path);
+	write_csv(file.get(), em);
+	file.close();
+}
+
+void write_json(std::FILE * out, const ExtremeMeasure& em)
+{
+	BufferedSink sink(out);
+	json(sink, em);
+	sink.flush();
+}
+
+void write_json(std::FILE * out, const ExtremeMeasureView& em)
+{
+	BufferedSink sink(out);
+	json(sink, em);
+	sink.flush();
+}
+
+void write_json(std::FILE * out, const ExtremeMeasures& ems)
+{
+	BufferedSink sink(out);
+	sink.put('[');
+	for (std::size_t i = 0; i < ems.size(); ++i) {
+		if (i > 0) {
+			sink.put(",\n");
+		}
+		json(sink, ems[i]);
+	}
+	sink.put("]\n");
+	sink.flush();
+}
+
+void write_json(const std::string& path, const ExtremeMeasures& ems)
+{
+	OutputFile file(path);
+	write_json(file.get(), ems);
+	file.close();
+}
+
+// namespace ejd
+}
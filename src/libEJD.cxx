@@ -0,0 +1,429 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "libEJD.h"
+#include "Correlation.hpp"
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasureBatch.hpp"
+#include "ExtremeMeasures.hpp"
+#include "QuantileCoupling.hpp"
+#include "Utils/ThreadPool.hpp"
+// std libs
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Handles
+//
+//////////////////////////////////////////////////////////////////////////////
+
+struct ejd_context
+{
+	explicit ejd_context(unsigned threads) : pool(threads) {}
+	ejd::ThreadPool pool;
+	ejd::EJDOptions options;
+};
+
+struct ejd_marginals
+{
+	ejd::EmpDistrArray array;
+};
+
+struct ejd_measure
+{
+	ejd::ExtremeMeasure em;
+};
+
+namespace {
+
+thread_local std::string last_error;
+
+ejd_status fail(ejd_status status, const char * message) noexcept
+{
+	try {
+		last_error = message;
+	} catch (...) {
+		last_error.clear();
+	}
+	return status;
+}
+
+// runs f, turning its exceptions into statuses
+template <typename F>
+ejd_status guarded(F&& f) noexcept
+{
+	try {
+		return f();
+	} catch (const std::invalid_argument& e) {
+		return fail(EJD_INVALID_ARGUMENT, e.what());
+	} catch (const std::domain_error& e) {
+		return fail(EJD_INVALID_ARGUMENT, e.what());
+	} catch (const std::bad_alloc&) {
+		return fail(EJD_OUT_OF_MEMORY, "out of memory");
+	} catch (const std::exception& e) {
+		return fail(EJD_INTERNAL_ERROR, e.what());
+	} catch (...) {
+		return fail(EJD_INTERNAL_ERROR, "unknown exception");
+	}
+}
+
+bool positive_finite(const double * x, std::size_t n)
+{
+	return std::all_of(x, x + n, [] (double v) { return v > 0 && std::isfinite(v); });
+}
+
+// the coordinates of the measures are ints
+bool integral_ints(const double * x, std::size_t n)
+{
+	return std::all_of(x, x + n, [] (double v) {
+		return v >= std::numeric_limits<int>::min() && v <= std::numeric_limits<int>::max() && v == std::trunc(v);
+	});
+}
+
+// dim entries of +1 / -1, or empty for an invalid structure
+std::vector<int> structure_of(const int * monotone_structure, std::size_t dim)
+{
+	if (!monotone_structure || !std::all_of(monotone_structure, monotone_structure + dim,
+			[] (int s) { return s == 1 || s == -1; })) {
+		return {};
+	}
+	return std::vector<int>(monotone_structure, monotone_structure + dim);
+}
+
+// draws per block of ejd_sample, each block with a generator seeded by (seed, block)
+constexpr std::size_t sample_block = 1 << 14;
+
+}	// namespace
+
+extern "C" {
+
+const char * ejd_status_string(ejd_status status)
+{
+	switch (status) {
+	case EJD_OK: return "ok";
+	case EJD_INVALID_ARGUMENT: return "invalid argument";
+	case EJD_BUFFER_TOO_SMALL: return "buffer too small";
+	case EJD_OUT_OF_MEMORY: return "out of memory";
+	case EJD_INTERNAL_ERROR: return "internal error";
+	}
+	return "unknown status";
+}
+
+const char * ejd_last_error(void)
+{
+	return last_error.c_str();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Context
+//
+//////////////////////////////////////////////////////////////////////////////
+
+ejd_status ejd_context_create(unsigned threads, double coalesce_tol, ejd_context ** context)
+{
+	return guarded([&] () {
+		if (!context || !(coalesce_tol >= 0) || !std::isfinite(coalesce_tol)) {
+			return fail(EJD_INVALID_ARGUMENT, "ejd_context_create: null context or bad coalesce_tol");
+		}
+		auto c = new ejd_context(threads);
+		if (coalesce_tol > 0) {
+			c->options.coalesce_tol = coalesce_tol;
+		}
+		*context = c;
+		return EJD_OK;
+	});
+}
+
+void ejd_context_destroy(ejd_context * context)
+{
+	delete context;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Marginals
+//
+//////////////////////////////////////////////////////////////////////////////
+
+ejd_status ejd_marginals_poisson(const double * intensities, size_t dim, ejd_marginals ** marginals)
+{
+	return guarded([&] () {
+		if (!intensities || !marginals || dim == 0 || !positive_finite(intensities, dim)) {
+			return fail(EJD_INVALID_ARGUMENT, "ejd_marginals_poisson: null pointer or non-positive intensity");
+		}
+		auto array = ejd::construct_Poisson_EmpDistrArray(std::vector<double>(intensities, intensities + dim));
+		*marginals = new ejd_marginals {std::move(array)};
+		return EJD_OK;
+	});
+}
+
+ejd_status ejd_marginals_create(size_t dim, const size_t * lengths, const double * weights,
+	const double * support, ejd_marginals ** marginals)
+{
+	return guarded([&] () {
+		if (!lengths || !weights || !support || !marginals || dim == 0) {
+			return fail(EJD_INVALID_ARGUMENT, "ejd_marginals_create: null pointer or zero dimension");
+		}
+		std::vector<ejd::EmpiricalDistribution> distrs;
+		distrs.reserve(dim);
+		std::size_t offset = 0;
+		for (std::size_t j = 0; j < dim; ++j) {
+			const double * w = weights + offset;
+			const double * s = support + offset;
+			const std::size_t n = lengths[j];
+			if (n == 0 || !std::all_of(w, w + n, [] (double x) { return x >= 0 && std::isfinite(x); })
+					|| !std::is_sorted(s, s + n) || std::adjacent_find(s, s + n) != s + n) {
+				return fail(EJD_INVALID_ARGUMENT, "ejd_marginals_create: empty marginal, bad weight or unsorted support");
+			}
+			if (!integral_ints(s, n)) {
+				return fail(EJD_INVALID_ARGUMENT, "ejd_marginals_create: support value that is not an int");
+			}
+			distrs.push_back(ejd::EmpiricalDistribution {
+				.weights = std::vector<double>(w, w + n),
+				.support = std::vector<double>(s, s + n)
+			});
+			offset += n;
+		}
+		*marginals = new ejd_marginals {ejd::EmpDistrArray(distrs)};
+		return EJD_OK;
+	});
+}
+
+void ejd_marginals_destroy(ejd_marginals * marginals)
+{
+	delete marginals;
+}
+
+ejd_status ejd_marginals_dimension(const ejd_marginals * marginals, size_t * dim)
+{
+	if (!marginals || !dim) {
+		return fail(EJD_INVALID_ARGUMENT, "ejd_marginals_dimension: null pointer");
+	}
+	*dim = marginals->array.marginals.size();
+	return EJD_OK;
+}
+
+ejd_status ejd_marginals_moments(const ejd_marginals * marginals, double * means, double * variances)
+{
+	return guarded([&] () {
+		if (!marginals) {
+			return fail(EJD_INVALID_ARGUMENT, "ejd_marginals_moments: null marginals");
+		}
+		const auto & summaries = marginals->array.summaries();
+		for (std::size_t j = 0; j < summaries.size(); ++j) {
+			if (means) {
+				means[j] = summaries[j].mean;
+			}
+			if (variances) {
+				variances[j] = summaries[j].variance;
+			}
+		}
+		return EJD_OK;
+	});
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Monotone Structures
+//
+//////////////////////////////////////////////////////////////////////////////
+
+ejd_status ejd_num_structures(size_t dim, size_t * count)
+{
+	if (!count || dim < 2 || dim > 31) {
+		return fail(EJD_INVALID_ARGUMENT, "ejd_num_structures: null count or dimension out of [2, 31]");
+	}
+	*count = std::size_t(1) << (dim - 1);
+	return EJD_OK;
+}
+
+ejd_status ejd_structure(size_t dim, size_t index, int * monotone_structure)
+{
+	return guarded([&] () {
+		if (!monotone_structure || dim < 2 || dim > 31 || index >= (std::size_t(1) << (dim - 1))) {
+			return fail(EJD_INVALID_ARGUMENT, "ejd_structure: null pointer, dimension out of [2, 31] or index out of range");
+		}
+		const auto ms = ejd::MonotonicityStructure(dim)[index];
+		std::copy(ms.begin(), ms.end(), monotone_structure);
+		return EJD_OK;
+	});
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Extreme Measures
+//
+//////////////////////////////////////////////////////////////////////////////
+
+ejd_status ejd_measure_compute(ejd_context * context, const ejd_marginals * marginals,
+	const int * monotone_structure, ejd_measure ** measure)
+{
+	return guarded([&] () {
+		if (!context || !marginals || !measure) {
+			return fail(EJD_INVALID_ARGUMENT, "ejd_measure_compute: null pointer");
+		}
+		const auto & array = marginals->array;
+		const auto ms = structure_of(monotone_structure, array.marginals.size());
+		if (ms.empty()) {
+			return fail(EJD_INVALID_ARGUMENT, "ejd_measure_compute: monotone structure entries must be +1 or -1");
+		}
+		auto m = std::make_unique<ejd_measure>();
+		m->em = ejd::ejd(array, ms, context->options);
+		array.means_and_variances(&m->em.means, &m->em.variances);
+		*measure = m.release();
+		return EJD_OK;
+	});
+}
+
+void ejd_measure_destroy(ejd_measure * measure)
+{
+	delete measure;
+}
+
+ejd_status ejd_measure_size(const ejd_measure * measure, size_t * size, size_t * dim)
+{
+	if (!measure) {
+		return fail(EJD_INVALID_ARGUMENT, "ejd_measure_size: null measure");
+	}
+	if (size) {
+		*size = measure->em.support.size();
+	}
+	if (dim) {
+		*dim = measure->em.monotone_structure.size();
+	}
+	return EJD_OK;
+}
+
+ejd_status ejd_measure_copy(const ejd_measure * measure, double * weights, size_t weights_capacity,
+	int * coords, size_t coords_capacity)
+{
+	if (!measure) {
+		return fail(EJD_INVALID_ARGUMENT, "ejd_measure_copy: null measure");
+	}
+	const auto & em = measure->em;
+	const std::size_t n = em.support.size();
+	const std::size_t dim = em.monotone_structure.size();
+	if ((weights && weights_capacity < n) || (coords && coords_capacity < n * dim)) {
+		return fail(EJD_BUFFER_TOO_SMALL, "ejd_measure_copy: buffer smaller than the measure");
+	}
+	if (weights) {
+		std::copy(em.weights.begin(), em.weights.end(), weights);
+	}
+	if (coords) {
+		for (std::size_t i = 0; i < n; ++i) {
+			for (std::size_t j = 0; j < dim; ++j) {
+				coords[j * n + i] = em.support[i].point[j];
+			}
+		}
+	}
+	return EJD_OK;
+}
+
+ejd_status ejd_measure_correlation(const ejd_measure * measure, double * correlation)
+{
+	return guarded([&] () {
+		if (!measure || !correlation || measure->em.monotone_structure.size() != 2 || measure->em.support.empty()) {
+			return fail(EJD_INVALID_ARGUMENT, "ejd_measure_correlation: null pointer or not a two-dimensional measure");
+		}
+		*correlation = ejd::correlation(measure->em);
+		return EJD_OK;
+	});
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Correlation Bounds
+//
+//////////////////////////////////////////////////////////////////////////////
+
+ejd_status ejd_correlation_bounds(ejd_context * context, const double * intensities, size_t num_pairs,
+	double * lower, double * upper)
+{
+	return guarded([&] () {
+		if (!context || (num_pairs > 0 && (!intensities || !lower || !upper))) {
+			return fail(EJD_INVALID_ARGUMENT, "ejd_correlation_bounds: null pointer");
+		}
+		if (!positive_finite(intensities, 2 * num_pairs)) {
+			return fail(EJD_INVALID_ARGUMENT, "ejd_correlation_bounds: non-positive intensity");
+		}
+		const auto batch = ejd::construct_Poisson_ExtremeMeasureBatch(intensities, num_pairs, 2,
+			context->pool, context->options);
+		for (std::size_t p = 0; p < num_pairs; ++p) {
+			const double a = ejd::correlation(batch.view(batch.index(p, 0)));
+			const double b = ejd::correlation(batch.view(batch.index(p, 1)));
+			lower[p] = std::min(a, b);
+			upper[p] = std::max(a, b);
+		}
+		return EJD_OK;
+	});
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Samples
+//
+//////////////////////////////////////////////////////////////////////////////
+
+ejd_status ejd_sample(ejd_context * context, const ejd_marginals * marginals, const int * monotone_structure,
+	uint64_t seed, size_t n, int * points, size_t capacity)
+{
+	return guarded([&] () {
+		if (!context || !marginals || (n > 0 && !points)) {
+			return fail(EJD_INVALID_ARGUMENT, "ejd_sample: null pointer");
+		}
+		const std::size_t dim = marginals->array.marginals.size();
+		const auto ms = structure_of(monotone_structure, dim);
+		if (ms.empty()) {
+			return fail(EJD_INVALID_ARGUMENT, "ejd_sample: monotone structure entries must be +1 or -1");
+		}
+		if (capacity < n * dim) {
+			return fail(EJD_BUFFER_TOO_SMALL, "ejd_sample: buffer smaller than n * dim");
+		}
+		const auto coupling = ejd::construct_QuantileCoupling(marginals->array, ms);
+		const std::size_t blocks = (n + sample_block - 1) / sample_block;
+		context->pool.for_each_index(blocks, [&] (std::size_t b) {
+			std::seed_seq seq {
+				static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32),
+				static_cast<std::uint32_t>(b), static_cast<std::uint32_t>(std::uint64_t(b) >> 32)
+			};
+			std::mt19937_64 gen(seq);
+			std::uniform_real_distribution<double> uniform(0.0, 1.0);
+			const std::size_t end = std::min(n, (b + 1) * sample_block);
+			for (std::size_t i = b * sample_block; i < end; ++i) {
+				coupling.point(uniform(gen), points + i * dim);
+			}
+		});
+		return EJD_OK;
+	});
+}
+
+}	// extern "C"
@@ -0,0 +1,147 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "AsyncEJD.hpp"
+#include "Correlation.hpp"
+#include "EJDEngine.hpp"
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasures.hpp"
+// 3rd party
+#include "gtest/gtest.h"
+// std lib
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <vector>
+
+using namespace ejd;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Async EJD Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+static void expect_same(const ExtremeMeasure& em, const ExtremeMeasure& reference)
+{
+    ASSERT_EQ(em.support.size(), reference.support.size());
+    EXPECT_EQ(em.weights, reference.weights);
+    EXPECT_EQ(em.support, reference.support);
+    EXPECT_EQ(em.monotone_structure, reference.monotone_structure);
+    EXPECT_EQ(em.means, reference.means);
+    EXPECT_EQ(em.variances, reference.variances);
+}
+
+TEST(AsyncEJD, MEASURES)
+{
+    AsyncExecutor executor(2);
+    const std::vector<double> intensities {3, 5, 7, 2};
+    auto measures = executor.submit_Poisson_measures(intensities);
+    auto none = executor.submit_measures(construct_Poisson_EmpDistrArray({1}), {});
+    const auto ems = measures.get();
+    const auto reference = construct_Poisson_ExtremeMeasures(intensities);
+    ASSERT_EQ(ems.size(), reference.size());
+    for (std::size_t s = 0; s < ems.size(); ++s) {
+        expect_same(ems[s], reference[s]);
+    }
+    EXPECT_TRUE(none.get().empty());
+}
+
+TEST(AsyncEJD, BOUNDS_AND_SAMPLES)
+{
+    const std::vector<std::pair<double,double>> pairs {{1, 2}, {3, 3}, {0.5, 9}};
+    const auto bounds = shared_executor().submit_correlation_bounds(pairs).get();
+    ASSERT_EQ(bounds.size(), pairs.size());
+    for (std::size_t i = 0; i < pairs.size(); ++i) {
+        EXPECT_EQ(bounds[i], poiss_correlation_bounds_2d(pairs[i].first, pairs[i].second));
+    }
+
+    // the draws only depend on the seed, and are points of the measure
+    const auto marginals = construct_Poisson_EmpDistrArray({2, 4, 3});
+    const std::vector<int> structure {1, -1, 1};
+    const std::size_t n = 2 * AsyncExecutor::sample_block + 100;
+    AsyncExecutor one(1);
+    AsyncExecutor three(3);
+    const auto draws = one.submit_samples(marginals, structure, n, 42).get();
+    EXPECT_EQ(draws, three.submit_samples(marginals, structure, n, 42).get());
+    ASSERT_EQ(draws.size(), n * 3);
+    DiscreteMeasure em = ejd::ejd(marginals, structure, EJDOptions());
+    em.sort();
+    for (std::size_t i = 0; i < n; i += 97) {
+        const LatticePoint p {std::vector<int>(draws.begin() + i * 3, draws.begin() + i * 3 + 3)};
+        EXPECT_TRUE(std::binary_search(em.support.begin(), em.support.end(), p));
+    }
+}
+
+TEST(AsyncEJD, CANCELLATION)
+{
+    // the hook alone: between structures and inside long merges
+    auto cancelled = std::make_shared<CancellationToken>();
+    cancelled->cancel();
+    EJDOptions options;
+    options.cancellation = cancelled.get();
+    EXPECT_THROW(construct_Poisson_ExtremeMeasures({3, 5}, options), EJDCancelled);
+    const std::vector<std::vector<double>> weights(4, std::vector<double>(5000, 1.0 / 5000));
+    EXPECT_THROW(basic_joint_cdf<double>(weights, {1, 1, -1, 1}, options), EJDCancelled);
+
+    AsyncExecutor executor(1);
+    RequestOptions request;
+    request.token = cancelled;
+    EXPECT_THROW(executor.submit_Poisson_measures({3, 5}, request).get(), EJDCancelled);
+    EXPECT_THROW(executor.submit_measures(construct_Poisson_EmpDistrArray({1}), {}, request).get(), EJDCancelled);
+    request.token = std::make_shared<CancellationToken>(CancellationToken::clock::now());
+    EXPECT_THROW(executor.submit_correlation_bounds({{1, 2}}, request).get(), EJDCancelled);
+
+    // cancelled while it runs: the steps left are skipped
+    auto token = std::make_shared<CancellationToken>();
+    request.token = token;
+    auto running = executor.submit_Poisson_measures(std::vector<double>(12, 4.0), request);
+    token->cancel();
+    EXPECT_THROW(running.get(), EJDCancelled);
+    EXPECT_EQ(executor.pending(), 0u);
+}
+
+TEST(AsyncEJD, PRIORITY)
+{
+    // one worker busy with a batch request; the interactive one runs at its next step
+    AsyncExecutor executor(1);
+    auto token = std::make_shared<CancellationToken>();
+    RequestOptions batch;
+    batch.token = token;
+    auto large = executor.submit_Poisson_measures(std::vector<double>(12, 4.0), batch);
+    RequestOptions interactive;
+    interactive.priority = RequestPriority::interactive;
+    const auto small = executor.submit_Poisson_measures({2, 3}, interactive).get();
+    EXPECT_EQ(small.size(), 2u);
+    EXPECT_NE(large.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_GT(executor.pending(), 0u);
+    token->cancel();
+    EXPECT_THROW(large.get(), EJDCancelled);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
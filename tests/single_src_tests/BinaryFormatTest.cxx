@@ -0,0 +1,161 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "BinaryFormat.hpp"
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasures.hpp"
+// 3rd party
+#include "gtest/gtest.h"
+// std lib
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+namespace fs = std::filesystem;
+#include <fstream>
+#include <stdexcept>
+
+using namespace ejd;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Binary Format Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+struct BinaryFormatTest : public ::testing::Test
+{
+    std::vector<double> intensities {3,5,7};
+    EmpDistrArray marginals = construct_Poisson_EmpDistrArray(intensities);
+    ExtremeMeasures pms = construct_Poisson_ExtremeMeasures(intensities);
+    fs::path path = fs::temp_directory_path() / "ejd_binary_format_test.ejd";
+
+    ~BinaryFormatTest() {
+        fs::remove(path);
+    }
+};
+
+TEST_F(BinaryFormatTest, ROUND_TRIP)
+{
+    write_binary(path.string(), marginals, pms);
+    MappedExtremeMeasures mapped(path.string());
+
+    ASSERT_EQ(mapped.size(), pms.size());
+    EXPECT_EQ(mapped.dimension(), 3);
+    EXPECT_TRUE(mapped.marginals() == marginals);
+
+    for (std::size_t i = 0; i < pms.size(); ++i) {
+        auto em = mapped[i].to_ExtremeMeasure();
+        EXPECT_EQ(em.support, pms[i].support);
+        EXPECT_EQ(em.weights, pms[i].weights);
+        EXPECT_EQ(em.monotone_structure, pms[i].monotone_structure);
+        EXPECT_EQ(em.means, pms[i].means);
+        EXPECT_EQ(em.variances, pms[i].variances);
+    }
+}
+
+TEST_F(BinaryFormatTest, COLUMNAR_VIEW)
+{
+    write_binary(path.string(), marginals, pms);
+    MappedExtremeMeasures mapped(path.string());
+
+    auto view = mapped[2];
+    ASSERT_EQ(view.size, pms[2].support.size());
+    for (std::size_t i = 0; i < view.size; ++i) {
+        for (int j = 0; j < view.dimension(); ++j) {
+            EXPECT_EQ(view.column(j)[i], pms[2].support[i].point[j]);
+        }
+    }
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(view.weights) % alignof(double), 0u);
+}
+
+TEST_F(BinaryFormatTest, REJECTS_BAD_FILES)
+{
+    EXPECT_THROW(MappedExtremeMeasures("/nonexistent/ejd.bin"), std::runtime_error);
+
+    std::ofstream(path) << "definitely not an extreme measure file, but long enough to hold a header"
+        << std::string(256, ' ');
+    EXPECT_THROW(MappedExtremeMeasures(path.string()), std::runtime_error);
+}
+
+// rewrites the uint64 at byte offset pos of the file
+static void patch(const fs::path& path, std::uint64_t pos, std::uint64_t value)
+{
+    std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+    f.seekp(pos);
+    f.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static std::uint64_t read_at(const fs::path& path, std::uint64_t pos)
+{
+    std::ifstream f(path, std::ios::binary);
+    f.seekg(pos);
+    std::uint64_t value = 0;
+    f.read(reinterpret_cast<char *>(&value), sizeof(value));
+    return value;
+}
+
+TEST_F(BinaryFormatTest, REJECTS_CORRUPT_LAYOUT)
+{
+    write_binary(path.string(), marginals, pms);
+    BinaryHeader h;
+    {
+        std::ifstream f(path, std::ios::binary);
+        f.read(reinterpret_cast<char *>(&h), sizeof(h));
+    }
+    const auto corrupt = [&] (std::uint64_t pos, std::uint64_t value) {
+        const auto old = read_at(path, pos);
+        patch(path, pos, value);
+        EXPECT_THROW(MappedExtremeMeasures(path.string()), std::runtime_error) << pos << " " << value;
+        patch(path, pos, old);
+        EXPECT_NO_THROW(MappedExtremeMeasures(path.string()));
+    };
+
+    // sizes whose sections overflow or no longer match the file
+    corrupt(offsetof(BinaryHeader, total_points), std::uint64_t(1) << 62);
+    corrupt(offsetof(BinaryHeader, total_points), h.total_points + 1);
+    corrupt(offsetof(BinaryHeader, num_measures), std::uint64_t(-1));
+    corrupt(offsetof(BinaryHeader, marginal_points), h.marginal_points - 1);
+    // a section moved
+    corrupt(offsetof(BinaryHeader, coords), h.coords + 64);
+    // per-measure offsets that do not start at 0, decrease, or miss the total
+    corrupt(h.measure_offsets, 5);
+    corrupt(h.measure_offsets + 2 * sizeof(std::uint64_t), h.total_points + 10);
+    corrupt(h.measure_offsets + h.num_measures * sizeof(std::uint64_t), h.total_points - 1);
+    corrupt(h.marginal_offsets + sizeof(std::uint64_t), h.marginal_points + 1);
+}
+
+TEST_F(BinaryFormatTest, MOVE)
+{
+    write_binary(path.string(), marginals, pms);
+    MappedExtremeMeasures a(path.string());
+    MappedExtremeMeasures b(std::move(a));
+    EXPECT_EQ(b.size(), pms.size());
+    EXPECT_EQ(b.total_points(), pms[0].support.size() + pms[1].support.size()
+        + pms[2].support.size() + pms[3].support.size());
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,98 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "CompressedSupport.hpp"
+#include "ExtremeMeasures.hpp"
+// 3rd party
+#include "gtest/gtest.h"
+// std lib
+#include <vector>
+
+using namespace ejd;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Compressed Support Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+struct CompressedSupportTest : public ::testing::Test
+{
+    ExtremeMeasures pms = construct_Poisson_ExtremeMeasures({3,5,7});
+};
+
+TEST_F(CompressedSupportTest, ROUND_TRIP)
+{
+    for (const auto & em : pms) {
+        auto cs = compress_support(em.support, em.monotone_structure, 4);
+        ASSERT_EQ(cs.size(), em.support.size());
+        EXPECT_EQ(cs.decompress(), em.support);
+    }
+}
+
+TEST_F(CompressedSupportTest, RANDOM_ACCESS)
+{
+    for (const auto & em : pms) {
+        auto cs = compress_support(em.support, em.monotone_structure, 5);
+        for (std::size_t i = 0; i < em.support.size(); ++i) {
+            EXPECT_EQ(cs[i], em.support[i]);
+        }
+    }
+}
+
+TEST_F(CompressedSupportTest, EXTREME_MEASURE_ROUND_TRIP)
+{
+    auto cem = compress(pms[1]);
+    auto em = cem.decompress();
+    EXPECT_EQ(em.support, pms[1].support);
+    EXPECT_EQ(em.weights, pms[1].weights);
+    EXPECT_EQ(em.monotone_structure, pms[1].monotone_structure);
+    EXPECT_LT(cem.support.memory_bytes(), uncompressed_support_bytes(pms[1].support));
+}
+
+// steps that are not a unit move along the structure fall back to checkpoints
+TEST(CompressedSupport, NON_UNIT_STEPS)
+{
+    std::vector<LatticePoint> support {
+        LatticePoint({0,5}), LatticePoint({1,4}), LatticePoint({3,4}),
+        LatticePoint({3,3}), LatticePoint({2,3}), LatticePoint({3,2})
+    };
+    auto cs = compress_support(support, {1,-1}, 64);
+
+    EXPECT_EQ(cs.checkpoint_index, (std::vector<std::size_t>{0,2,4}));
+    EXPECT_EQ(cs.decompress(), support);
+    EXPECT_EQ(cs[3], support[3]);
+}
+
+TEST(CompressedSupport, EMPTY)
+{
+    auto cs = compress_support({}, {}, 8);
+    EXPECT_EQ(cs.size(), 0u);
+    EXPECT_TRUE(cs.begin() == cs.end());
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,172 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ConditionalIndex.hpp"
+#include "ExtremeMeasures.hpp"
+// 3rd party
+#include "gtest/gtest.h"
+// std lib
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using namespace ejd;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Conditional Index Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// the conditional queries by scanning the whole support
+static double scan_pmf(const ExtremeMeasure& em, int j, int k, int i, int m) {
+    double joint = 0, marginal = 0;
+    for (std::size_t p = 0; p < em.support.size(); ++p) {
+        if (em.support[p].point[i] == m) {
+            marginal += em.weights[p];
+            joint += em.support[p].point[j] == k ? em.weights[p] : 0;
+        }
+    }
+    return joint / marginal;
+}
+
+static double scan_cdf(const ExtremeMeasure& em, int j, int k, int i, int m) {
+    double joint = 0, marginal = 0;
+    for (std::size_t p = 0; p < em.support.size(); ++p) {
+        if (em.support[p].point[i] == m) {
+            marginal += em.weights[p];
+            joint += em.support[p].point[j] <= k ? em.weights[p] : 0;
+        }
+    }
+    return joint / marginal;
+}
+
+static double scan_expectation(const ExtremeMeasure& em, int j, int i, int m) {
+    double moment = 0, marginal = 0;
+    for (std::size_t p = 0; p < em.support.size(); ++p) {
+        if (em.support[p].point[i] == m) {
+            marginal += em.weights[p];
+            moment += em.weights[p] * em.support[p].point[j];
+        }
+    }
+    return moment / marginal;
+}
+
+struct ConditionalIndexTest : public ::testing::Test
+{
+    ExtremeMeasures pms = construct_Poisson_ExtremeMeasures({3,5,7});
+};
+
+TEST_F(ConditionalIndexTest, MATCHES_SCAN)
+{
+    for (const auto & em : pms) {
+        auto ci = index_conditionals(em);
+        ASSERT_EQ(ci.size(), em.support.size());
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                for (int m = 0; m < 12; ++m) {
+                    EXPECT_NEAR(ci.conditional_expectation(j,i,m), scan_expectation(em,j,i,m), 1e-9);
+                    for (int k = 0; k < 14; ++k) {
+                        EXPECT_NEAR(ci.conditional_pmf(j,k,i,m), scan_pmf(em,j,k,i,m), 1e-12);
+                        EXPECT_NEAR(ci.conditional_cdf(j,k,i,m), scan_cdf(em,j,k,i,m), 1e-12);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_F(ConditionalIndexTest, PROBABILITY)
+{
+    const auto & em = pms[2];
+    auto ci = index_conditionals(em);
+    for (int i = 0; i < 3; ++i) {
+        double total = 0;
+        for (int m = 0; m < 40; ++m) {
+            total += ci.probability(i,m);
+        }
+        EXPECT_NEAR(total, 1.0, 1e-12);
+    }
+    EXPECT_EQ(ci.probability(0,-1), 0.0);
+    EXPECT_TRUE(std::isnan(ci.conditional_expectation(1,0,-1)));
+    EXPECT_TRUE(std::isnan(ci.conditional_pmf(1,0,0,1000)));
+}
+
+TEST_F(ConditionalIndexTest, BATCH_MATCHES_SINGLE)
+{
+    const std::vector<int> ms {7, 0, 3, 1000, 3, -2, 11, 5};
+    for (const auto & em : pms) {
+        auto ci = index_conditionals(em);
+        auto runs = ci.find_runs(1, ms);
+        auto expectations = ci.conditional_expectation(2, 1, ms);
+        auto pmfs = ci.conditional_pmf(0, 4, 1, ms);
+        auto cdfs = ci.conditional_cdf(0, 4, 1, ms);
+        for (std::size_t q = 0; q < ms.size(); ++q) {
+            EXPECT_EQ(runs[q], ci.find_run(1, ms[q]));
+            if (runs[q] == ConditionalIndex::npos) {
+                EXPECT_TRUE(std::isnan(expectations[q]));
+                continue;
+            }
+            EXPECT_EQ(expectations[q], ci.conditional_expectation(2, 1, ms[q]));
+            EXPECT_EQ(pmfs[q], ci.conditional_pmf(0, 4, 1, ms[q]));
+            EXPECT_EQ(cdfs[q], ci.conditional_cdf(0, 4, 1, ms[q]));
+        }
+    }
+}
+
+TEST_F(ConditionalIndexTest, VIEW)
+{
+    const auto & em = pms[3];
+    std::vector<int> coords;
+    for (int j = 0; j < 3; ++j) {
+        for (const auto & p : em.support) {
+            coords.push_back(p.point[j]);
+        }
+    }
+    ExtremeMeasureView view;
+    view.dim = 3;
+    view.size = em.support.size();
+    view.monotone_structure = em.monotone_structure.data();
+    view.weights = em.weights.data();
+    view.coords = coords.data();
+
+    auto from_em = index_conditionals(em);
+    auto from_view = index_conditionals(view);
+    EXPECT_EQ(from_view.coords, from_em.coords);
+    EXPECT_EQ(from_view.conditional_expectation(0, 2, 4), from_em.conditional_expectation(0, 2, 4));
+}
+
+TEST(ConditionalIndex, NOT_A_CHAIN)
+{
+    ExtremeMeasure em;
+    em.support = {LatticePoint({0,0}), LatticePoint({1,1}), LatticePoint({0,2})};
+    em.weights = {0.25, 0.5, 0.25};
+    em.monotone_structure = {1,1};
+    EXPECT_THROW(index_conditionals(em), std::invalid_argument);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -82,6 +82,41 @@ TEST(Poiss_correlation_bounds_2d, Poiss_correlation_bounds_2d) {
     EXPECT_NEAR(bounds.second, -0.9387482567435699,1e-3);
 }
 
+TEST(Poiss_correlation_bounds_2d, DUAL_VALUES)
+{
+    for (auto [l1, l2] : std::vector<std::pair<double,double>> {{3, 5}, {0.5, 12}, {7, 7}, {40, 2.5}}) {
+        const auto bounds = ejd::poiss_correlation_bounds_2d(l1, l2);
+        const auto plain = ejd::basic_poiss_correlation_bounds_2d(l1, l2);
+        const auto dual = ejd::basic_poiss_correlation_bounds_2d(Dual<2>::variable(l1, 0), Dual<2>::variable(l2, 1));
+        EXPECT_NEAR(plain.first, bounds.first, 1e-12);
+        EXPECT_NEAR(plain.second, bounds.second, 1e-12);
+        EXPECT_EQ(dual.first.value, plain.first);
+        EXPECT_EQ(dual.second.value, plain.second);
+    }
+}
+
+TEST(Poiss_correlation_bounds_2d, DUAL_GRADIENTS)
+{
+    // central differences of the double bounds, small enough to keep the support and breakpoints
+    const double h = 1e-6;
+    for (auto [l1, l2] : std::vector<std::pair<double,double>> {{3, 5}, {0.5, 12}, {7.3, 6.8}, {40, 2.5}}) {
+        const auto dual = ejd::basic_poiss_correlation_bounds_2d(Dual<2>::variable(l1, 0), Dual<2>::variable(l2, 1));
+        const auto up1 = ejd::basic_poiss_correlation_bounds_2d(l1 + h, l2);
+        const auto down1 = ejd::basic_poiss_correlation_bounds_2d(l1 - h, l2);
+        const auto up2 = ejd::basic_poiss_correlation_bounds_2d(l1, l2 + h);
+        const auto down2 = ejd::basic_poiss_correlation_bounds_2d(l1, l2 - h);
+        EXPECT_NEAR(dual.first.grad[0], (up1.first - down1.first) / (2 * h), 1e-6);
+        EXPECT_NEAR(dual.second.grad[0], (up1.second - down1.second) / (2 * h), 1e-6);
+        EXPECT_NEAR(dual.first.grad[1], (up2.first - down2.first) / (2 * h), 1e-6);
+        EXPECT_NEAR(dual.second.grad[1], (up2.second - down2.second) / (2 * h), 1e-6);
+    }
+
+    // a single direction, here along equal intensities
+    const auto along = ejd::basic_poiss_correlation_bounds_2d(Dual<1>::variable(4, 0), Dual<1>::variable(4, 0));
+    const auto both = ejd::basic_poiss_correlation_bounds_2d(Dual<2>::variable(4, 0), Dual<2>::variable(4, 1));
+    EXPECT_NEAR(along.second.grad[0], both.second.grad[0] + both.second.grad[1], 1e-12);
+}
+
 int main(int argc, char **argv)
 {
     /* code */
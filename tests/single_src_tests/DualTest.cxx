@@ -0,0 +1,85 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Dual.hpp"
+// gtest
+#include "gtest/gtest.h"
+// std libs
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <vector>
+
+using namespace ejd;
+
+TEST(Dual, ARITHMETIC)
+{
+    const auto x = Dual<2>::variable(3, 0);
+    const auto y = Dual<2>::variable(0.5, 1);
+
+    // f(x, y) = (x y + 2) / (x - y) - 3 x
+    const auto f = (x * y + 2) / (x - y) - 3 * x;
+    const double fx = (0.5 * 2.5 - 3.5) / (2.5 * 2.5) - 3;
+    const double fy = (3 * 2.5 + 3.5) / (2.5 * 2.5);
+    EXPECT_DOUBLE_EQ(f.value, 3.5 / 2.5 - 9);
+    EXPECT_DOUBLE_EQ(f.grad[0], fx);
+    EXPECT_DOUBLE_EQ(f.grad[1], fy);
+
+    const auto g = 1 - x / 2.;
+    EXPECT_DOUBLE_EQ(g.value, -0.5);
+    EXPECT_DOUBLE_EQ(g.grad[0], -0.5);
+    EXPECT_EQ(g.grad[1], 0);
+}
+
+TEST(Dual, FUNCTIONS)
+{
+    const auto x = Dual<1>::variable(2, 0);
+    EXPECT_DOUBLE_EQ(exp(x).grad[0], std::exp(2.));
+    EXPECT_DOUBLE_EQ(log(x).grad[0], 0.5);
+    EXPECT_DOUBLE_EQ(sqrt(x).grad[0], 0.5 / std::sqrt(2.));
+    EXPECT_DOUBLE_EQ(abs(-x).value, 2);
+    EXPECT_DOUBLE_EQ(abs(-x).grad[0], 1);
+    // exp(log(x)) = x
+    EXPECT_DOUBLE_EQ(exp(log(x)).grad[0], 1);
+}
+
+TEST(Dual, ORDERED_BY_VALUE)
+{
+    // a heap of duals pops them in the order of their values, whatever their derivatives
+    using Head = std::pair<Dual<1>,int>;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    heads.emplace(Dual<1>(0.5, {3}), 0);
+    heads.emplace(Dual<1>(0.25, {-1}), 1);
+    heads.emplace(Dual<1>(0.5, {7}), 2);
+    EXPECT_EQ(heads.top().second, 1);
+    heads.pop();
+    EXPECT_EQ(heads.top().second, 0);
+    EXPECT_TRUE(Dual<1>(0.5, {3}) == Dual<1>(0.5, {7}));
+    EXPECT_TRUE(Dual<1>(0.25, {9}) < Dual<1>(0.5));
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
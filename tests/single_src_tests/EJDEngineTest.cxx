@@ -0,0 +1,288 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+#include "EJDEngine.hpp"
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasures.hpp"
+// 3rd party
+#include "gtest/gtest.h"
+// std lib
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace ejd;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// EJD Engine Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+struct EJDEngineTest : public ::testing::Test
+{
+    EmpDistrArray marginals = construct_Poisson_EmpDistrArray({3,5,7});
+    std::vector<int> ms {1,-1,1};
+};
+
+template <typename Scalar, typename Policy>
+void expect_valid(const EmpDistrArray& marginals, const std::vector<int>& ms)
+{
+    auto em = basic_ejd<Scalar, Policy>(marginals, ms);
+    auto reference = ejd::ejd(marginals, ms);
+    Scalar sum = 0;
+    for (Scalar w : em.weights) {
+        EXPECT_GT(w, 0);
+        sum += w;
+    }
+    EXPECT_NEAR(sum, 1, 64 * std::numeric_limits<Scalar>::epsilon());
+    EXPECT_EQ(em.monotone_structure, ms);
+    // lower precision can only fold more breakpoints
+    EXPECT_LE(em.size(), reference.size());
+}
+
+TEST_F(EJDEngineTest, ALL_INSTANTIATIONS)
+{
+    expect_valid<float, NaiveSummation>(marginals, ms);
+    expect_valid<float, NeumaierSummation>(marginals, ms);
+    expect_valid<double, NaiveSummation>(marginals, ms);
+    expect_valid<double, NeumaierSummation>(marginals, ms);
+    expect_valid<long double, NaiveSummation>(marginals, ms);
+    expect_valid<long double, NeumaierSummation>(marginals, ms);
+}
+
+TEST_F(EJDEngineTest, DOUBLE_MATCHES_EJD)
+{
+    auto em = basic_ejd<double>(marginals, ms).to_ExtremeMeasure();
+    auto reference = ejd::ejd(marginals, ms);
+    EXPECT_EQ(em.support, reference.support);
+    EXPECT_EQ(em.weights, reference.weights);
+}
+
+TEST_F(EJDEngineTest, LONG_DOUBLE_AGREES)
+{
+    auto em = basic_ejd<long double>(marginals, ms);
+    auto reference = ejd::ejd(marginals, ms);
+    ASSERT_EQ(em.support, reference.support);
+    for (int i = 0; i < em.size(); ++i) {
+        EXPECT_NEAR(em.weights[i], reference.weights[i], 1e-15);
+    }
+}
+
+TEST_F(EJDEngineTest, COMPENSATION_REDUCES_ERROR)
+{
+    // many small atoms: the naive float cdf drifts away from the exact one
+    std::vector<double> w(20000, 1. / 20000);
+    std::vector<double> support(w.size());
+    std::iota(support.begin(), support.end(), 0);
+    EmpDistrArray uniform({EmpiricalDistribution {.weights = w, .support = support}});
+
+    auto max_error = [&w] (const auto & em) {
+        double error = 0;
+        for (std::size_t i = 0; i + 1 < em.weights.size(); ++i) {
+            error = std::max(error, std::abs(static_cast<double>(em.weights[i]) - w[i]));
+        }
+        return error;
+    };
+    auto naive = basic_ejd<float, NaiveSummation>(uniform, {1});
+    auto compensated = basic_ejd<float, NeumaierSummation>(uniform, {1});
+    ASSERT_EQ(compensated.size(), w.size());
+    EXPECT_LT(max_error(compensated), 1e-3 * max_error(naive));
+}
+
+TEST(BasicMergeMarginalCDFs, CARRIES_ERRORS)
+{
+    std::vector<std::vector<double>> cdfs {{0.25, 0.5, 1.0}, {0.5, 1.0}};
+    std::vector<std::vector<double>> errors {{1e-18, 2e-18, 0.}, {3e-18, 0.}};
+    auto joint = basic_merge_marginal_cdfs<double>(cdfs, errors, 1e-12);
+    EXPECT_EQ(joint.breakpoints, (std::vector<double>{0.25, 0.5, 1.0}));
+    EXPECT_EQ(joint.errors, (std::vector<double>{1e-18, 3e-18, 0.}));
+}
+
+TEST_F(EJDEngineTest, WEIGHTS_FROM_ORIENTED_CDFS)
+{
+    // the helpers put together give what basic_ejd does
+    std::vector<std::vector<double>> cdfs(3);
+    std::vector<std::vector<double>> errors(3);
+    std::vector<std::vector<int>> supports(3);
+    for (int j = 0; j < 3; ++j) {
+        oriented_cdf(marginals.marginals[j], ms[j] == -1, &cdfs[j], &errors[j], &supports[j]);
+        EXPECT_EQ(supports[j].front(), ms[j] == -1 ? marginals.marginals[j].support.back() : 0);
+    }
+    auto joint = basic_merge_marginal_cdfs<double>(cdfs, errors, EJDOptions().coalesce_tol);
+    std::vector<double> weights;
+    breakpoint_weights(joint.breakpoints, joint.errors, &weights);
+    EXPECT_EQ(weights, (basic_ejd<double, NeumaierSummation>(marginals, ms).weights));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Fixed-Point EJD Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+TEST(FixedPoint, TO_FIXED_POINT)
+{
+    using U = std::uint64_t;
+    EXPECT_EQ(to_fixed_point<U>(0.), 0u);
+    EXPECT_EQ(to_fixed_point<U>(-1.), 0u);
+    EXPECT_EQ(to_fixed_point<U>(1.), U(1) << 63);
+    EXPECT_EQ(to_fixed_point<U>(1.5), U(1) << 63);
+    EXPECT_EQ(to_fixed_point<U>(0.5), U(1) << 62);
+    EXPECT_EQ(to_fixed_point<U>(0.75), U(3) << 61);
+    EXPECT_EQ(to_fixed_point<U>(std::ldexp(1., -63)), 1u);
+    EXPECT_EQ(to_fixed_point<U>(std::ldexp(1., -64)), 1u);     // rounds half up
+    EXPECT_EQ(to_fixed_point<U>(std::ldexp(1., -66)), 0u);
+    // doubles below 1 have more bits than fit: rounded to nearest
+    const double c = 1. - std::ldexp(1., -53);
+    EXPECT_EQ(to_fixed_point<U>(c), (U(1) << 63) - (U(1) << 10));
+#ifdef EJD_HAS_UINT128
+    // exact for 128 bits
+    for (double x : {0.1, 1e-20, 0.999999999999}) {
+        EXPECT_EQ(std::ldexp(static_cast<long double>(to_fixed_point<uint128_t>(x)), -127), x);
+    }
+#endif
+}
+
+template <typename UInt>
+void expect_exact(const EmpDistrArray& marginals, const std::vector<int>& ms)
+{
+    auto em = fixed_point_ejd<UInt>(marginals, ms);
+    UInt sum = 0;
+    for (UInt w : em.weights) {
+        EXPECT_GT(w, UInt(0));
+        sum += w;
+    }
+    EXPECT_TRUE(sum == FixedPointExtremeMeasure<UInt>::one);
+
+    // same points as the floating-point merge, weights within its rounding
+    auto reference = ejd::ejd(marginals, ms);
+    auto converted = em.to_ExtremeMeasure();
+    ASSERT_EQ(converted.support, reference.support);
+    for (int i = 0; i < em.size(); ++i) {
+        EXPECT_NEAR(converted.weights[i], reference.weights[i], 1e-15);
+    }
+}
+
+TEST_F(EJDEngineTest, FIXED_POINT_EXACT)
+{
+    expect_exact<std::uint64_t>(marginals, ms);
+#ifdef EJD_HAS_UINT128
+    expect_exact<uint128_t>(marginals, ms);
+#endif
+}
+
+TEST_F(EJDEngineTest, FIXED_POINT_OPTION)
+{
+    EJDOptions options;
+    options.arithmetic = EJDArithmetic::fixed64;
+    EJDStats stats;
+    auto em = ejd::ejd(marginals, ms, options, &stats);
+    EXPECT_EQ(em.support, fixed_point_ejd<std::uint64_t>(marginals, ms).support);
+    EXPECT_EQ(em.monotone_structure, ms);
+    EXPECT_EQ(stats.breakpoints - stats.folded, em.size());
+}
+
+TEST(FixedPoint, IDENTICAL_MARGINALS_FOLD_EXACTLY)
+{
+    auto marginals = construct_Poisson_EmpDistrArray({4,4});
+    auto em = fixed_point_ejd<std::uint64_t>(marginals, {1,1});
+    EXPECT_EQ(em.size(), marginals.marginals[0].weights.size());
+    for (const auto & p : em.support) {
+        EXPECT_EQ(p.point[0], p.point[1]);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Parallel Merge Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// dim random cdfs of n values each, ending at 1
+static std::vector<std::vector<double>> random_cdfs(int dim, std::size_t n, unsigned seed)
+{
+    std::mt19937_64 gen(seed);
+    std::exponential_distribution<double> spacing(1.0);
+    std::vector<std::vector<double>> cdfs(dim, std::vector<double>(n));
+    for (auto & cdf : cdfs) {
+        std::generate(cdf.begin(), cdf.end(), [&, total = 0.0] () mutable {
+            return total += spacing(gen);
+        });
+        const double last = cdf.back();
+        for (auto & c : cdf) {
+            c /= last;
+        }
+        cdf.back() = 1.0;
+    }
+    return cdfs;
+}
+
+TEST(ParallelMerge, MATCHES_SEQUENTIAL)
+{
+    const auto cdfs = random_cdfs(6, 40000, 3);
+    for (double tol : {1e-12, 1e-7, 1e-5}) {
+        EJDStats sequential_stats, parallel_stats;
+        auto sequential = basic_merge_marginal_cdfs<double>(cdfs, {}, tol, &sequential_stats, 1);
+        for (unsigned threads : {2u, 3u, 8u}) {
+            auto parallel = basic_merge_marginal_cdfs<double>(cdfs, {}, tol, &parallel_stats, threads);
+            EXPECT_EQ(parallel.breakpoints, sequential.breakpoints) << "tol " << tol << ", threads " << threads;
+            EXPECT_EQ(parallel.indices, sequential.indices);
+            EXPECT_EQ(parallel_stats.folded, sequential_stats.folded);
+        }
+    }
+}
+
+// no gaps wider than tol: the merge cannot be cut and stays in one piece
+TEST(ParallelMerge, NO_GAPS)
+{
+    const auto cdfs = random_cdfs(4, 40000, 5);
+    auto sequential = merge_marginal_cdfs(cdfs, 1e-3, nullptr, 1);
+    auto parallel = merge_marginal_cdfs(cdfs, 1e-3, nullptr, 4);
+    EXPECT_EQ(parallel.breakpoints, sequential.breakpoints);
+    EXPECT_EQ(parallel.indices, sequential.indices);
+}
+
+TEST(ParallelMerge, EJD_MATCHES_SEQUENTIAL)
+{
+    auto marginals = construct_Poisson_EmpDistrArray({20000, 30000, 45000, 60000});
+    EJDOptions options;
+    auto sequential = ejd::ejd(marginals, {1,-1,1,-1}, options);
+    options.threads = 4;
+    auto parallel = ejd::ejd(marginals, {1,-1,1,-1}, options);
+    EXPECT_EQ(parallel.support, sequential.support);
+    EXPECT_EQ(parallel.weights, sequential.weights);
+
+    options.arithmetic = EJDArithmetic::fixed64;
+    auto fixed = ejd::ejd(marginals, {1,-1,1,-1}, options);
+    options.threads = 1;
+    EXPECT_EQ(fixed.support, ejd::ejd(marginals, {1,-1,1,-1}, options).support);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
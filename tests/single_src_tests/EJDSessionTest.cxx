@@ -0,0 +1,185 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "EJDSession.hpp"
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasures.hpp"
+// 3rd party
+#include "gtest/gtest.h"
+// std lib
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace ejd;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// EJD Session Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+static void expect_same(const ExtremeMeasure& em, const ExtremeMeasure& reference)
+{
+    ASSERT_EQ(em.support.size(), reference.support.size());
+    EXPECT_EQ(em.weights, reference.weights);
+    EXPECT_EQ(em.support, reference.support);
+    EXPECT_EQ(em.monotone_structure, reference.monotone_structure);
+}
+
+static void expect_rebuilt(const EJDSession& session, const EJDOptions& options = EJDOptions())
+{
+    for (int s = 0; s < session.num_structures(); ++s) {
+        expect_same(session.measure(s), ejd::ejd(session.marginals(), session.monotone_structure(s), options));
+    }
+}
+
+TEST(EJDSession, MATCHES_CONSTRUCTION)
+{
+    const std::vector<double> intensities {3, 5, 7};
+    const auto session = construct_Poisson_EJDSession(intensities);
+    const auto reference = construct_Poisson_ExtremeMeasures(intensities);
+    ASSERT_EQ(session.num_structures(), static_cast<int>(reference.size()));
+    for (int s = 0; s < session.num_structures(); ++s) {
+        const auto em = session.measure(s);
+        expect_same(em, reference[s]);
+        EXPECT_EQ(em.means, reference[s].means);
+        EXPECT_EQ(em.variances, reference[s].variances);
+    }
+}
+
+TEST(EJDSession, UPDATE_MARGINALS)
+{
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<double> lambda(0.5, 15.0);
+    EJDSession session(construct_Poisson_EmpDistrArray({4, 9, 2, 6}));
+    for (int round = 0; round < 40; ++round) {
+        const int j = round % 4;
+        // new marginals of any length, sometimes one that ties with another marginal
+        auto marginal = round % 7 == 3
+            ? session.marginals().marginals[(j + 1) % 4]
+            : construct_Poisson_EmpDistrArray({lambda(gen)}).marginals[0];
+        session.update_marginal(j, marginal);
+        EXPECT_FALSE(session.last_update().rebuilt);
+        expect_rebuilt(session);
+    }
+}
+
+TEST(EJDSession, COARSE_TOLERANCE)
+{
+    // wide tolerance: most breakpoints fold, and the regions span many values
+    EJDOptions options;
+    options.coalesce_tol = 2e-3;
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<double> lambda(1.0, 30.0);
+    EJDSession session(construct_Poisson_EmpDistrArray({10, 20, 3}), options);
+    expect_rebuilt(session, options);
+    for (int round = 0; round < 30; ++round) {
+        session.update_marginal(round % 3, construct_Poisson_EmpDistrArray({lambda(gen)}).marginals[0]);
+        expect_rebuilt(session, options);
+    }
+}
+
+TEST(EJDSession, SPLICE)
+{
+    // a short marginal among long ones is spliced into every structure
+    for (double tol : {1e-12, 1e-4}) {
+        EJDOptions options;
+        options.coalesce_tol = tol;
+        std::mt19937 gen(7);
+        std::uniform_real_distribution<double> lambda(0.5, 4.0);
+        std::vector<EmpiricalDistribution> marginals;
+        for (double intensity : {150.0, 300.0, 220.0, 2.0}) {
+            marginals.push_back(construct_Poisson_EmpDistrArray({intensity}).marginals[0]);
+        }
+        EJDSession session(EmpDistrArray(marginals), options);
+        // with zero weights and without mass near one now and then
+        const std::vector<EmpiricalDistribution> odd {
+            EmpiricalDistribution {.weights = {0.25, 0.25, 0, 0.5}, .support = {0, 1, 2, 3}},
+            EmpiricalDistribution {.weights = {0.3, 0.3, 0.3}, .support = {1, 2, 3}},
+        };
+        for (int round = 0; round < 20; ++round) {
+            session.update_marginal(3, round % 5 == 4
+                ? odd[round / 5 % 2]
+                : construct_Poisson_EmpDistrArray({lambda(gen)}).marginals[0]);
+            std::size_t total = 0;
+            for (const auto & m : session.marginals().marginals) {
+                total += m.weights.size();
+            }
+            EXPECT_EQ(session.last_update().spliced, static_cast<std::size_t>(session.num_structures()));
+            EXPECT_LT(session.last_update().merged_values, total * session.num_structures());
+            expect_rebuilt(session, options);
+        }
+    }
+}
+
+TEST(EJDSession, SHORT_MARGINALS)
+{
+    // marginals without mass near one, exact ties and zero weights
+    EJDSession session(EmpDistrArray({
+        EmpiricalDistribution {.weights = {0.25, 0.25, 0.5}, .support = {0, 1, 2}},
+        EmpiricalDistribution {.weights = {0.5, 0.25, 0.125}, .support = {0, 2, 5}},
+    }));
+    expect_rebuilt(session);
+    session.update_marginal(1, EmpiricalDistribution {.weights = {0.25, 0.25, 0, 0.5}, .support = {0, 1, 2, 3}});
+    expect_rebuilt(session);
+    session.update_marginal(0, EmpiricalDistribution {.weights = {1.0}, .support = {4}});
+    expect_rebuilt(session);
+    session.update_marginal(0, EmpiricalDistribution {.weights = {0.3, 0.3, 0.3}, .support = {1, 2, 3}});
+    expect_rebuilt(session);
+}
+
+TEST(EJDSession, UPDATE_DISTRIBUTIONS)
+{
+    std::vector<double> intensities {3, 5, 7};
+    auto session = construct_Poisson_EJDSession(intensities);
+    const std::vector<std::pair<int, double>> updates {{0, 3.5}, {1, 4.2}, {2, 6.1}, {2, 9.0}, {0, 0.7}, {2, 7}};
+    for (auto [j, lambda] : updates) {
+        intensities[j] = lambda;
+        session.update_distribution(j, bm::poisson(lambda));
+        const auto reference = construct_Poisson_ExtremeMeasures(intensities);
+        for (int s = 0; s < session.num_structures(); ++s) {
+            expect_same(session.measure(s), reference[s]);
+            EXPECT_EQ(session.measure(s).means, reference[s].means);
+        }
+    }
+
+    // the support keeps its end, so only marginal 0 changes
+    session.update_distribution(0, bm::poisson(3.1));
+    EXPECT_FALSE(session.last_update().rebuilt);
+    intensities[0] = 3.1;
+    const auto reference = construct_Poisson_ExtremeMeasures(intensities);
+    for (int s = 0; s < session.num_structures(); ++s) {
+        expect_same(session.measure(s), reference[s]);
+    }
+
+    EJDSession plain(construct_Poisson_EmpDistrArray({1, 2}));
+    EXPECT_THROW(plain.update_distribution(0, bm::poisson(2.0)), std::logic_error);
+    EXPECT_THROW(plain.update_marginal(2, plain.marginals().marginals[0]), std::invalid_argument);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -36,6 +36,7 @@ namespace bm = boost::math;
 #include <algorithm>
 #include <type_traits>
 #include <numeric>
+#include <thread>
 
 #include "gtest/gtest.h"
 
@@ -89,6 +90,171 @@ TEST_F(EmpDistrArrayTests, construct_Poisson_EmpDistrArray) {
     auto a = ejd::construct_Poisson_EmpDistrArray(poisson_params);
 }
 
+TEST_F(EmpDistrArrayTests, SUMMARIES) {
+    const auto & summaries = empdistrarray_poiss.summaries();
+    ASSERT_EQ(summaries.size(), poisson_params.size());
+    for (int j = 0; j < summaries.size(); ++j) {
+        const auto & marginal = empdistrarray_poiss.marginals[j];
+        EXPECT_NEAR(summaries[j].mean, marginal.mean(), 1e-12);
+        EXPECT_NEAR(summaries[j].variance, marginal.variance(), 1e-10);
+        EXPECT_NEAR(summaries[j].total_mass, marginal.total_prob(), 1e-15);
+        EXPECT_NEAR(summaries[j].entropy, marginal.entropy(), 1e-14);
+        EXPECT_NEAR(summaries[j].mean, poisson_params[j], 1e-3);
+    }
+    EXPECT_EQ(empdistrarray_poiss.means()[2], summaries[2].mean);
+    EXPECT_EQ(empdistrarray_poiss.variances()[3], summaries[3].variance);
+}
+
+TEST_F(EmpDistrArrayTests, SUMMARIES_CACHED) {
+    const auto * first = &empdistrarray_poiss.summaries();
+    EXPECT_EQ(&empdistrarray_poiss.summaries(), first);
+
+    // a copy shares them until it is edited, which leaves the original's alone
+    EmpDistrArray copy = empdistrarray_poiss;
+    EXPECT_EQ(&copy.summaries(), first);
+    copy.marginals.pop_back();
+    EXPECT_EQ(copy.summaries().size(), poisson_params.size() - 1);
+    EXPECT_EQ(&empdistrarray_poiss.summaries(), first);
+    copy = empdistrarray_poiss;
+    copy.marginals.pop_back();
+    EXPECT_EQ(copy.summaries().size(), poisson_params.size() - 1);
+
+    // an edit of a single weight is seen too
+    copy.marginals[0].weights[1] += 0.5;
+    EXPECT_NEAR(copy.summaries()[0].total_mass, empdistrarray_poiss.summaries()[0].total_mass + 0.5, 1e-12);
+    copy.invalidate_summaries();
+    EXPECT_EQ(copy.summaries().size(), poisson_params.size() - 1);
+}
+
+TEST_F(EmpDistrArrayTests, MOMENTS_AFTER_EDIT) {
+    // means() and variances() always follow the marginals
+    EmpDistrArray edited = empdistrarray_poiss;
+    edited.summaries();
+    edited.marginals[0] = ejd::construct_Poisson_EmpDistrArray({7.0}).marginals[0];
+    EXPECT_NEAR(edited.means()[0], 7.0, 1e-3);
+    EXPECT_NEAR(edited.variances()[0], 7.0, 1e-2);
+    EXPECT_EQ(edited.means()[1], empdistrarray_poiss.means()[1]);
+
+    std::vector<double> means;
+    std::vector<double> variances;
+    edited.means_and_variances(&means, &variances);
+    EXPECT_EQ(means, edited.means());
+    EXPECT_EQ(variances, edited.variances());
+}
+
+TEST_F(EmpDistrArrayTests, SUMMARIES_CONCURRENT) {
+    std::vector<const std::vector<MarginalSummary> *> seen(8);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < seen.size(); ++t) {
+        threads.emplace_back([this, &seen, t] { seen[t] = &empdistrarray_poiss.summaries(); });
+    }
+    for (auto & t : threads) {
+        t.join();
+    }
+    EXPECT_TRUE(std::all_of(seen.begin(), seen.end(), [&seen] (auto p) { return p == seen[0]; }));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Recurrence Marginals Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+struct RecurrenceMarginalsTests : public ::testing::Test
+{
+    std::vector<ejd::MarginalDistribution> distrs {
+        bm::poisson(7.5),
+        bm::binomial(40, 0.3),
+        bm::negative_binomial(4, 0.35),
+        bm::geometric(0.2),
+        ejd::GenericMarginal(bm::poisson(2.))
+    };
+};
+
+TEST_F(RecurrenceMarginalsTests, UPPER_BOUNDS) {
+    EXPECT_EQ(ejd::recurrence_upper_bounds(bm::poisson(5)), 17);
+    EXPECT_EQ(ejd::recurrence_upper_bounds(distrs[0]), ejd::upper_bounds(bm::poisson(7.5)));
+    EXPECT_EQ(ejd::recurrence_upper_bounds(distrs[1]), ejd::upper_bounds(bm::binomial(40, 0.3)));
+    EXPECT_EQ(ejd::recurrence_upper_bounds(distrs[2]), ejd::upper_bounds(bm::negative_binomial(4, 0.35)));
+    EXPECT_EQ(ejd::recurrence_upper_bounds(distrs[3]), ejd::upper_bounds(bm::geometric(0.2)));
+    EXPECT_EQ(ejd::recurrence_upper_bounds(distrs[4]), ejd::upper_bounds(bm::poisson(2.)));
+}
+
+TEST_F(RecurrenceMarginalsTests, PMF_MATCHES_BOOST) {
+    auto expect_pmf = [] (const auto & d, const std::vector<double>& pmf) {
+        for (int k = 0; k < pmf.size(); ++k) {
+            EXPECT_NEAR(pmf[k], bm::pdf(d,k), 1e-12 * bm::pdf(d,k) + 1e-300) << k;
+        }
+    };
+    expect_pmf(bm::poisson(7.5), ejd::recurrence_pmf(distrs[0], 60));
+    expect_pmf(bm::binomial(40, 0.3), ejd::recurrence_pmf(distrs[1], 41));
+    expect_pmf(bm::negative_binomial(4, 0.35), ejd::recurrence_pmf(distrs[2], 60));
+    expect_pmf(bm::geometric(0.2), ejd::recurrence_pmf(distrs[3], 60));
+    expect_pmf(bm::poisson(2.), ejd::recurrence_pmf(distrs[4], 20));
+    // past the number of trials
+    auto binomial = ejd::recurrence_pmf(distrs[1], 50);
+    EXPECT_TRUE(std::all_of(binomial.begin() + 41, binomial.end(), [] (double p) { return p == 0; }));
+}
+
+TEST_F(RecurrenceMarginalsTests, DEGENERATE_DISTRIBUTIONS) {
+    EXPECT_EQ(ejd::recurrence_pmf(bm::binomial(5, 0.), 3), (std::vector<double>{1., 0., 0.}));
+    EXPECT_EQ(ejd::recurrence_pmf(bm::binomial(2, 1.), 4), (std::vector<double>{0., 0., 1., 0.}));
+    EXPECT_EQ(ejd::recurrence_upper_bounds(bm::binomial(2, 1.)), 2);
+}
+
+TEST_F(RecurrenceMarginalsTests, HETEROGENEOUS_ARRAY) {
+    auto array = ejd::construct_EmpDistrArray(distrs);
+    ASSERT_EQ(array.dimensions(), distrs.size());
+
+    const int support_end = ejd::upper_bounds(bm::geometric(0.2));
+    for (const auto & marginal : array.marginals) {
+        EXPECT_EQ(marginal.support.size(), support_end);
+        EXPECT_NEAR(marginal.total_prob(), 1., 1e-12);
+    }
+    auto expected = ejd::construct_discrete_EmpDistr(bm::negative_binomial(4, 0.35), support_end);
+    for (int k = 0; k < support_end; ++k) {
+        EXPECT_NEAR(array.marginals[2].weights[k], expected.weights[k], 1e-12);
+    }
+}
+
+TEST_F(RecurrenceMarginalsTests, MATCHES_GENERIC_PATH) {
+    std::vector<bm::poisson> poisson {bm::poisson(3), bm::poisson(9)};
+    auto recurrence = ejd::construct_EmpDistrArray(poisson);
+    auto generic = ejd::construct_EmpDistrArray<bm::poisson>(poisson);
+    ASSERT_EQ(recurrence.marginals.size(), generic.marginals.size());
+    for (int j = 0; j < poisson.size(); ++j) {
+        EXPECT_EQ(recurrence.marginals[j].support, generic.marginals[j].support);
+        for (int k = 0; k < generic.marginals[j].weights.size(); ++k) {
+            EXPECT_NEAR(recurrence.marginals[j].weights[k], generic.marginals[j].weights[k], 1e-14);
+        }
+    }
+}
+
+TEST_F(RecurrenceMarginalsTests, LARGE_INTENSITY) {
+    // p(0) underflows, and the support is longer than upper_bounds looks
+    auto array = ejd::construct_Poisson_EmpDistrArray({5000.});
+    const auto & marginal = array.marginals[0];
+    EXPECT_GT(marginal.support.size(), 5000);
+    EXPECT_NEAR(marginal.total_prob(), 1., 1e-12);
+    EXPECT_NEAR(marginal.mean(), 5000., 1e-2);
+}
+
+TEST_F(RecurrenceMarginalsTests, DUAL_POISSON_PMF) {
+    auto array = ejd::construct_Poisson_EmpDistrArray({6.5, 2.});
+    const int support_end = array.marginals[0].support.size();
+    const auto pmf = ejd::basic_poisson_pmf(ejd::Dual<1>::variable(6.5, 0), support_end);
+    ASSERT_EQ(pmf.size(), support_end);
+    // the values of the double path, and d/dl p(k) = p(k-1) - p(k) up to the folded last atom
+    for (int k = 0; k < support_end; ++k) {
+        EXPECT_EQ(pmf[k].value, array.marginals[0].weights[k]) << k;
+        const double expected = k + 1 < support_end
+            ? (k > 0 ? pmf[k-1].value : 0) - pmf[k].value
+            : pmf[k-1].value;
+        EXPECT_NEAR(pmf[k].grad[0], expected, 1e-14) << k;
+    }
+    EXPECT_EQ(ejd::basic_poisson_pmf(2., support_end), array.marginals[1].weights);
+}
+
 int main(int argc, char **argv)
 {
     /* code */
@@ -0,0 +1,128 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ExtremeMeasureBatch.hpp"
+#include "ExtremeMeasures.hpp"
+#include "Utils/ThreadPool.hpp"
+// 3rd party
+#include "gtest/gtest.h"
+// std lib
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace ejd;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Thread Pool Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+TEST(ThreadPool, SUBMIT)
+{
+    ThreadPool pool(3);
+    EXPECT_EQ(pool.size(), 3u);
+    auto answer = pool.submit([] () { return 42; });
+    auto failure = pool.submit([] () -> int { throw std::runtime_error("task"); });
+    EXPECT_EQ(answer.get(), 42);
+    EXPECT_THROW(failure.get(), std::runtime_error);
+}
+
+TEST(ThreadPool, FOR_EACH_INDEX)
+{
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> calls(1000);
+    pool.for_each_index(calls.size(), [&] (std::size_t i) { ++calls[i]; });
+    for (const auto & c : calls) {
+        EXPECT_EQ(c.load(), 1);
+    }
+    EXPECT_THROW(pool.for_each_index(100, [] (std::size_t i) {
+        if (i == 37) {
+            throw std::invalid_argument("index");
+        }
+    }), std::invalid_argument);
+    // still usable afterwards
+    EXPECT_EQ(pool.submit([] () { return 1; }).get(), 1);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Extreme Measure Batch Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+TEST(ExtremeMeasureBatch, MATCHES_SINGLE_CALLS)
+{
+    const int dim = 3;
+    const std::vector<double> intensities {
+        3, 5, 7,
+        0.5, 12, 1,
+        20, 2.5, 8,
+        1, 1, 1
+    };
+    ThreadPool pool(3);
+    auto batch = construct_Poisson_ExtremeMeasureBatch(intensities.data(), 4, dim, pool);
+    ASSERT_EQ(batch.num_structures, 4);
+    ASSERT_EQ(batch.size(), 16u);
+
+    for (std::size_t p = 0; p < 4; ++p) {
+        auto ems = construct_Poisson_ExtremeMeasures({intensities.begin() + p * dim, intensities.begin() + (p + 1) * dim});
+        for (int s = 0; s < batch.num_structures; ++s) {
+            const auto em = batch.measure(batch.index(p, s));
+            EXPECT_EQ(em.support, ems[s].support) << "portfolio " << p << ", structure " << s;
+            EXPECT_EQ(em.weights, ems[s].weights);
+            EXPECT_EQ(em.monotone_structure, ems[s].monotone_structure);
+            EXPECT_EQ(em.means, ems[s].means);
+            EXPECT_EQ(em.variances, ems[s].variances);
+        }
+    }
+}
+
+TEST(ExtremeMeasureBatch, VIEW)
+{
+    auto batch = construct_Poisson_ExtremeMeasureBatch({4, 6, 2, 9}, 2, 2);
+    ASSERT_EQ(batch.size(), 4u);
+    const auto v = batch.view(batch.index(1, 1));
+    EXPECT_EQ(v.size, batch.support_size(3));
+    EXPECT_EQ(v.monotone_structure[1], batch.monotone_structures[3]);
+    double mass = 0;
+    for (std::size_t i = 0; i < v.size; ++i) {
+        mass += v.weights[i];
+    }
+    EXPECT_NEAR(mass, 1.0, 1e-12);
+}
+
+TEST(ExtremeMeasureBatch, INVALID)
+{
+    EXPECT_THROW(construct_Poisson_ExtremeMeasureBatch({1, 2, 3}, 2), std::invalid_argument);
+    EJDOptions options;
+    options.arithmetic = EJDArithmetic::fixed64;
+    EXPECT_THROW(construct_Poisson_ExtremeMeasureBatch({1, 2}, 2, 1, options), std::invalid_argument);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,140 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ExtremeMeasureOrbits.hpp"
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasures.hpp"
+// 3rd party
+#include "gtest/gtest.h"
+// std lib
+#include <stdexcept>
+#include <vector>
+
+using namespace ejd;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Extreme Measure Orbit Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// the same support in the same order, weights equal up to rounding when the orbit flips
+static void expect_equivalent(const ExtremeMeasure& em, const ExtremeMeasure& reference, bool exact)
+{
+    ASSERT_EQ(em.support.size(), reference.support.size());
+    EXPECT_EQ(em.support, reference.support);
+    EXPECT_EQ(em.monotone_structure, reference.monotone_structure);
+    if (exact) {
+        EXPECT_EQ(em.weights, reference.weights);
+    } else {
+        for (std::size_t i = 0; i < em.weights.size(); ++i) {
+            EXPECT_NEAR(em.weights[i], reference.weights[i], 1e-12);
+        }
+    }
+}
+
+TEST(ExtremeMeasureOrbits, MATCHES_CONSTRUCTION)
+{
+    const std::vector<double> intensities {3, 3, 5, 3, 5, 7};
+    EJDOptions options;
+    options.coalesce_tol = 0;
+    const auto orbits = construct_Poisson_ExtremeMeasureOrbits(intensities, options);
+    const auto reference = construct_Poisson_ExtremeMeasures(intensities, options);
+    ASSERT_EQ(orbits.num_structures(), static_cast<int>(reference.size()));
+    EXPECT_EQ(orbits.num_groups(), 3);
+    EXPECT_EQ(orbits.group(3), 0);
+    EXPECT_EQ(orbits.group(4), 1);
+    // (4 x 3 x 2) antitone counts, half of them flips of the other half
+    EXPECT_EQ(orbits.num_representatives(), 12);
+    const auto & stats = orbits.stats();
+    EXPECT_EQ(stats.structures, 32u);
+    EXPECT_EQ(stats.representatives, 12u);
+    EXPECT_EQ(stats.saved_values * 12, stats.merged_values * 20);
+    for (int s = 0; s < orbits.num_structures(); ++s) {
+        const auto em = orbits.measure(s);
+        expect_equivalent(em, reference[s], !orbits.flipped(s));
+        EXPECT_EQ(em.means, reference[s].means);
+        EXPECT_EQ(em.variances, reference[s].variances);
+    }
+}
+
+TEST(ExtremeMeasureOrbits, COARSE_TOLERANCE)
+{
+    // runs folded by a wide tolerance do not flip, so the flipped orbits are computed
+    EJDOptions options;
+    options.coalesce_tol = 1e-6;
+    for (const auto & intensities : std::vector<std::vector<double>> {{3.7, 3.7, 6.3}, {3, 3, 5, 3, 5, 7}}) {
+        const auto orbits = construct_Poisson_ExtremeMeasureOrbits(intensities, options);
+        const auto reference = construct_Poisson_ExtremeMeasures(intensities, options);
+        ASSERT_EQ(orbits.num_structures(), static_cast<int>(reference.size()));
+        for (int s = 0; s < orbits.num_structures(); ++s) {
+            EXPECT_FALSE(orbits.flipped(s));
+            expect_equivalent(orbits.measure(s), reference[s], true);
+        }
+    }
+    // (3 x 3 x 2) antitone counts with marginal 0 comonotone
+    EXPECT_EQ(construct_Poisson_ExtremeMeasureOrbits({3, 3, 5, 3, 5, 7}).num_representatives(), 18);
+}
+
+TEST(ExtremeMeasureOrbits, PERMUTATION)
+{
+    EJDOptions options;
+    options.coalesce_tol = 0;
+    const auto orbits = construct_Poisson_ExtremeMeasureOrbits({2, 2, 2, 2}, options);
+    // antitone counts 0, 1 and 2 of four identical marginals, and without the flip also 3
+    EXPECT_EQ(orbits.num_representatives(), 3);
+    EXPECT_EQ(construct_Poisson_ExtremeMeasureOrbits({2, 2, 2, 2}).num_representatives(), 4);
+    const MonotonicityStructure ms(4);
+    for (int s = 0; s < orbits.num_structures(); ++s) {
+        EXPECT_EQ(orbits.monotone_structure(s), ms[s]);
+        const auto perm = orbits.permutation(s);
+        const auto & rep = orbits.representative_measure(orbits.representative(s)).monotone_structure;
+        const auto signs = orbits.monotone_structure(s);
+        const int flip = orbits.flipped(s) ? -1 : 1;
+        for (int j = 0; j < 4; ++j) {
+            EXPECT_EQ(signs[perm[j]] * flip, rep[j]);
+        }
+    }
+}
+
+TEST(ExtremeMeasureOrbits, DISTINCT_MARGINALS)
+{
+    const std::vector<double> intensities {1, 2, 4, 8};
+    const auto orbits = construct_Poisson_ExtremeMeasureOrbits(intensities);
+    EXPECT_EQ(orbits.num_representatives(), orbits.num_structures());
+    EXPECT_EQ(orbits.stats().saved_values, 0u);
+    const auto reference = construct_Poisson_ExtremeMeasures(intensities);
+    const auto ems = orbits.measures();
+    for (int s = 0; s < orbits.num_structures(); ++s) {
+        EXPECT_FALSE(orbits.flipped(s));
+        expect_equivalent(ems[s], reference[s], true);
+    }
+
+    EXPECT_THROW(ExtremeMeasureOrbits {EmpDistrArray()}, std::invalid_argument);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -21,6 +21,7 @@
     DEALINGS IN THE SOFTWARE.
 */
 
+#include "EmpiricalDistribution.hpp"
 #include "ExtremeMeasures.hpp"
 #include "Utils/PrettyPrint.hpp"
 // 3rd party
@@ -28,6 +29,7 @@
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 // std lib
+#include <algorithm>
 #include <numeric>
 #include <vector>
 
@@ -110,7 +112,119 @@ TEST_F(LatticePointTest, DIMENSIONALITY_TEST) {
     EXPECT_EQ(p2.dimension(), 5);
 }
 
-// TODO: implement test for sorting lattice points (from a real outputted support)
+TEST_F(LatticePointTest, STRICT_WEAK_ORDERING_TEST) {
+    std::vector<LatticePoint> points {
+        LatticePoint({1,2}), LatticePoint({2,1}), LatticePoint({0,3}), LatticePoint({1,2,0}),
+        LatticePoint({0}), LatticePoint({1,2}), LatticePoint({-1,5}), LatticePoint({2,1,0})
+    };
+    for (const auto & x : points) {
+        EXPECT_FALSE(x < x);
+        for (const auto & y : points) {
+            // exactly one of x < y, y < x, x == y
+            EXPECT_EQ((x < y) + (y < x) + (x == y), 1);
+            for (const auto & z : points) {
+                if (x < y && y < z) {
+                    EXPECT_TRUE(x < z);
+                }
+            }
+        }
+    }
+    // lower dimensions first, then lexicographic
+    EXPECT_TRUE(LatticePoint({9}) < LatticePoint({0,0}));
+    EXPECT_TRUE(LatticePoint({1,5}) < LatticePoint({2,1}));
+    EXPECT_TRUE(LatticePoint({2,0}) < LatticePoint({2,1}));
+}
+
+TEST_F(LatticePointTest, DOMINANCE_TEST) {
+    EXPECT_TRUE(dominates(LatticePoint({2,3}), LatticePoint({1,3})));
+    EXPECT_FALSE(dominates(LatticePoint({1,3}), LatticePoint({2,3})));
+    // incomparable, and not reflexive
+    EXPECT_FALSE(dominates(LatticePoint({2,1}), LatticePoint({1,2})));
+    EXPECT_FALSE(dominates(LatticePoint({1,2}), LatticePoint({2,1})));
+    EXPECT_FALSE(dominates(LatticePoint({1,2}), LatticePoint({1,2})));
+    EXPECT_FALSE(dominates(LatticePoint({1,2,3}), LatticePoint({1,2})));
+    // along a monotone structure, the second coordinate is flipped
+    EXPECT_TRUE(dominates(LatticePoint({2,1}), LatticePoint({1,2}), {1,-1}));
+    EXPECT_FALSE(dominates(LatticePoint({2,3}), LatticePoint({1,2}), {1,-1}));
+}
+
+TEST_F(LatticePointTest, SORT_SUPPORT_TEST) {
+    // support of the counter-monotone Poisson(3), Poisson(5) measure, scrambled
+    auto em = construct_Poisson_ExtremeMeasures({3,5})[1];
+    DiscreteMeasure dm {em.support, em.weights};
+    std::vector<std::size_t> permutation(dm.support.size());
+    std::iota(permutation.begin(), permutation.end(), 0);
+    std::reverse(permutation.begin(), permutation.end());
+    std::rotate(permutation.begin(), permutation.begin() + permutation.size() / 3, permutation.end());
+    for (std::size_t i = 0; i < permutation.size(); ++i) {
+        dm.support[i] = em.support[permutation[i]];
+        dm.weights[i] = em.weights[permutation[i]];
+    }
+
+    dm.sort();
+    ASSERT_TRUE(dm.is_sorted());
+    ASSERT_EQ(dm.size(), em.size());
+    // every weight still sits with its point
+    for (std::size_t i = 0; i < em.support.size(); ++i) {
+        auto it = std::lower_bound(dm.support.begin(), dm.support.end(), em.support[i]);
+        ASSERT_TRUE(it != dm.support.end() && *it == em.support[i]);
+        EXPECT_EQ(dm.weights[it - dm.support.begin()], em.weights[i]);
+    }
+}
+
+TEST_F(LatticePointTest, COALESCE_AND_MERGE_TEST) {
+    DiscreteMeasure x {
+        {LatticePoint({1,1}), LatticePoint({0,2}), LatticePoint({1,1}), LatticePoint({0,0})},
+        {0.1, 0.2, 0.3, 0.4}
+    };
+    x.coalesce();
+    ASSERT_EQ(x.size(), 3);
+    EXPECT_TRUE(x.support[0] == LatticePoint({0,0}));
+    EXPECT_TRUE(x.support[1] == LatticePoint({0,2}));
+    EXPECT_TRUE(x.support[2] == LatticePoint({1,1}));
+    EXPECT_DOUBLE_EQ(x.weights[2], 0.4);
+
+    DiscreteMeasure y {{LatticePoint({0,1}), LatticePoint({0,2}), LatticePoint({3,0})}, {1.0, 2.0, 3.0}};
+    auto merged = merge_sorted(x, y);
+    ASSERT_EQ(merged.size(), 5);
+    EXPECT_TRUE(merged.is_sorted());
+    EXPECT_DOUBLE_EQ(merged.weights[2], 2.2);
+    EXPECT_DOUBLE_EQ(std::accumulate(merged.weights.begin(), merged.weights.end(), 0.0), 7.0);
+
+    // unsorted addition goes through the hash index and ends up the same
+    DiscreteMeasure z {{LatticePoint({3,0}), LatticePoint({0,1}), LatticePoint({0,2})}, {3.0, 1.0, 2.0}};
+    x += z;
+    EXPECT_EQ(x.support, merged.support);
+    EXPECT_EQ(x.weights, merged.weights);
+}
+
+TEST_F(LatticePointTest, ADDITION_COALESCES_TEST) {
+    // repeated points within the left measure are merged whichever path the addition takes
+    DiscreteMeasure sorted_x {
+        {LatticePoint({0,0}), LatticePoint({1,1}), LatticePoint({1,1})}, {0.1, 0.2, 0.3}
+    };
+    DiscreteMeasure unsorted_x {
+        {LatticePoint({1,1}), LatticePoint({0,0}), LatticePoint({1,1})}, {0.2, 0.1, 0.3}
+    };
+    DiscreteMeasure y {{LatticePoint({0,1}), LatticePoint({1,1})}, {1.0, 2.0}};
+
+    for (auto x : {sorted_x, unsorted_x}) {
+        x += y;
+        ASSERT_EQ(x.size(), 3);
+        EXPECT_TRUE(x.is_sorted());
+        EXPECT_DOUBLE_EQ(x.weights[2], 2.5);
+    }
+    auto x = unsorted_x;
+    x += DiscreteMeasure();
+    EXPECT_EQ(x.size(), 2);
+
+    // the inherited sort is usable on an extreme measure
+    ExtremeMeasure em;
+    em.support = unsorted_x.support;
+    em.weights = unsorted_x.weights;
+    em.sort();
+    EXPECT_TRUE(em.is_sorted());
+}
 
 //////////////////////////////////////////////////////////////////////////////
 //
@@ -135,11 +249,85 @@ TEST_F(ExtremeMeasureTests, Construct_Poisson_ExtremeMeasure)
 
 TEST_F(ExtremeMeasureTests, Means_Variance_Test)
 {
+    // moments of the truncated marginals, within the truncation tolerance of the intensities
     std::vector params{3.,5.};
-    EXPECT_EQ(pms[0].means, params);
-    EXPECT_EQ(pms[1].means, params);
-    EXPECT_EQ(pms[0].means, pms[0].variances);
-    EXPECT_EQ(pms[1].means, pms[1].variances);
+    for (const auto & em : pms) {
+        ASSERT_EQ(em.means.size(), params.size());
+        ASSERT_EQ(em.variances.size(), params.size());
+        for (int j = 0; j < params.size(); ++j) {
+            EXPECT_NEAR(em.means[j], params[j], 1e-3);
+            EXPECT_NEAR(em.variances[j], params[j], 1e-2);
+        }
+    }
+    EXPECT_EQ(pms[0].means, pms[1].means);
+    EXPECT_EQ(pms[0].variances, pms[1].variances);
+}
+
+TEST_F(ExtremeMeasureTests, Positive_Weights_Test)
+{
+    for (const auto & em : pms) {
+        for (double w : em.weights) {
+            EXPECT_GT(w, 0.);
+        }
+        EXPECT_DOUBLE_EQ(std::accumulate(em.weights.begin(), em.weights.end(), 0.), 1.);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Joint CDF Merge Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+TEST(JointCDFMerge, COMPENSATED_CUM_SUM) {
+    std::vector<double> d(10, 0.1);
+    ejd::apply_compensated_cumsum(&d);
+    EXPECT_EQ(d.back(), 1.0);
+}
+
+TEST(JointCDFMerge, ENSURE_RIGHT_TAIL) {
+    std::vector<double> cdf {0.25, 0.5, 1 - 1e-12, 1 + 1e-12};
+    ejd::ensure_right_tail(&cdf);
+    EXPECT_EQ(cdf, (std::vector<double>{0.25, 0.5, 1.0}));
+}
+
+TEST(JointCDFMerge, STRICTLY_INCREASING) {
+    // duplicated, near-duplicated, zero-mass and tail values
+    std::vector<std::vector<double>> cdfs {
+        {0.0, 0.25, 0.5, 1.0},
+        {0.25, 0.5 + 1e-15, 0.75, 1 - 1e-15},
+        {0.1, 0.25, 0.25, 1.0}
+    };
+    ejd::EJDStats stats;
+    auto joint = ejd::merge_marginal_cdfs(cdfs, 1e-12, &stats);
+
+    std::vector<double> want {0.1, 0.25, 0.5 + 1e-15, 0.75, 1.0};
+    EXPECT_EQ(joint.breakpoints, want);
+    EXPECT_EQ(stats.breakpoints, 12u);
+    EXPECT_EQ(stats.folded, 7u);
+
+    // atom of each marginal at each breakpoint
+    std::vector<int> indices {
+        1,0,0,
+        1,0,1,
+        2,1,3,
+        3,2,3,
+        3,3,3
+    };
+    EXPECT_EQ(joint.indices, indices);
+}
+
+TEST(JointCDFMerge, FOLDED_IDENTICAL_MARGINALS) {
+    auto marginals = construct_Poisson_EmpDistrArray({3,3});
+    ejd::EJDStats stats;
+    auto em = ejd::ejd(marginals, {1,1}, ejd::EJDOptions(), &stats);
+
+    // the comonotone coupling of two identical marginals lives on the diagonal
+    EXPECT_EQ(em.size(), static_cast<int>(marginals.marginals[0].weights.size()));
+    EXPECT_EQ(stats.folded, stats.breakpoints - em.size());
+    for (const auto & p : em.support) {
+        EXPECT_EQ(p.point[0], p.point[1]);
+    }
 }
 
 // test that em::dimension returns the correct thing// test that monotonestruct.size() == support.size()
@@ -0,0 +1,157 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasures.hpp"
+#include "HDF5Format.hpp"
+// 3rd party
+#include "gtest/gtest.h"
+// std lib
+#include <filesystem>
+namespace fs = std::filesystem;
+#include <thread>
+
+using namespace ejd;
+
+#ifdef EJD_WITH_HDF5
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// HDF5 Format Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+struct HDF5FormatTest : public ::testing::Test
+{
+    std::vector<double> intensities {3,5,7};
+    EmpDistrArray marginals = construct_Poisson_EmpDistrArray(intensities);
+    ExtremeMeasures pms = construct_Poisson_ExtremeMeasures(intensities);
+    fs::path path = fs::temp_directory_path() / "ejd_hdf5_format_test.h5";
+
+    ~HDF5FormatTest() {
+        fs::remove(path);
+    }
+};
+
+TEST_F(HDF5FormatTest, ROUND_TRIP)
+{
+    HDF5Options options;
+    options.chunk_size = 8;
+    options.compression_level = 4;
+    write_hdf5(path.string(), marginals, pms, options);
+
+    EXPECT_TRUE(read_EmpDistrArray_hdf5(path.string()) == marginals);
+    ASSERT_EQ(num_ExtremeMeasures_hdf5(path.string()), pms.size());
+
+    auto ems = read_ExtremeMeasures_hdf5(path.string());
+    ASSERT_EQ(ems.size(), pms.size());
+    for (std::size_t i = 0; i < pms.size(); ++i) {
+        EXPECT_EQ(ems[i].support, pms[i].support);
+        EXPECT_EQ(ems[i].weights, pms[i].weights);
+        EXPECT_EQ(ems[i].monotone_structure, pms[i].monotone_structure);
+        EXPECT_EQ(ems[i].means, pms[i].means);
+    }
+}
+
+TEST_F(HDF5FormatTest, PARTIAL_READS)
+{
+    write_hdf5(path.string(), marginals, pms);
+
+    auto some = read_ExtremeMeasures_hdf5(path.string(), {3,1});
+    ASSERT_EQ(some.size(), 2u);
+    EXPECT_EQ(some[0].support, pms[3].support);
+    EXPECT_EQ(some[1].support, pms[1].support);
+
+    auto range = read_ExtremeMeasure_hdf5(path.string(), 2, 3, 4);
+    ASSERT_EQ(range.support.size(), 4u);
+    for (int k = 0; k < 4; ++k) {
+        EXPECT_EQ(range.support[k], pms[2].support[3+k]);
+        EXPECT_EQ(range.weights[k], pms[2].weights[3+k]);
+    }
+}
+
+TEST_F(HDF5FormatTest, CONCURRENT_WRITER)
+{
+    {
+        HDF5Writer writer(path.string());
+        writer.write(marginals);
+        std::vector<std::thread> producers;
+        for (std::size_t i = 0; i < pms.size(); ++i) {
+            producers.emplace_back([&writer, this, i] { writer.write(i, pms[i]); });
+        }
+        for (auto & t : producers) {
+            t.join();
+        }
+    }
+    auto ems = read_ExtremeMeasures_hdf5(path.string());
+    ASSERT_EQ(ems.size(), pms.size());
+    for (std::size_t i = 0; i < pms.size(); ++i) {
+        EXPECT_EQ(ems[i].support, pms[i].support);
+    }
+}
+
+TEST_F(HDF5FormatTest, SPARSE_INDICES_AND_WRITERS)
+{
+    // measures under structure indices with gaps, and a second writer on another thread
+    const fs::path other = fs::temp_directory_path() / "ejd_hdf5_format_test_other.h5";
+    {
+        HDF5Writer writer(path.string());
+        std::thread second([&] {
+            HDF5Writer w(other.string());
+            for (std::size_t i = 0; i < pms.size(); ++i) {
+                w.append(pms[i]);
+            }
+        });
+        writer.write(3, pms[3]);
+        writer.write(1, pms[1]);
+        writer.write(12, pms[0]);
+        second.join();
+    }
+    auto ems = read_ExtremeMeasures_hdf5(path.string());
+    ASSERT_EQ(ems.size(), 3u);
+    EXPECT_EQ(ems[0].support, pms[1].support);
+    EXPECT_EQ(ems[1].support, pms[3].support);
+    EXPECT_EQ(ems[2].support, pms[0].support);
+    EXPECT_EQ(read_ExtremeMeasures_hdf5(other.string()).size(), pms.size());
+    fs::remove(other);
+}
+
+TEST_F(HDF5FormatTest, EMPTY_STRUCTURE)
+{
+    // the support columns follow the points, not the monotone structure
+    ExtremeMeasure em = pms[2];
+    em.monotone_structure.clear();
+    {
+        HDF5Writer writer(path.string());
+        writer.write(0, em);
+    }
+    EXPECT_EQ(read_ExtremeMeasure_hdf5(path.string(), 0).support, pms[2].support);
+}
+
+#endif
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
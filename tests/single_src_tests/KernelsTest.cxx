@@ -0,0 +1,186 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+#include "EmpiricalDistribution.hpp"
+#include "EmpiricalDistribution.hpp"
+#include "Kernels.hpp"
+// 3rd party
+#include "gtest/gtest.h"
+// std lib
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace ejd;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Kernels Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+struct KernelsTest : public ::testing::TestWithParam<kernels::KernelISA>
+{
+    std::vector<double> w;
+    std::vector<double> s;
+    std::vector<int> x;
+    std::vector<int> y;
+
+    void SetUp() override {
+        if (!supported(GetParam())) {
+            GTEST_SKIP() << kernels::to_string(GetParam()) << " not supported";
+        }
+        kernels::set_kernel_isa(GetParam());
+
+        std::mt19937 gen(7);
+        std::uniform_real_distribution<double> unif(0., 1.);
+        std::uniform_int_distribution<int> coords(-50, 50);
+        for (int i = 0; i < 1003; ++i) {
+            w.push_back(unif(gen) / 500);
+            s.push_back(i % 37);
+            x.push_back(coords(gen));
+            y.push_back(coords(gen));
+        }
+    }
+
+    void TearDown() override {
+        kernels::set_kernel_isa(kernels::best_kernel_isa());
+    }
+
+    static bool supported(kernels::KernelISA isa) {
+        try {
+            auto active = kernels::active_kernel_isa();
+            kernels::set_kernel_isa(isa);
+            kernels::set_kernel_isa(active);
+            return true;
+        } catch (const std::invalid_argument&) {
+            return false;
+        }
+    }
+};
+
+TEST_P(KernelsTest, NTH_MOMENT)
+{
+    for (int N : {0, 1, 2, 3, 7}) {
+        // every length up to a few blocks, to cover the padded tails
+        for (std::size_t n : {0, 1, 3, 8, 31, 33, 64, 1003}) {
+            double expected = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                expected += w[i] * std::pow(s[i], N);
+            }
+            EXPECT_NEAR(kernels::nth_moment(w.data(), s.data(), n, N), expected, 1e-13 * std::abs(expected) + 1e-300)
+                << N << ' ' << n;
+        }
+    }
+}
+
+TEST_P(KernelsTest, NEGATIVE_POWERS)
+{
+    const std::vector<double> weights {.5, .5};
+    const std::vector<double> support {1, 2};
+    EXPECT_DOUBLE_EQ(kernels::nth_moment(weights.data(), support.data(), 2, -1), 0.75);
+    EXPECT_DOUBLE_EQ(kernels::nth_moment(weights.data(), support.data(), 2, -2), 0.625);
+    EXPECT_DOUBLE_EQ(discrete_nth_moment(weights, support, -1), 0.75);
+    EXPECT_DOUBLE_EQ(discrete_nth_moment(std::vector<float>(weights.begin(), weights.end()),
+        std::vector<float>(support.begin(), support.end()), -1), 0.75);
+}
+
+TEST_P(KernelsTest, ENTROPY)
+{
+    for (std::size_t n : {0, 1, 5, 16, 47, 1003}) {
+        double expected = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            expected -= w[i] * std::log(w[i]);
+        }
+        EXPECT_NEAR(kernels::entropy(w.data(), n), expected, 1e-14 * std::abs(expected)) << n;
+    }
+}
+
+TEST_P(KernelsTest, ENTROPY_EDGE_CASES)
+{
+    // zero weights contribute nothing, subnormals are still logged correctly
+    std::vector<double> v {0., 1., 0.5, 1e-310, 4.9e-324, 0., 1e-300, 2.};
+    double expected = 0;
+    for (double p : v) {
+        expected -= p > 0 ? p * std::log(p) : 0.;
+    }
+    EXPECT_NEAR(kernels::entropy(v.data(), v.size()), expected, 1e-15);
+    // log is accurate to about an ulp
+    for (double p : {1e-300, 1e-10, 0.3, 0.7071067811865476, 0.7071067811865475, 1. - 1e-16, 1.5, 1e10}) {
+        EXPECT_NEAR(kernels::entropy(&p, 1), -p * std::log(p), 4e-16 * std::abs(p * std::log(p))) << p;
+    }
+}
+
+TEST_P(KernelsTest, MOMENT_SUMS)
+{
+    auto sums = kernels::moment_sums(w.data(), s.data(), w.size());
+    EXPECT_NEAR(sums.mass, kernels::nth_moment(w.data(), s.data(), w.size(), 0), 1e-13);
+    EXPECT_NEAR(sums.first, kernels::nth_moment(w.data(), s.data(), w.size(), 1), 1e-12);
+    EXPECT_NEAR(sums.second, kernels::nth_moment(w.data(), s.data(), w.size(), 2), 1e-10);
+    EXPECT_NEAR(sums.entropy, kernels::entropy(w.data(), w.size()), 1e-13);
+}
+
+TEST_P(KernelsTest, BIVARIATE_EXPECTATION)
+{
+    for (std::size_t n : {0, 2, 9, 40, 1003}) {
+        double expected = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            expected += w[i] * x[i] * y[i];
+        }
+        EXPECT_NEAR(kernels::bivariate_expectation(x.data(), y.data(), w.data(), n), expected, 1e-11) << n;
+    }
+}
+
+TEST_P(KernelsTest, REPRODUCIBLE)
+{
+    const double a = kernels::entropy(w.data(), w.size());
+    const auto sums = kernels::moment_sums(w.data(), s.data(), w.size());
+    for (int rep = 0; rep < 3; ++rep) {
+        EXPECT_EQ(kernels::entropy(w.data(), w.size()), a);
+        EXPECT_EQ(kernels::moment_sums(w.data(), s.data(), w.size()).second, sums.second);
+    }
+}
+
+TEST_P(KernelsTest, MARGINAL_SUMMARY)
+{
+    auto marginals = construct_Poisson_EmpDistrArray({4.5});
+    const auto & marginal = marginals.marginals[0];
+    auto summary = marginal.summary();
+    EXPECT_NEAR(summary.total_mass, marginal.total_prob(), 1e-15);
+    EXPECT_NEAR(summary.mean, marginal.mean(), 1e-13);
+    EXPECT_NEAR(summary.variance, marginal.variance(), 1e-12);
+    EXPECT_NEAR(summary.entropy, marginal.entropy(), 1e-15);
+    EXPECT_NEAR(summary.mean, 4.5, 1e-4);
+    EXPECT_NEAR(summary.variance, 4.5, 1e-3);
+}
+
+INSTANTIATE_TEST_SUITE_P(AllKernels, KernelsTest,
+    ::testing::Values(kernels::KernelISA::generic, kernels::KernelISA::avx2, kernels::KernelISA::avx512),
+    [] (const auto & info) { return std::string(kernels::to_string(info.param)); });
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,125 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "LockstepEJD.hpp"
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasures.hpp"
+// 3rd party
+#include "gtest/gtest.h"
+// std lib
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace ejd;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Lockstep EJD Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// small Poisson problems of different lengths, and a few with tied or short cdfs
+static std::vector<EmpDistrArray> make_problems(std::size_t n, int dim, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> lambda(0.2, 6.0);
+    std::vector<EmpDistrArray> problems;
+    for (std::size_t p = 0; p < n; ++p) {
+        std::vector<double> intensities(dim);
+        for (auto & x : intensities) {
+            x = lambda(gen);
+        }
+        if (p % 5 == 3) {
+            // identical marginals tie at every breakpoint
+            std::fill(intensities.begin(), intensities.end(), intensities[0]);
+        }
+        problems.push_back(construct_Poisson_EmpDistrArray(intensities));
+    }
+    // a marginal whose mass stops short of 1, and a single atom
+    std::vector<EmpiricalDistribution> marginals(dim, EmpiricalDistribution{.weights = {0.25, 0.5, 0.25}, .support = {0, 1, 2}});
+    marginals[0] = EmpiricalDistribution{.weights = {0.5, 0.25, 0.125}, .support = {1, 3, 4}};
+    marginals[dim - 1] = EmpiricalDistribution{.weights = {1.0}, .support = {7}};
+    problems.insert(problems.begin() + n / 2, EmpDistrArray(marginals));
+    return problems;
+}
+
+static void expect_same(const ExtremeMeasureView& v, const ExtremeMeasure& reference)
+{
+    ASSERT_EQ(v.size, reference.support.size());
+    for (std::size_t i = 0; i < v.size; ++i) {
+        EXPECT_EQ(v.weights[i], reference.weights[i]);
+        EXPECT_EQ(v.point(i), reference.support[i]);
+    }
+}
+
+TEST(LockstepEJD, MATCHES_EJD)
+{
+    for (int dim = 2; dim <= 4; ++dim) {
+        const auto problems = make_problems(37, dim, dim);
+        const MonotonicityStructure structures(dim);
+        for (int s = 0; s < structures.num_extremepts(); ++s) {
+            const auto ms = structures[s];
+            for (int lanes : {4, 8, 16}) {
+                const auto batch = lockstep_ejd(problems, ms, EJDOptions(), lanes);
+                ASSERT_EQ(batch.size(), problems.size());
+                for (std::size_t p = 0; p < problems.size(); ++p) {
+                    expect_same(batch.view(p), ejd::ejd(problems[p], ms));
+                }
+            }
+        }
+    }
+}
+
+TEST(LockstepEJD, OPTIONS)
+{
+    const auto problems = make_problems(20, 2, 11);
+    const std::vector<int> ms {1, -1};
+    EJDOptions options;
+    options.coalesce_tol = 1e-3;
+    options.threads = 3;
+    const auto batch = lockstep_ejd(problems, ms, options);
+    const auto means = problems[4].means();
+    for (std::size_t p = 0; p < problems.size(); ++p) {
+        expect_same(batch.view(p), ejd::ejd(problems[p], ms, options));
+    }
+    EXPECT_EQ(batch.view(4).means[0], means[0]);
+    EXPECT_EQ(batch.view(4).means[1], means[1]);
+}
+
+TEST(LockstepEJD, INVALID_ARGUMENTS)
+{
+    const auto problems = make_problems(3, 2, 1);
+    EXPECT_EQ(lockstep_ejd({}, {1, 1}).size(), 0u);
+    EXPECT_THROW(lockstep_ejd(problems, {1, 1}, EJDOptions(), 2), std::invalid_argument);
+    EXPECT_THROW(lockstep_ejd(problems, {1, 1, 1}), std::invalid_argument);
+    EJDOptions options;
+    options.arithmetic = EJDArithmetic::fixed64;
+    EXPECT_THROW(lockstep_ejd(problems, {1, 1}, options), std::invalid_argument);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
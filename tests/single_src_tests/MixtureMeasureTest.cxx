@@ -0,0 +1,185 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Correlation.hpp"
+#include "ExtremeMeasures.hpp"
+#include "MixtureMeasure.hpp"
+// 3rd party
+#include "gtest/gtest.h"
+// std lib
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace ejd;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Mixture Measure Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+struct MixtureMeasureTest : public ::testing::Test
+{
+    ExtremeMeasures pms = construct_Poisson_ExtremeMeasures({3,5});
+    MixtureMeasure mixture = construct_MixtureMeasure(pms, {0.25, 0.75});
+    // the same mixture with its support merged by hand
+    DiscreteMeasure merged;
+
+    MixtureMeasureTest() {
+        for (int c = 0; c < 2; ++c) {
+            DiscreteMeasure scaled {pms[c].support, pms[c].weights};
+            for (auto & w : scaled.weights) {
+                w *= mixture.weights[c];
+            }
+            merged += scaled;
+        }
+    }
+
+    template <typename F>
+    double merged_expectation(F f) const {
+        double sum = 0;
+        for (std::size_t i = 0; i < merged.support.size(); ++i) {
+            sum += merged.weights[i] * f(merged.support[i]);
+        }
+        return sum;
+    }
+};
+
+TEST_F(MixtureMeasureTest, MOMENTS)
+{
+    for (unsigned threads : {1u, 2u}) {
+        auto mu = mixture.means(threads);
+        ASSERT_EQ(mu.size(), 2u);
+        // both components have the same (truncated) marginals
+        EXPECT_NEAR(mu[0], pms[0].means[0], 1e-12);
+        EXPECT_NEAR(mu[1], pms[0].means[1], 1e-12);
+        auto second = mixture.moments(2, threads);
+        EXPECT_NEAR(second[1], merged_expectation([] (const LatticePoint& p) { return p.point[1] * p.point[1]; }), 1e-9);
+        EXPECT_NEAR(mixture.cross_moment(0, 1, threads),
+            merged_expectation([] (const LatticePoint& p) { return p.point[0] * p.point[1]; }), 1e-9);
+    }
+}
+
+TEST_F(MixtureMeasureTest, CORRELATION_IS_MIXED)
+{
+    // the correlations of the components are the two extremes, the mixture lies in between
+    const double rho_plus = correlation(pms[0]);
+    const double rho_minus = correlation(pms[1]);
+    const double rho = mixture.correlation(0, 1);
+    EXPECT_GT(rho, std::min(rho_plus, rho_minus));
+    EXPECT_LT(rho, std::max(rho_plus, rho_minus));
+    // covariances mix linearly, as the marginals are the same in both components
+    const double sigma = std::sqrt(pms[0].variances[0] * pms[0].variances[1]);
+    EXPECT_NEAR(mixture.covariance(0, 1), (0.25 * rho_plus + 0.75 * rho_minus) * sigma, 1e-9);
+}
+
+TEST_F(MixtureMeasureTest, TAIL_PROBABILITIES)
+{
+    EXPECT_NEAR(mixture.tail_probability(1, 7),
+        merged_expectation([] (const LatticePoint& p) { return p.point[1] >= 7 ? 1.0 : 0.0; }), 1e-12);
+    EXPECT_NEAR(mixture.joint_tail_probability(LatticePoint({4,6})),
+        merged_expectation([] (const LatticePoint& p) { return p.point[0] >= 4 && p.point[1] >= 6 ? 1.0 : 0.0; }), 1e-12);
+    EXPECT_NEAR(mixture.tail_probability(0, 0), 1.0, 1e-12);
+}
+
+TEST_F(MixtureMeasureTest, MATERIALIZE)
+{
+    auto dm = mixture.materialize(2);
+    ASSERT_EQ(dm.size(), merged.size());
+    EXPECT_EQ(dm.support, merged.support);
+    for (std::size_t i = 0; i < dm.weights.size(); ++i) {
+        EXPECT_NEAR(dm.weights[i], merged.weights[i], 1e-15);
+    }
+}
+
+TEST_F(MixtureMeasureTest, SAMPLE)
+{
+    std::mt19937_64 gen(2);
+    const std::size_t n = 100000;
+    auto points = mixture.sample(gen, n);
+    ASSERT_EQ(points.size(), 2 * n);
+    double mean = 0;
+    for (std::size_t s = 0; s < n; ++s) {
+        mean += static_cast<double>(points[2 * s + 1]) / n;
+    }
+    EXPECT_NEAR(mean, 5.0, 0.05);
+}
+
+TEST_F(MixtureMeasureTest, SHARES_COMPONENTS)
+{
+    auto shared = std::make_shared<const ExtremeMeasure>(pms[0]);
+    auto mm = construct_MixtureMeasure({shared, shared}, {0.5, 0.5});
+    EXPECT_EQ(mm.components[0].get(), shared.get());
+    EXPECT_NEAR(mm.means()[0], pms[0].means[0], 1e-12);
+}
+
+TEST(MixtureMeasure, INVALID)
+{
+    auto pms = construct_Poisson_ExtremeMeasures({3,5});
+    EXPECT_THROW(construct_MixtureMeasure(pms, {1.0}), std::invalid_argument);
+    EXPECT_THROW(construct_MixtureMeasure(pms, {1.5, -0.5}), std::invalid_argument);
+    auto other = construct_Poisson_ExtremeMeasures({3,5,7});
+    EXPECT_THROW(construct_MixtureMeasure({pms[0], other[0]}, {0.5, 0.5}), std::invalid_argument);
+    // nothing to draw from
+    EXPECT_THROW(construct_MixtureMeasure(pms, {0.0, 0.0}), std::invalid_argument);
+    EXPECT_THROW(construct_MixtureMeasure(ExtremeMeasures(), {}), std::invalid_argument);
+}
+
+TEST(MixtureMeasure, NORMALIZES_WEIGHTS)
+{
+    auto pms = construct_Poisson_ExtremeMeasures({2,3});
+    auto unnormalized = construct_MixtureMeasure(pms, {1.0, 1.0});
+    auto normalized = construct_MixtureMeasure(pms, {0.5, 0.5});
+    EXPECT_EQ(unnormalized.weights, normalized.weights);
+    EXPECT_DOUBLE_EQ(unnormalized.total_weight(), 1.0);
+    for (int j = 0; j < 2; ++j) {
+        EXPECT_NEAR(unnormalized.variances()[j], normalized.variances()[j], 1e-12);
+        EXPECT_GT(unnormalized.variances()[j], 0);
+    }
+    EXPECT_NEAR(unnormalized.correlation(0, 1), normalized.correlation(0, 1), 1e-12);
+    auto merged = unnormalized.materialize();
+    EXPECT_NEAR(std::accumulate(merged.weights.begin(), merged.weights.end(), 0.0), 1.0, 1e-12);
+}
+
+TEST(MixtureMeasure, SAMPLES_SKIP_ZERO_WEIGHTS)
+{
+    auto pms = construct_Poisson_ExtremeMeasures({3,5});
+    auto mm = construct_MixtureMeasure(pms, {1.0, 0.0});
+    std::mt19937_64 gen(7);
+    auto points = mm.sample(gen, 1000);
+    for (std::size_t s = 0; s < 1000; ++s) {
+        LatticePoint p({points[2 * s], points[2 * s + 1]});
+        EXPECT_NE(std::find(pms[0].support.begin(), pms[0].support.end(), p), pms[0].support.end());
+    }
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
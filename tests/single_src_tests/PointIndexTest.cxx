@@ -0,0 +1,163 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+#include "ExtremeMeasures.hpp"
+#include "PointIndex.hpp"
+// 3rd party
+#include "gtest/gtest.h"
+// std lib
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+using namespace ejd;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Lattice Point Hash Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+TEST(LatticePointHash, EQUAL_POINTS_EQUAL_HASHES)
+{
+    std::hash<LatticePoint> h;
+    EXPECT_EQ(h(LatticePoint({1,2,3})), h(LatticePoint({1,2,3})));
+    EXPECT_EQ(h(LatticePoint({1,-2,1 << 20})), h(LatticePoint({1,-2,1 << 20})));
+    EXPECT_EQ(LatticePointHash()(LatticePoint({4,5})), h(LatticePoint({4,5})));
+}
+
+TEST(LatticePointHash, DISTINGUISHES_POINTS)
+{
+    std::hash<LatticePoint> h;
+    EXPECT_NE(h(LatticePoint({0})), h(LatticePoint({0,0})));
+    EXPECT_NE(h(LatticePoint({1,2})), h(LatticePoint({2,1})));
+    EXPECT_NE(h(LatticePoint({-1,0})), h(LatticePoint({65535,0})));
+
+    // packed, two-word and streamed points: no collisions on a small grid
+    for (int dim : {2, 6, 12}) {
+        std::unordered_set<std::size_t> hashes;
+        int n = 0;
+        std::vector<int> p(dim, 0);
+        for (int a = -20; a < 20; ++a) {
+            for (int b = -20; b < 20; ++b) {
+                p[0] = a;
+                p[dim - 1] = b * 100000;
+                hashes.insert(h(LatticePoint(p)));
+                ++n;
+            }
+        }
+        EXPECT_EQ(hashes.size(), n);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Flat Point Map Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+TEST(FlatPointMap, INSERT_FIND)
+{
+    FlatPointMap map(3);
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(map.insert(LatticePoint({1,2,3})), std::make_pair(std::size_t(0), true));
+    EXPECT_EQ(map.insert(LatticePoint({3,2,1})), std::make_pair(std::size_t(1), true));
+    EXPECT_EQ(map.insert(LatticePoint({1,2,3})), std::make_pair(std::size_t(0), false));
+    EXPECT_EQ(map.size(), 2);
+    EXPECT_EQ(map.find(LatticePoint({3,2,1})), 1);
+    EXPECT_EQ(map.find(LatticePoint({3,2,2})), FlatPointMap::npos);
+    EXPECT_EQ(LatticePoint(std::vector<int>(map.point(1), map.point(1) + 3)), LatticePoint({3,2,1}));
+    map.clear();
+    EXPECT_EQ(map.find(LatticePoint({1,2,3})), FlatPointMap::npos);
+}
+
+TEST(FlatPointMap, MANY_POINTS)
+{
+    // grows through several rehashes
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> coord(-1000000, 1000000);
+    std::vector<LatticePoint> points;
+    for (int i = 0; i < 200000; ++i) {
+        points.emplace_back(LatticePoint({coord(gen), coord(gen), i}));
+    }
+    FlatPointMap map(3);
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        ASSERT_EQ(map.insert(points[i]).first, i);
+    }
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        ASSERT_EQ(map.find(points[i]), i);
+    }
+    EXPECT_EQ(map.find(LatticePoint({0,0,-1})), FlatPointMap::npos);
+}
+
+TEST(FlatPointMap, INDEX_SUPPORT)
+{
+    std::vector<LatticePoint> support {LatticePoint({0,0}), LatticePoint({1,0}), LatticePoint({0,0})};
+    auto map = index_support(support);
+    EXPECT_EQ(map.size(), 2);
+    EXPECT_EQ(map.find(support[2]), 0);
+}
+
+TEST(DiscreteMeasureAddition, MERGES_COMMON_POINTS)
+{
+    auto ems = construct_Poisson_ExtremeMeasures({2,3});
+    DiscreteMeasure a {ems[0].support, ems[0].weights};
+    DiscreteMeasure b {ems[1].support, ems[1].weights};
+    auto sum = a + b;
+
+    // every point once, with the sum of its weights
+    auto map = index_support(sum.support);
+    EXPECT_EQ(map.size(), sum.size());
+    double total = 0;
+    for (double w : sum.weights) {
+        total += w;
+    }
+    EXPECT_NEAR(total, 2., 1e-12);
+    for (const auto & p : a.support) {
+        EXPECT_EQ(std::count(sum.support.begin(), sum.support.end(), p), 1);
+    }
+    for (const auto & p : b.support) {
+        EXPECT_EQ(std::count(sum.support.begin(), sum.support.end(), p), 1);
+    }
+}
+
+TEST(DiscreteMeasureAddition, REJECTS_OTHER_DIMENSIONS)
+{
+    DiscreteMeasure a {{LatticePoint({0,0}), LatticePoint({1,0})}, {0.5, 0.5}};
+    DiscreteMeasure b {{LatticePoint({0,1,0})}, {1.0}};
+    EXPECT_THROW(a += b, std::invalid_argument);
+    // the unsorted path indexes the points with the dimension too
+    DiscreteMeasure c {{LatticePoint({1,0}), LatticePoint({0,0})}, {0.5, 0.5}};
+    EXPECT_THROW(c += b, std::invalid_argument);
+
+    DiscreteMeasure empty;
+    empty += b;
+    EXPECT_EQ(empty.size(), 1);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
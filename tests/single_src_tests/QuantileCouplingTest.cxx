@@ -0,0 +1,129 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasures.hpp"
+#include "QuantileCoupling.hpp"
+// 3rd party
+#include "gtest/gtest.h"
+// std lib
+#include <limits>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace ejd;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Quantile Coupling Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+struct QuantileCouplingTest : public ::testing::Test
+{
+    EmpDistrArray marginals = construct_Poisson_EmpDistrArray({3,5,7});
+    MonotonicityStructure structures = MonotonicityStructure(3);
+};
+
+// the midpoint of the cdf interval of every support point maps back to that point
+TEST_F(QuantileCouplingTest, MATCHES_EJD)
+{
+    for (int s = 0; s < structures.num_extremepts(); ++s) {
+        const auto ms = structures[s];
+        const auto em = ejd::ejd(marginals, ms);
+        const auto qc = construct_QuantileCoupling(marginals, ms);
+        double cdf = 0;
+        for (std::size_t i = 0; i < em.support.size(); ++i) {
+            const double u = cdf + em.weights[i] / 2;
+            cdf += em.weights[i];
+            if (em.weights[i] > 1e-9) {
+                EXPECT_EQ(qc.point(u), em.support[i]) << "structure " << s << ", point " << i;
+            }
+        }
+    }
+}
+
+TEST_F(QuantileCouplingTest, SORTED_BATCH)
+{
+    const auto qc = construct_QuantileCoupling(marginals, structures[1]);
+    std::vector<double> us {0.0, 1e-12, 0.1, 0.25, 0.25, 0.5, 0.77, 0.999999, 1.0};
+    auto points = qc.points_sorted(us);
+    ASSERT_EQ(points.size(), us.size() * 3);
+    for (std::size_t i = 0; i < us.size(); ++i) {
+        EXPECT_EQ(LatticePoint(std::vector<int>(points.begin() + 3 * i, points.begin() + 3 * i + 3)),
+            qc.point(us[i]));
+    }
+    EXPECT_THROW(qc.points_sorted({0.5, 0.1}), std::invalid_argument);
+}
+
+TEST_F(QuantileCouplingTest, SAMPLE_FREQUENCIES)
+{
+    const auto ms = structures[2];
+    const auto em = ejd::ejd(marginals, ms);
+    const auto qc = construct_QuantileCoupling(marginals, ms);
+
+    std::mt19937_64 gen(11);
+    const std::size_t n = 200000;
+    const auto points = qc.sample(gen, n);
+    std::map<std::vector<int>, double> frequencies;
+    for (std::size_t i = 0; i < n; ++i) {
+        frequencies[std::vector<int>(points.begin() + 3 * i, points.begin() + 3 * i + 3)] += 1.0 / n;
+    }
+    for (std::size_t i = 0; i < em.support.size(); ++i) {
+        if (em.weights[i] > 0.01) {
+            EXPECT_NEAR(frequencies[em.support[i].point], em.weights[i], 0.005);
+        }
+    }
+}
+
+TEST_F(QuantileCouplingTest, COMPACT)
+{
+    const auto qc = construct_QuantileCoupling(marginals, structures[0]);
+    const auto em = ejd::ejd(marginals, structures[0]);
+    EXPECT_EQ(qc.dimension(), 3);
+    EXPECT_LT(qc.memory_bytes(), em.support.size() * (sizeof(LatticePoint) + 3 * sizeof(int)));
+}
+
+TEST_F(QuantileCouplingTest, INVALID)
+{
+    EXPECT_THROW(construct_QuantileCoupling(marginals, {1,-1}), std::invalid_argument);
+    EXPECT_THROW(construct_QuantileCoupling(marginals, {1,-1,1,1}), std::invalid_argument);
+    EXPECT_THROW(construct_QuantileCoupling(marginals, {1,0,1}), std::invalid_argument);
+
+    // NaN is a defined atom, the one of 0, and is rejected by the sorted batch
+    const auto qc = construct_QuantileCoupling(marginals, structures[1]);
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    for (int j = 0; j < 3; ++j) {
+        EXPECT_EQ(qc.atom(j, nan), qc.atom(j, 0.0));
+    }
+    EXPECT_EQ(qc.point(nan), qc.point(0.0));
+    EXPECT_THROW(qc.points_sorted({0.1, nan}), std::invalid_argument);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,177 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "StructureGenerators.hpp"
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasures.hpp"
+// gtest
+#include "gtest/gtest.h"
+// std libs
+#include <set>
+#include <vector>
+
+using namespace ejd;
+
+static void expect_same(const ExtremeMeasure& x, const ExtremeMeasure& y)
+{
+    ASSERT_EQ(x.support.size(), y.support.size());
+    for (std::size_t i = 0; i < x.support.size(); ++i) {
+        EXPECT_EQ(x.support[i], y.support[i]) << i;
+    }
+    EXPECT_EQ(x.weights, y.weights);
+    EXPECT_EQ(x.monotone_structure, y.monotone_structure);
+}
+
+TEST(StructureGenerators, PACKING)
+{
+    const MonotonicityStructure ms(6);
+    for (int s = 0; s < ms.num_extremepts(); ++s) {
+        const auto mask = pack_structure(ms[s]);
+        ASSERT_EQ(mask.words.size(), 1);
+        EXPECT_EQ(mask.words[0], std::uint64_t(s) << 1);
+        EXPECT_EQ(mask.signs(), ms[s]);
+    }
+    // mirror images pack the same
+    EXPECT_EQ(pack_structure({-1, 1, -1, -1}), pack_structure({1, -1, 1, 1}));
+
+    // past one word
+    std::vector<int> signs(130, 1);
+    signs[64] = signs[129] = -1;
+    const auto mask = pack_structure(signs);
+    ASSERT_EQ(mask.words.size(), 3);
+    EXPECT_TRUE(mask.flipped(64) && mask.flipped(129) && !mask.flipped(63));
+    EXPECT_EQ(mask.signs(), signs);
+}
+
+TEST(StructureGenerators, RANDOM)
+{
+    const int dim = 100;
+    RandomStructures structures(dim, 200, 11);
+    EXPECT_EQ(structures.dimension(), dim);
+    StructureMask mask;
+    std::set<std::vector<std::uint64_t>> seen;
+    std::size_t count = 0;
+    std::size_t flips = 0;
+    while (structures.next(&mask)) {
+        ++count;
+        EXPECT_EQ(mask.dim, dim);
+        EXPECT_FALSE(mask.flipped(0));
+        EXPECT_EQ(mask.words.back() >> (dim % 64), 0);
+        for (int j = 0; j < dim; ++j) {
+            flips += mask.flipped(j);
+        }
+        seen.insert(mask.words);
+    }
+    EXPECT_EQ(count, 200);
+    EXPECT_EQ(seen.size(), 200);
+    EXPECT_NEAR(double(flips) / (count * (dim - 1)), 0.5, 0.02);
+
+    // the same seed gives the same structures
+    RandomStructures again(dim, 1, 11);
+    RandomStructures first(dim, 1, 11);
+    StructureMask x, y;
+    ASSERT_TRUE(again.next(&x) && first.next(&y));
+    EXPECT_EQ(x, y);
+}
+
+TEST(StructureGenerators, SIGN_PATTERN)
+{
+    // a pattern that one structure fits exactly
+    const int dim = 40;
+    std::vector<int> tau(dim);
+    for (int j = 0; j < dim; ++j) {
+        tau[j] = (j % 3 == 1) ? -1 : 1;
+    }
+    std::vector<int> target(dim * dim);
+    for (int i = 0; i < dim; ++i) {
+        for (int j = 0; j < dim; ++j) {
+            target[i * dim + j] = tau[i] * tau[j];
+        }
+    }
+    SignPatternStructures exact(dim, target, 5, 1.0);
+    StructureMask mask;
+    while (exact.next(&mask)) {
+        EXPECT_EQ(mask, pack_structure(tau));
+    }
+
+    // with a lower fidelity most pairs still have the wanted sign
+    SignPatternStructures loose(dim, target, 50, 0.9, 3);
+    std::size_t agree = 0;
+    std::size_t pairs = 0;
+    while (loose.next(&mask)) {
+        const auto signs = mask.signs();
+        for (int i = 0; i < dim; ++i) {
+            for (int j = i + 1; j < dim; ++j) {
+                agree += signs[i] * signs[j] == target[i * dim + j];
+                ++pairs;
+            }
+        }
+    }
+    EXPECT_GT(double(agree) / pairs, 0.75);
+
+    EXPECT_THROW(SignPatternStructures(3, {1, 1}, 1), std::invalid_argument);
+    EXPECT_THROW(SignPatternStructures(2, {0, 2, 0, 0}, 1), std::invalid_argument);
+}
+
+TEST(StructureGenerators, STREAM_MATCHES_EJD)
+{
+    const auto marginals = construct_Poisson_EmpDistrArray({2, 5, 3.5, 8, 1, 6});
+    std::vector<StructureMask> masks;
+    RandomStructures random(6, 40, 5);
+    StructureMask mask;
+    while (random.next(&mask)) {
+        masks.push_back(mask);
+    }
+    masks.push_back(pack_structure({-1, 1, 1, -1, -1, 1}));
+
+    for (unsigned threads : {0u, 3u}) {
+        ExplicitStructures structures(6, masks);
+        std::size_t expected = 0;
+        auto sink = [&] (std::size_t k, const StructureMask& m, const ExtremeMeasureView& view) {
+            EXPECT_EQ(k, expected++);
+            EXPECT_EQ(m, k < 40 ? masks[k] : pack_structure({1, -1, -1, 1, 1, -1}));
+            const auto em = view.to_ExtremeMeasure();
+            expect_same(em, ejd::ejd(marginals, m.signs(), EJDOptions()));
+            EXPECT_EQ(em.means, marginals.means());
+        };
+        std::size_t count;
+        if (threads == 0) {
+            count = stream_ejd(marginals, structures, sink);
+        } else {
+            ThreadPool pool(threads);
+            count = stream_ejd(marginals, structures, sink, pool);
+        }
+        EXPECT_EQ(count, masks.size());
+        EXPECT_EQ(expected, masks.size());
+    }
+
+    RandomStructures other(5, 1);
+    EXPECT_THROW(stream_ejd(marginals, other, [] (std::size_t, const StructureMask&, const ExtremeMeasureView&) {}),
+        std::invalid_argument);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,142 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "BinaryFormat.hpp"
+#include "ExtremeMeasures.hpp"
+#include "TextFormat.hpp"
+// 3rd party
+#include "gtest/gtest.h"
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+// std lib
+#include <cstdio>
+#include <filesystem>
+namespace fs = std::filesystem;
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace ejd;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Text Format Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+struct TextFormatTest : public ::testing::Test
+{
+    ExtremeMeasures pms = construct_Poisson_ExtremeMeasures({3,5});
+    fs::path path = fs::temp_directory_path() / "ejd_text_format_test.txt";
+
+    ~TextFormatTest() {
+        fs::remove(path);
+    }
+
+    std::string contents() const {
+        std::ifstream f(path);
+        std::stringstream ss;
+        ss << f.rdbuf();
+        return ss.str();
+    }
+};
+
+TEST_F(TextFormatTest, CSV_ROUND_TRIP)
+{
+    const auto & em = pms[1];
+    write_csv(path.string(), em);
+
+    std::ifstream f(path);
+    std::string line;
+    std::getline(f, line);
+    EXPECT_EQ(line, "weight,x0,x1");
+
+    std::size_t i = 0;
+    while (std::getline(f, line)) {
+        ASSERT_LT(i, em.support.size());
+        double w;
+        int x0, x1;
+        ASSERT_EQ(std::sscanf(line.c_str(), "%lf,%d,%d", &w, &x0, &x1), 3);
+        EXPECT_EQ(w, em.weights[i]);
+        EXPECT_EQ(LatticePoint({x0,x1}), em.support[i]);
+        ++i;
+    }
+    EXPECT_EQ(i, em.support.size());
+    EXPECT_EQ(contents().find('\033'), std::string::npos);
+}
+
+TEST_F(TextFormatTest, JSON_ROUND_TRIP)
+{
+    write_json(path.string(), pms);
+    auto j = json::parse(contents());
+
+    ASSERT_EQ(j.size(), pms.size());
+    for (std::size_t k = 0; k < pms.size(); ++k) {
+        EXPECT_EQ(j[k]["dimension"].get<int>(), 2);
+        EXPECT_EQ(j[k]["monotone_structure"].get<std::vector<int>>(), pms[k].monotone_structure);
+        EXPECT_EQ(j[k]["weights"].get<std::vector<double>>(), pms[k].weights);
+        EXPECT_EQ(j[k]["means"].get<std::vector<double>>(), pms[k].means);
+        auto columns = j[k]["support"].get<std::vector<std::vector<int>>>();
+        ASSERT_EQ(columns.size(), 2u);
+        for (std::size_t i = 0; i < pms[k].support.size(); ++i) {
+            EXPECT_EQ(LatticePoint({columns[0][i], columns[1][i]}), pms[k].support[i]);
+        }
+    }
+}
+
+// views stream straight from the mapped columns; missing means become null
+TEST_F(TextFormatTest, VIEW_MATCHES_MEASURE)
+{
+    auto em = pms[0];
+    em.means.clear();
+    em.variances.clear();
+    fs::path bin = fs::temp_directory_path() / "ejd_text_format_test.ejd";
+    write_binary(bin.string(), EmpDistrArray(), {em});
+    MappedExtremeMeasures mapped(bin.string());
+
+    std::FILE * f = std::fopen(path.c_str(), "w");
+    write_json(f, mapped[0]);
+    std::fclose(f);
+    fs::remove(bin);
+
+    auto j = json::parse(contents());
+    EXPECT_TRUE(j["means"][0].is_null());
+    EXPECT_EQ(j["weights"].get<std::vector<double>>(), em.weights);
+}
+
+TEST_F(TextFormatTest, WRITE_ERRORS_THROW)
+{
+    // the data is only written out when the file is closed
+    if (!fs::exists("/dev/full")) {
+        GTEST_SKIP() << "no /dev/full";
+    }
+    EXPECT_THROW(write_csv("/dev/full", pms[0]), std::runtime_error);
+    EXPECT_THROW(write_json("/dev/full", pms), std::runtime_error);
+    EXPECT_THROW(write_csv("/nonexistent/ejd.csv", pms[0]), std::runtime_error);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
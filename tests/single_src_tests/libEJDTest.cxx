@@ -0,0 +1,218 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "libEJD.h"
+#include "Correlation.hpp"
+#include "ExtremeMeasures.hpp"
+// 3rd party
+#include "gtest/gtest.h"
+// std lib
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace ejd;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// C Interface Tests
+//
+//////////////////////////////////////////////////////////////////////////////
+
+TEST(libEJD, STATUS_AND_ERRORS)
+{
+    EXPECT_STREQ(ejd_status_string(EJD_OK), "ok");
+    EXPECT_STREQ(ejd_status_string(EJD_BUFFER_TOO_SMALL), "buffer too small");
+
+    ejd_marginals * marginals = nullptr;
+    const double bad[] {1.0, -2.0};
+    EXPECT_EQ(ejd_marginals_poisson(bad, 2, &marginals), EJD_INVALID_ARGUMENT);
+    EXPECT_EQ(marginals, nullptr);
+    EXPECT_NE(std::string(ejd_last_error()), "");
+    EXPECT_EQ(ejd_marginals_poisson(nullptr, 2, &marginals), EJD_INVALID_ARGUMENT);
+    EXPECT_EQ(ejd_context_create(1, -1.0, nullptr), EJD_INVALID_ARGUMENT);
+
+    std::size_t count = 0;
+    EXPECT_EQ(ejd_num_structures(1, &count), EJD_INVALID_ARGUMENT);
+    EXPECT_EQ(ejd_num_structures(3, &count), EJD_OK);
+    EXPECT_EQ(count, 4u);
+    int ms[3];
+    EXPECT_EQ(ejd_structure(3, 4, ms), EJD_INVALID_ARGUMENT);
+
+    // destroying null handles is allowed
+    ejd_context_destroy(nullptr);
+    ejd_marginals_destroy(nullptr);
+    ejd_measure_destroy(nullptr);
+}
+
+TEST(libEJD, MEASURES_MATCH)
+{
+    const std::vector<double> intensities {3, 5, 7};
+    const auto reference = construct_Poisson_ExtremeMeasures(intensities);
+
+    ejd_context * context = nullptr;
+    ejd_marginals * marginals = nullptr;
+    ASSERT_EQ(ejd_context_create(2, 0, &context), EJD_OK);
+    ASSERT_EQ(ejd_marginals_poisson(intensities.data(), intensities.size(), &marginals), EJD_OK);
+
+    std::size_t dim = 0;
+    ASSERT_EQ(ejd_marginals_dimension(marginals, &dim), EJD_OK);
+    ASSERT_EQ(dim, 3u);
+    std::vector<double> means(dim);
+    ASSERT_EQ(ejd_marginals_moments(marginals, means.data(), nullptr), EJD_OK);
+    EXPECT_EQ(means, reference[0].means);
+
+    std::size_t count = 0;
+    ASSERT_EQ(ejd_num_structures(dim, &count), EJD_OK);
+    ASSERT_EQ(count, reference.size());
+    for (std::size_t s = 0; s < count; ++s) {
+        std::vector<int> ms(dim);
+        ASSERT_EQ(ejd_structure(dim, s, ms.data()), EJD_OK);
+        EXPECT_EQ(ms, reference[s].monotone_structure);
+
+        ejd_measure * measure = nullptr;
+        ASSERT_EQ(ejd_measure_compute(context, marginals, ms.data(), &measure), EJD_OK);
+        std::size_t size = 0;
+        ASSERT_EQ(ejd_measure_size(measure, &size, nullptr), EJD_OK);
+        ASSERT_EQ(size, reference[s].support.size());
+
+        std::vector<double> weights(size);
+        std::vector<int> coords(size * dim);
+        EXPECT_EQ(ejd_measure_copy(measure, weights.data(), size, coords.data(), coords.size() - 1), EJD_BUFFER_TOO_SMALL);
+        ASSERT_EQ(ejd_measure_copy(measure, weights.data(), size, coords.data(), coords.size()), EJD_OK);
+        EXPECT_EQ(weights, reference[s].weights);
+        for (std::size_t i = 0; i < size; ++i) {
+            for (std::size_t j = 0; j < dim; ++j) {
+                EXPECT_EQ(coords[j * size + i], reference[s].support[i].point[j]);
+            }
+        }
+
+        double correlation = 0;
+        EXPECT_EQ(ejd_measure_correlation(measure, &correlation), EJD_INVALID_ARGUMENT);
+        ejd_measure_destroy(measure);
+    }
+
+    const int bad_structure[] {1, 0, -1};
+    ejd_measure * measure = nullptr;
+    EXPECT_EQ(ejd_measure_compute(context, marginals, bad_structure, &measure), EJD_INVALID_ARGUMENT);
+
+    ejd_marginals_destroy(marginals);
+    ejd_context_destroy(context);
+}
+
+TEST(libEJD, CORRELATION_BOUNDS)
+{
+    const std::vector<double> intensities {3, 5, 0.5, 12, 8, 8};
+    const std::size_t n = intensities.size() / 2;
+    ejd_context * context = nullptr;
+    ASSERT_EQ(ejd_context_create(3, 0, &context), EJD_OK);
+
+    std::vector<double> lower(n);
+    std::vector<double> upper(n);
+    ASSERT_EQ(ejd_correlation_bounds(context, intensities.data(), n, lower.data(), upper.data()), EJD_OK);
+    for (std::size_t p = 0; p < n; ++p) {
+        const auto ems = construct_Poisson_ExtremeMeasures({intensities[2 * p], intensities[2 * p + 1]});
+        const double a = correlation(ems[0]);
+        const double b = correlation(ems[1]);
+        EXPECT_NEAR(lower[p], std::min(a, b), 1e-12);
+        EXPECT_NEAR(upper[p], std::max(a, b), 1e-12);
+        EXPECT_LT(lower[p], 0);
+        EXPECT_GT(upper[p], 0);
+    }
+
+    // a single measure gives the same correlation
+    ejd_marginals * marginals = nullptr;
+    ejd_measure * measure = nullptr;
+    const int ms[] {1, 1};
+    ASSERT_EQ(ejd_marginals_poisson(intensities.data(), 2, &marginals), EJD_OK);
+    ASSERT_EQ(ejd_measure_compute(context, marginals, ms, &measure), EJD_OK);
+    double rho = 0;
+    ASSERT_EQ(ejd_measure_correlation(measure, &rho), EJD_OK);
+    EXPECT_NEAR(rho, upper[0], 1e-12);
+
+    ejd_measure_destroy(measure);
+    ejd_marginals_destroy(marginals);
+    ejd_context_destroy(context);
+}
+
+TEST(libEJD, SAMPLES)
+{
+    // two empirical marginals given atom by atom
+    const std::size_t lengths[] {3, 2};
+    const double weights[] {0.2, 0.3, 0.5, 0.6, 0.4};
+    const double support[] {0, 1, 2, 10, 20};
+    const double unsorted[] {0, 2, 1, 10, 20};
+    ejd_marginals * marginals = nullptr;
+    EXPECT_EQ(ejd_marginals_create(2, lengths, weights, unsorted, &marginals), EJD_INVALID_ARGUMENT);
+    ASSERT_EQ(ejd_marginals_create(2, lengths, weights, support, &marginals), EJD_OK);
+
+    ejd_context * one = nullptr;
+    ejd_context * four = nullptr;
+    ASSERT_EQ(ejd_context_create(1, 0, &one), EJD_OK);
+    ASSERT_EQ(ejd_context_create(4, 0, &four), EJD_OK);
+
+    const int ms[] {1, -1};
+    const std::size_t n = 50000;
+    std::vector<int> a(2 * n);
+    std::vector<int> b(2 * n);
+    EXPECT_EQ(ejd_sample(one, marginals, ms, 7, n, a.data(), a.size() - 1), EJD_BUFFER_TOO_SMALL);
+    ASSERT_EQ(ejd_sample(one, marginals, ms, 7, n, a.data(), a.size()), EJD_OK);
+    ASSERT_EQ(ejd_sample(four, marginals, ms, 7, n, b.data(), b.size()), EJD_OK);
+    EXPECT_EQ(a, b);
+
+    // countermonotone: the largest first coordinate comes with the smallest second one
+    std::size_t top = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (a[2 * i] == 2) {
+            EXPECT_EQ(a[2 * i + 1], 10);
+            ++top;
+        }
+    }
+    EXPECT_NEAR(double(top) / n, 0.5, 0.01);
+
+    ejd_context_destroy(four);
+    ejd_context_destroy(one);
+    ejd_marginals_destroy(marginals);
+}
+
+TEST(libEJD, SUPPORT_OF_INTS)
+{
+    const std::size_t lengths[] {2};
+    const double weights[] {0.5, 0.5};
+    const double fractional[] {0.5, 1.5};
+    const double too_large[] {3e10, 4e10};
+    const double negative[] {-2147483648.0, -1};
+    ejd_marginals * marginals = nullptr;
+    EXPECT_EQ(ejd_marginals_create(1, lengths, weights, fractional, &marginals), EJD_INVALID_ARGUMENT);
+    EXPECT_EQ(ejd_marginals_create(1, lengths, weights, too_large, &marginals), EJD_INVALID_ARGUMENT);
+    EXPECT_EQ(marginals, nullptr);
+    ASSERT_EQ(ejd_marginals_create(1, lengths, weights, negative, &marginals), EJD_OK);
+    ejd_marginals_destroy(marginals);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
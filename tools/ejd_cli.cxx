@@ -0,0 +1,476 @@
+/*
+    This file is part of EJD.
+
+    Copyright © 2020
+              Michael Chiu <chiu@cs.toronto.edu>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+// Command-line batch driver: reads one problem per record, computes correlation bounds,
+// extreme measures or samples on a thread pool and streams the results out as CSV, in
+// input order. A summary of throughput, per-problem latency and peak memory goes to stderr.
+
+#include "BinaryFormat.hpp"
+#include "Correlation.hpp"
+#include "EmpiricalDistribution.hpp"
+#include "ExtremeMeasures.hpp"
+#include "QuantileCoupling.hpp"
+#include "Utils/ThreadPool.hpp"
+// 3rd party libs
+#include <fmt/format.h>
+// std libs
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+// posix
+#include <sys/resource.h>
+
+using namespace ejd;
+
+namespace {
+
+const char * usage =
+	"usage: ejd_cli MODE [options]\n"
+	"\n"
+	"Modes, each writing CSV rows without a header:\n"
+	"  bounds     row,i,j,lower,upper   correlation bounds of every pair of marginals\n"
+	"  measures   row,structure,weight,x0,...,x{d-1}   every extreme measure\n"
+	"  samples    row,x0,...,x{d-1}   draws from the extreme measure of one structure\n"
+	"\n"
+	"Options:\n"
+	"  --input PATH       CSV of intensities, one problem per line (default: stdin, '-'),\n"
+	"                     or a file of the binary format, whose marginals form one problem\n"
+	"  --output PATH      (default: stdout)\n"
+	"  --threads N        worker threads, 0 for one per hardware thread (default: 1)\n"
+	"  --chunk N          problems read and computed together (default: 256)\n"
+	"  --samples N        draws per problem in samples mode (default: 1000)\n"
+	"  --structure K      monotone structure index in samples mode (default: 0)\n"
+	"  --seed S           sampling seed; the draws of a row depend only on it and the row\n"
+	"  --quiet            no summary on stderr\n";
+
+enum class Mode { bounds, measures, samples };
+
+struct Options
+{
+	Mode mode = Mode::bounds;
+	std::string input = "-";
+	std::string output = "-";
+	unsigned threads = 1;
+	std::size_t chunk = 256;
+	std::size_t samples = 1000;
+	int structure = 0;
+	std::uint64_t seed = 0;
+	bool quiet = false;
+};
+
+struct UsageError : std::runtime_error
+{
+	using std::runtime_error::runtime_error;
+};
+
+std::uint64_t parse_unsigned(const std::string& flag, const char * s)
+{
+	char * end = nullptr;
+	errno = 0;
+	const unsigned long long x = std::strtoull(s, &end, 10);
+	if (!*s || *end || errno || s[0] == '-') {
+		throw UsageError(fmt::format("{} expects a non-negative integer, got '{}'", flag, s));
+	}
+	return x;
+}
+
+Options parse_options(int argc, char ** argv)
+{
+	if (argc < 2) {
+		throw UsageError("missing mode");
+	}
+	Options options;
+	const std::string mode = argv[1];
+	if (mode == "bounds") {
+		options.mode = Mode::bounds;
+	} else if (mode == "measures") {
+		options.mode = Mode::measures;
+	} else if (mode == "samples") {
+		options.mode = Mode::samples;
+	} else {
+		throw UsageError(fmt::format("unknown mode '{}'", mode));
+	}
+
+	for (int a = 2; a < argc; ++a) {
+		const std::string flag = argv[a];
+		if (flag == "--quiet") {
+			options.quiet = true;
+			continue;
+		}
+		if (a + 1 >= argc) {
+			throw UsageError(fmt::format("{} expects a value", flag));
+		}
+		const char * value = argv[++a];
+		if (flag == "--input") {
+			options.input = value;
+		} else if (flag == "--output") {
+			options.output = value;
+		} else if (flag == "--threads") {
+			options.threads = parse_unsigned(flag, value);
+		} else if (flag == "--chunk") {
+			options.chunk = std::max<std::uint64_t>(parse_unsigned(flag, value), 1);
+		} else if (flag == "--samples") {
+			options.samples = parse_unsigned(flag, value);
+		} else if (flag == "--structure") {
+			const auto structure = parse_unsigned(flag, value);
+			if (structure > static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+				throw UsageError(fmt::format("{} is out of range, got '{}'", flag, value));
+			}
+			options.structure = static_cast<int>(structure);
+		} else if (flag == "--seed") {
+			options.seed = parse_unsigned(flag, value);
+		} else {
+			throw UsageError(fmt::format("unknown option '{}'", flag));
+		}
+	}
+	return options;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Input
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// a problem: the intensities of Poisson marginals, or marginals read as they are
+struct Problem
+{
+	std::size_t row = 0;
+	std::vector<double> intensities;
+	EmpDistrArray marginals;
+	bool has_marginals = false;
+};
+
+bool is_binary(const std::string& path)
+{
+	if (path == "-") {
+		return false;
+	}
+	std::ifstream file(path, std::ios::binary);
+	char magic[sizeof(binary_magic)] = {};
+	file.read(magic, sizeof(magic));
+	return file && std::memcmp(magic, binary_magic, sizeof(magic)) == 0;
+}
+
+// Streams the problems of a CSV of intensities: numbers separated by commas, semicolons or
+// blanks, '#' comments and blank lines skipped, and a first line that is not numeric taken
+// as a header.
+class ProblemReader
+{
+public:
+	explicit ProblemReader(const std::string& path) {
+		if (path == "-") {
+			in = &std::cin;
+		}
+		else if (is_binary(path)) {
+			MappedExtremeMeasures file(path);
+			binary.marginals = file.marginals();
+			binary.has_marginals = true;
+			pending_binary = true;
+		}
+		else {
+			file.open(path);
+			if (!file) {
+				throw std::runtime_error(fmt::format("cannot open {}: {}", path, std::strerror(errno)));
+			}
+			in = &file;
+		}
+	}
+
+	// up to n more problems, false once the input is exhausted
+	bool next(std::vector<Problem>& problems, std::size_t n) {
+		problems.clear();
+		if (pending_binary) {
+			pending_binary = false;
+			problems.push_back(std::move(binary));
+			return true;
+		}
+		std::string line;
+		while (in && problems.size() < n && std::getline(*in, line)) {
+			++line_number;
+			Problem p;
+			if (!parse(line, p.intensities)) {
+				continue;
+			}
+			p.row = rows++;
+			problems.push_back(std::move(p));
+		}
+		return !problems.empty();
+	}
+
+private:
+	std::istream * in = nullptr;
+	std::ifstream file;
+	Problem binary;
+	bool pending_binary = false;
+	std::size_t line_number = 0;
+	std::size_t rows = 0;
+	bool header = false;
+
+	bool parse(const std::string& line, std::vector<double>& intensities) {
+		const char * s = line.c_str();
+		while (*s) {
+			while (*s == ',' || *s == ';' || std::isspace(static_cast<unsigned char>(*s))) {
+				++s;
+			}
+			if (!*s || *s == '#') {
+				break;
+			}
+			char * end = nullptr;
+			const double x = std::strtod(s, &end);
+			if (end == s) {
+				if (rows == 0 && !header && intensities.empty()) {
+					header = true;
+					return false;
+				}
+				throw std::runtime_error(fmt::format("line {}: not a number: '{}'", line_number, line));
+			}
+			if (!(x > 0) || !std::isfinite(x)) {
+				throw std::runtime_error(fmt::format("line {}: intensities must be positive", line_number));
+			}
+			intensities.push_back(x);
+			s = end;
+		}
+		if (intensities.size() == 1) {
+			throw std::runtime_error(fmt::format("line {}: a problem needs at least two intensities", line_number));
+		}
+		return !intensities.empty();
+	}
+};
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Problems
+//
+//////////////////////////////////////////////////////////////////////////////
+
+const EmpDistrArray& marginals_of(Problem& p)
+{
+	if (!p.has_marginals) {
+		p.marginals = construct_Poisson_EmpDistrArray(p.intensities);
+		p.has_marginals = true;
+	}
+	return p.marginals;
+}
+
+void bounds(Problem& p, fmt::memory_buffer& out)
+{
+	const auto & marginals = marginals_of(p);
+	const int dim = marginals.dimensions();
+	const auto & summaries = marginals.summaries();
+	for (int i = 0; i < dim; ++i) {
+		for (int j = i + 1; j < dim; ++j) {
+			const EmpDistrArray pair(std::vector<EmpiricalDistribution> {marginals.marginals[i], marginals.marginals[j]});
+			double rho[2];
+			for (int s = 0; s < 2; ++s) {
+				auto em = ejd::ejd(pair, {1, s == 0 ? 1 : -1});
+				em.means = {summaries[i].mean, summaries[j].mean};
+				em.variances = {summaries[i].variance, summaries[j].variance};
+				rho[s] = correlation(em);
+			}
+			fmt::format_to(std::back_inserter(out), "{},{},{},{},{}\n", p.row, i, j, rho[1], rho[0]);
+		}
+	}
+}
+
+void measures(Problem& p, fmt::memory_buffer& out)
+{
+	const auto & marginals = marginals_of(p);
+	const MonotonicityStructure structures(marginals.dimensions());
+	for (int s = 0; s < structures.num_extremepts(); ++s) {
+		const auto em = ejd::ejd(marginals, structures[s]);
+		for (std::size_t i = 0; i < em.support.size(); ++i) {
+			fmt::format_to(std::back_inserter(out), "{},{},{}", p.row, s, em.weights[i]);
+			for (int x : em.support[i].point) {
+				fmt::format_to(std::back_inserter(out), ",{}", x);
+			}
+			out.push_back('\n');
+		}
+	}
+}
+
+void samples(Problem& p, const Options& options, fmt::memory_buffer& out)
+{
+	const auto & marginals = marginals_of(p);
+	const int dim = marginals.dimensions();
+	const MonotonicityStructure structures(dim);
+	if (options.structure >= structures.num_extremepts()) {
+		throw std::runtime_error(fmt::format("row {}: no monotone structure {} in dimension {}",
+			p.row, options.structure, dim));
+	}
+	const auto coupling = construct_QuantileCoupling(marginals, structures[options.structure]);
+	std::seed_seq seq {
+		static_cast<std::uint32_t>(options.seed), static_cast<std::uint32_t>(options.seed >> 32),
+		static_cast<std::uint32_t>(p.row), static_cast<std::uint32_t>(std::uint64_t(p.row) >> 32)
+	};
+	std::mt19937_64 gen(seq);
+	std::uniform_real_distribution<double> uniform(0.0, 1.0);
+	std::vector<int> point(dim);
+	for (std::size_t k = 0; k < options.samples; ++k) {
+		coupling.point(uniform(gen), point.data());
+		fmt::format_to(std::back_inserter(out), "{}", p.row);
+		for (int x : point) {
+			fmt::format_to(std::back_inserter(out), ",{}", x);
+		}
+		out.push_back('\n');
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Report
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// nearest-rank percentile, q in [0, 1]
+double percentile(std::vector<double>& v, double q)
+{
+	if (v.empty()) {
+		return 0;
+	}
+	const std::size_t k = std::min(v.size() - 1, static_cast<std::size_t>(std::ceil(q * v.size())) - (q > 0));
+	std::nth_element(v.begin(), v.begin() + k, v.end());
+	return v[k];
+}
+
+void report(std::vector<double>& latencies, double seconds, unsigned threads)
+{
+	const std::size_t n = latencies.size();
+	std::fprintf(stderr, "ejd: %zu problems in %.3f s on %u threads, %.1f problems/s\n",
+		n, seconds, threads, seconds > 0 ? n / seconds : 0.0);
+	const double p50 = percentile(latencies, 0.5);
+	const double p90 = percentile(latencies, 0.9);
+	const double p99 = percentile(latencies, 0.99);
+	const double max = percentile(latencies, 1);
+	std::fprintf(stderr, "ejd: latency ms p50 %.4f, p90 %.4f, p99 %.4f, max %.4f\n",
+		1e3 * p50, 1e3 * p90, 1e3 * p99, 1e3 * max);
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+		// kilobytes on Linux
+		std::fprintf(stderr, "ejd: peak RSS %.1f MiB\n", usage.ru_maxrss / 1024.0);
+	}
+}
+
+int run(const Options& options)
+{
+	using clock = std::chrono::steady_clock;
+	const auto start = clock::now();
+
+	ProblemReader reader(options.input);
+	std::FILE * out = stdout;
+	std::unique_ptr<std::FILE, int (*)(std::FILE *)> file(nullptr, std::fclose);
+	if (options.output != "-") {
+		file.reset(std::fopen(options.output.c_str(), "w"));
+		if (!file) {
+			throw std::runtime_error(fmt::format("cannot open {}: {}", options.output, std::strerror(errno)));
+		}
+		out = file.get();
+	}
+
+	// the calling thread works along with the pool
+	const unsigned threads = resolve_threads(options.threads);
+	std::unique_ptr<ThreadPool> pool;
+	if (threads > 1) {
+		pool = std::make_unique<ThreadPool>(threads - 1);
+	}
+
+	std::vector<Problem> problems;
+	std::vector<fmt::memory_buffer> results;
+	std::vector<double> latencies;
+	while (reader.next(problems, options.chunk))
+	{
+		const std::size_t n = problems.size();
+		results.resize(n);
+		const std::size_t first = latencies.size();
+		latencies.resize(first + n);
+
+		auto compute = [&] (std::size_t i) {
+			const auto t0 = clock::now();
+			results[i].clear();
+			switch (options.mode) {
+			case Mode::bounds: bounds(problems[i], results[i]); break;
+			case Mode::measures: measures(problems[i], results[i]); break;
+			case Mode::samples: samples(problems[i], options, results[i]); break;
+			}
+			latencies[first + i] = std::chrono::duration<double>(clock::now() - t0).count();
+		};
+		if (pool) {
+			pool->for_each_index(n, compute);
+		} else {
+			for (std::size_t i = 0; i < n; ++i) {
+				compute(i);
+			}
+		}
+
+		for (const auto & r : results) {
+			if (std::fwrite(r.data(), 1, r.size(), out) != r.size()) {
+				throw std::runtime_error(fmt::format("write failed: {}", std::strerror(errno)));
+			}
+		}
+		// buffered write errors only show up here
+		if (std::fflush(out) != 0 || std::ferror(out)) {
+			throw std::runtime_error(fmt::format("write failed: {}", std::strerror(errno)));
+		}
+	}
+	if (file && std::fclose(file.release()) != 0) {
+		throw std::runtime_error(fmt::format("cannot close {}: {}", options.output, std::strerror(errno)));
+	}
+
+	if (!options.quiet) {
+		report(latencies, std::chrono::duration<double>(clock::now() - start).count(), threads);
+	}
+	return 0;
+}
+
+}	// namespace
+
+int main(int argc, char **argv)
+{
+	if (argc > 1 && (std::strcmp(argv[1], "--help") == 0 || std::strcmp(argv[1], "-h") == 0)) {
+		std::fputs(usage, stdout);
+		return 0;
+	}
+	try {
+		return run(parse_options(argc, argv));
+	} catch (const UsageError& e) {
+		std::fprintf(stderr, "ejd: %s\n\n%s", e.what(), usage);
+		return 2;
+	} catch (const std::exception& e) {
+		std::fprintf(stderr, "ejd: error: %s\n", e.what());
+		return 1;
+	}
+}
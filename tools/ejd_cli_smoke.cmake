@@ -0,0 +1,74 @@
+# This file is part of EJD.
+
+# Copyright © 2020
+#           Michael Chiu <chiu@cs.toronto.edu>
+
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+
+# Smoke test of ejd_cli, run by ctest as
+#   cmake -DEJD_CLI=<path to ejd_cli> -DWORK_DIR=<scratch directory> -P ejd_cli_smoke.cmake
+
+file(MAKE_DIRECTORY ${WORK_DIR})
+set(input ${WORK_DIR}/problems.csv)
+file(WRITE ${input} "3,5\n2,4,6\n")
+
+# runs ejd_cli with the arguments, expects the exit code and returns its stdout in OUT
+function(run_cli expected_code)
+	execute_process(
+		COMMAND ${EJD_CLI} ${ARGN} --quiet
+		RESULT_VARIABLE code
+		OUTPUT_VARIABLE output
+		ERROR_VARIABLE errors
+	)
+	if(NOT code EQUAL expected_code)
+		message(FATAL_ERROR "ejd_cli ${ARGN}: exit code ${code}, expected ${expected_code}\n${errors}")
+	endif()
+	set(OUT "${output}" PARENT_SCOPE)
+endfunction()
+
+# every mode writes its rows
+run_cli(0 bounds --input ${input})
+string(REGEX MATCHALL "[^\n]+" rows "${OUT}")
+list(LENGTH rows n)
+if(NOT n EQUAL 4 OR NOT OUT MATCHES "^0,0,1,-0\\.[0-9]+,0\\.[0-9]+\n")
+	message(FATAL_ERROR "bounds: unexpected output\n${OUT}")
+endif()
+
+run_cli(0 measures --input ${input})
+set(single "${OUT}")
+run_cli(0 measures --input ${input} --threads 3 --chunk 1)
+if(NOT OUT STREQUAL single OR NOT single MATCHES "^0,0,")
+	message(FATAL_ERROR "measures: output depends on the threads")
+endif()
+
+run_cli(0 samples --input ${input} --samples 5 --structure 1 --seed 7)
+string(REGEX MATCHALL "[^\n]+" rows "${OUT}")
+list(LENGTH rows n)
+if(NOT n EQUAL 10)
+	message(FATAL_ERROR "samples: expected 10 rows\n${OUT}")
+endif()
+
+# usage errors
+run_cli(2 samples --input ${input} --structure 4294967295)
+run_cli(2 nonsense)
+# a structure the dimension does not have
+run_cli(1 samples --input ${input} --structure 2)
+
+# write errors are reported
+if(EXISTS /dev/full)
+	run_cli(1 measures --input ${input} --output /dev/full)
+endif()